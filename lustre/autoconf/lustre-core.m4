@@ -1946,6 +1946,31 @@ AC_DEFUN([LC_HAVE_DOWN_WRITE_KILLABLE], [
 	])
 ]) # LC_HAVE_DOWN_WRITE_KILLABLE
 
+#
+# LC_HAVE_KMEM_CACHE_ALLOC_BULK
+#
+# kmem_cache_alloc_bulk() and kmem_cache_free_bulk() were added by
+#   slab: infrastructure for bulk object allocation and freeing
+#
+AC_DEFUN([LC_SRC_HAVE_KMEM_CACHE_ALLOC_BULK], [
+	LB2_LINUX_TEST_SRC([kmem_cache_alloc_bulk], [
+		#include <linux/slab.h>
+	],[
+		void *p[2];
+		int rc;
+
+		rc = kmem_cache_alloc_bulk(NULL, GFP_NOFS, 2, p);
+		(void)rc;
+	],[-Werror])
+])
+AC_DEFUN([LC_HAVE_KMEM_CACHE_ALLOC_BULK], [
+	LB2_MSG_LINUX_TEST_RESULT([if 'kmem_cache_alloc_bulk' exists],
+	[kmem_cache_alloc_bulk], [
+		AC_DEFINE(HAVE_KMEM_CACHE_ALLOC_BULK, 1,
+			[kmem_cache_alloc_bulk function exists])
+	])
+]) # LC_HAVE_KMEM_CACHE_ALLOC_BULK
+
 #
 # LC_D_INIT
 #
@@ -4498,6 +4523,7 @@ AC_DEFUN([LC_PROG_LINUX_SRC], [
 	LC_SRC_HAVE_XATTR_HANDLER_INODE_PARAM
 	LC_SRC_LOCK_PAGE_MEMCG
 	LC_SRC_HAVE_DOWN_WRITE_KILLABLE
+	LC_SRC_HAVE_KMEM_CACHE_ALLOC_BULK
 
 	# 4.7
 	LC_SRC_D_IN_LOOKUP
@@ -4795,6 +4821,7 @@ AC_DEFUN([LC_PROG_LINUX_RESULTS], [
 	LC_HAVE_XATTR_HANDLER_INODE_PARAM
 	LC_LOCK_PAGE_MEMCG
 	LC_HAVE_DOWN_WRITE_KILLABLE
+	LC_HAVE_KMEM_CACHE_ALLOC_BULK
 
 	# 4.7
 	LC_D_IN_LOOKUP
@@ -300,6 +300,8 @@ struct cl_layout {
 	bool		cl_is_composite;
 	/** Whether layout is a HSM released one */
 	bool		cl_is_released;
+	/** size of the Data-on-MDT component, 0 if there is none */
+	u64		cl_dom_comp_size;
 };
 
 /**
@@ -2267,6 +2269,9 @@ struct cl_page *cl_page_find(const struct lu_env *env,
 			     struct cl_object *obj,
 			     pgoff_t idx, struct page *vmpage,
 			     enum cl_page_type type);
+bool cl_page_prealloc_begin(const struct lu_env *env, struct cl_object *o,
+			    int nr);
+void cl_page_prealloc_end(const struct lu_env *env);
 struct cl_page *cl_page_alloc(const struct lu_env *env,
 			      struct cl_object *o, pgoff_t ind,
 			      struct page *vmpage,
@@ -2376,6 +2381,17 @@ struct cl_client_cache {
 	 * # of LRU entries available
 	 */
 	atomic_long_t		ccc_lru_left;
+	/**
+	 * Per-CPU stash of LRU entries taken from ccc_lru_left in batches,
+	 * so that allocating and freeing single LRU slots does not bounce
+	 * ccc_lru_left between CPUs. Only filled while ccc_lru_left is
+	 * plentiful, see cl_cache_lru_get().
+	 */
+	atomic_long_t __percpu	*ccc_lru_left_pcp;
+	/**
+	 * # of times a CPU stash was refilled from ccc_lru_left
+	 */
+	atomic_long_t		ccc_lru_pcp_refill;
 	/**
 	 * List of entities(OSCs) for this LRU cache
 	 */
@@ -2407,6 +2423,10 @@ struct cl_client_cache {
 struct cl_client_cache *cl_cache_init(unsigned long lru_page_max);
 void cl_cache_incref(struct cl_client_cache *cache);
 void cl_cache_decref(struct cl_client_cache *cache);
+bool cl_cache_lru_get(struct cl_client_cache *cache);
+void cl_cache_lru_put(struct cl_client_cache *cache);
+long cl_cache_lru_left(struct cl_client_cache *cache);
+void cl_cache_lru_drain(struct cl_client_cache *cache);
 
 /** @} cl_page */
 
@@ -2655,7 +2675,10 @@ struct cl_sub_dio {
 	ssize_t			csd_bytes;
 	struct cl_dio_aio	*csd_ll_aio;
 	struct ll_dio_pages	csd_dio_pages;
-	unsigned		csd_creator_free:1;
+	unsigned		csd_creator_free:1,
+	/* csd_dio_pages are bounce pages owned by the creator, which copies
+	 * the data and returns them to the pool, see ll_direct_IO_impl() */
+				csd_bounce:1;
 };
 #if defined(HAVE_DIRECTIO_ITER) || defined(HAVE_IOV_ITER_RW) || \
 	defined(HAVE_DIRECTIO_2ARGS)
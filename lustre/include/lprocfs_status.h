@@ -354,6 +354,7 @@ enum {
         PTLRPC_REQACTIVE_CNTR,
         PTLRPC_TIMEOUT,
         PTLRPC_REQBUF_AVAIL_CNTR,
+        PTLRPC_REPPOOL_CNTR,
         PTLRPC_LAST_CNTR
 };
 
@@ -173,6 +173,8 @@ struct obd_import {
 	struct lustre_handle      imp_dlm_handle; /* client's ldlm export */
 	/** Currently active connection */
 	struct ptlrpc_connection *imp_connection;
+	/** CPT of the LNet peer of imp_connection, -1 if not connected yet */
+	int			  imp_cpt;
         /** PortalRPC client structure for this import */
         struct ptlrpc_client     *imp_client;
 	/** List element for linking into pinger chain */
@@ -662,6 +662,7 @@ struct ptlrpc_reply_state {
 	unsigned long		rs_sent:1;   /* Got LNET_EVENT_SEND? */
 	unsigned long		rs_unlinked:1; /* Reply MD unlinked? */
 	unsigned long		rs_prealloc:1; /* rs from prealloc list */
+	unsigned long		rs_pooled:1;   /* rs from ptlrpc_rs_cache */
 	unsigned long		rs_committed:1;/* the transaction was committed
                                                  and the rs was dispatched
                                                  by ptlrpc_commit_replies */
@@ -1002,7 +1003,9 @@ struct ptlrpc_request {
 		/* bulk request, sent to server, but uncommitted */
 		rq_unstable:1,
 		rq_early_free_repbuf:1, /* free reply buffer in advance */
-		rq_allow_intr:1;
+		rq_allow_intr:1,
+		/* ptlrpcd work item, run it on the CPT of the import peer */
+		rq_import_affinity:1;
 	/** @} */
 
 	/** server-side flags @{ */
@@ -1416,6 +1419,8 @@ enum {
 	SVC_STOPPING	= BIT(1),
 	SVC_STARTING	= BIT(2),
 	SVC_RUNNING	= BIT(3),
+	/* stopped as the thread count went down, nobody waits for it */
+	SVC_RETIRED	= BIT(4),
 };
 
 #define PTLRPC_THR_NAME_LEN		32
@@ -1452,6 +1457,11 @@ struct ptlrpc_thread {
 	struct ptlrpc_service_part	*t_svcpt;
 	wait_queue_head_t		t_ctl_waitq;
 	struct lu_env			*t_env;
+	/**
+	 * request taken, already active, while retiring the previous one
+	 * \see ptlrpc_server_finish_active_request()
+	 */
+	struct ptlrpc_request		*t_next_req;
 	char				t_name[PTLRPC_THR_NAME_LEN];
 };
 
@@ -1480,6 +1490,11 @@ static inline int thread_is_running(struct ptlrpc_thread *thread)
         return !!(thread->t_flags & SVC_RUNNING);
 }
 
+static inline int thread_is_retired(struct ptlrpc_thread *thread)
+{
+	return !!(thread->t_flags & SVC_RETIRED);
+}
+
 static inline void thread_clear_flags(struct ptlrpc_thread *thread, __u32 flags)
 {
         thread->t_flags &= ~flags;
@@ -1571,6 +1586,25 @@ struct ptlrpc_service_ops {
  */
 #define PTLRPC_SVC_HP_RATIO 10
 
+/**
+ * How many incoming requests a service thread takes at once from its
+ * partition, and hands over to NRS, per acquisition of the partition locks
+ */
+#define PTLRPC_SVC_REQ_BATCH		8
+#define PTLRPC_SVC_REQ_BATCH_MAX	256
+
+/**
+ * How often the thread count of a service partition is reconsidered when
+ * it is scaled to a target queue wait time, in msec
+ */
+#define PTLRPC_THR_ADJUST_INTERVAL	1000
+
+/**
+ * Size of the reply states allocated from the reply state cache, which is
+ * enough for the replies of most metadata RPCs whatever the page size
+ */
+#define PTLRPC_RS_POOL_SIZE		4096
+
 /**
  * Definition of PortalRPC service.
  * The service is listening on a particular portal (like tcp port)
@@ -1599,6 +1633,15 @@ struct ptlrpc_service {
         struct lprocfs_stats           *srv_stats;
         /** # hp per lp reqs to handle */
         int                             srv_hpreq_ratio;
+	/** # incoming reqs to take per lock acquisition, 1 to not batch */
+	int				srv_req_batch;
+	/**
+	 * queue wait time to scale the threads of each partition to, in usec;
+	 * 0 to only start threads when all are busy, as by default
+	 */
+	int				srv_thr_target_wait;
+	/** small replies take their reply state from ptlrpc_rs_cache */
+	int				srv_rep_pool;
         /** biggest request to receive */
         int                             srv_max_req_size;
         /** biggest reply to send */
@@ -1701,6 +1744,11 @@ struct ptlrpc_service_part {
 	struct list_head		scp_req_incoming;
 	/** timeout before re-posting reqs, in jiffies */
 	long				scp_rqbd_timeout;
+	/**
+	 * # threads wanted by the thread scaling, threads above it stop;
+	 * 0 until it has decided, see ptlrpc_threads_adjust()
+	 */
+	int				scp_nthrs_want;
 	/**
 	 * all threads sleep on this. This wait-queue is signalled when new
 	 * incoming request arrives and when difficult reply has to be handled.
@@ -1731,6 +1779,24 @@ struct ptlrpc_service_part {
 	/** # hp requests handled */
 	int				scp_hreq_count;
 
+	/** thread scaling, see ptlrpc_threads_adjust() */
+	/** @{ */
+	/** start of the current sampling interval */
+	ktime_t				scp_thr_check;
+	/** queue wait of the requests dispatched in the interval, usec */
+	__u64				scp_thr_wait_sum;
+	/** busy threads on dispatch, in percent, summed over the interval */
+	__u64				scp_thr_busy_sum;
+	/** # requests dispatched in the interval */
+	__u32				scp_thr_samples;
+	/** mean queue wait and thread usage of the last interval */
+	__u32				scp_thr_wait_avg;
+	__u32				scp_thr_busy_avg;
+	/** decisions to start and to stop threads */
+	__u64				scp_thr_grown;
+	__u64				scp_thr_shrunk;
+	/** @} */
+
 	/** NRS head for regular requests */
 	struct ptlrpc_nrs		scp_nrs_reg;
 	/** NRS head for HP requests; this is only valid for services that can
@@ -695,6 +695,7 @@ struct binheap_node {
 #include <lustre_nrs_tbf.h>
 #include <lustre_nrs_crr.h>
 #include <lustre_nrs_orr.h>
+#include <lustre_nrs_drr.h>
 #endif /* HAVE_SERVER_SUPPORT */
 #include <lustre_nrs_delay.h>
 
@@ -744,6 +745,10 @@ struct ptlrpc_nrs_request {
 		 * TBF request definition
 		 */
 		struct nrs_tbf_req	tbf;
+		/**
+		 * DRR request definition
+		 */
+		struct nrs_drr_req	drr;
 #endif /* HAVE_SERVER_SUPPORT */
 		/**
 		 * Fields for the delay policy
@@ -0,0 +1,149 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ *
+ * Network Request Scheduler (NRS) Deficit Round Robin (DRR) policy
+ *
+ */
+
+#ifndef _LUSTRE_NRS_DRR_H
+#define _LUSTRE_NRS_DRR_H
+
+/**
+ * \name DRR
+ *
+ * DRR, Deficit Round Robin over exports, JobIDs, UIDs or GIDs, charging each
+ * request the service thread time it took to handle
+ * @{
+ */
+#include <libcfs/linux/linux-hash.h>
+
+/** Length of the key identifying a DRR class */
+#define NRS_DRR_ID_LEN		UUID_MAX
+/** Maximum number of weight rules of a DRR policy instance */
+#define NRS_DRR_RULES_MAX	64
+#define NRS_DRR_WEIGHT_DEF	1
+#define NRS_DRR_WEIGHT_MAX	1000
+/** Default quantum, in usec of service time per round and unit of weight */
+#define NRS_DRR_QUANTUM_DEF	2000
+#define NRS_DRR_QUANTUM_MAX	1000000
+/** Cost assumed for the first request of a class, in nsec */
+#define NRS_DRR_COST_INIT	(100 * NSEC_PER_USEC)
+
+/**
+ * What the requests are classified by
+ */
+enum nrs_drr_type {
+	NRS_DRR_EXPORT	= 0,
+	NRS_DRR_JOBID,
+	NRS_DRR_UID,
+	NRS_DRR_GID,
+};
+
+struct nrs_drr_rule {
+	char		dru_id[NRS_DRR_ID_LEN];
+	unsigned int	dru_weight;
+};
+
+/**
+ * private data structure for DRR NRS
+ */
+struct nrs_drr_head {
+	struct ptlrpc_nrs_resource	dh_res;
+	/** DRR NRS - class hash body */
+	struct rhashtable		dh_cli_hash;
+	/** all classes, for the debugfs interface, protected by dh_lock */
+	struct list_head		dh_classes;
+	/**
+	 * classes with queued requests, in round robin order; protected by
+	 * ptlrpc_service_part::scp_req_lock like the requests themselves
+	 */
+	struct list_head		dh_active;
+	unsigned int			dh_nr_active;
+	enum nrs_drr_type		dh_type;
+	/** quantum, in nsec of service time per unit of weight */
+	u64				dh_quantum;
+	/** weight rules, protected by dh_lock */
+	spinlock_t			dh_lock;
+	unsigned int			dh_nr_rules;
+	struct nrs_drr_rule		dh_rules[NRS_DRR_RULES_MAX];
+};
+
+/**
+ * Object representing a class of requests in DRR
+ */
+struct nrs_drr_class {
+	struct ptlrpc_nrs_resource	dc_res;
+	struct rhash_head		dc_rhead;
+	char				dc_id[NRS_DRR_ID_LEN];
+	atomic_t			dc_ref;
+	struct list_head		dc_link;
+	/** linkage into nrs_drr_head::dh_active */
+	struct list_head		dc_active;
+	/** queued requests, in arrival order */
+	struct list_head		dc_list;
+	unsigned int			dc_queued;
+	unsigned int			dc_weight;
+	/**
+	 * Service time this class may still use in the current round, in nsec;
+	 * negative when it has used more than its share.
+	 */
+	s64				dc_deficit;
+	/** moving average of the service time of the requests, in nsec */
+	u64				dc_cost_avg;
+	/** stats */
+	u64				dc_served;
+	u64				dc_cost_total;
+};
+
+/**
+ * DRR NRS request definition
+ */
+struct nrs_drr_req {
+	/** linkage into nrs_drr_class::dc_list */
+	struct list_head	dr_list;
+	/** when the request was handed to a service thread */
+	ktime_t			dr_start;
+	/** cost charged to the class when the request was handed out */
+	u64			dr_charged;
+};
+
+/**
+ * DRR policy operations.
+ *
+ * Read the quantum of a DRR policy.
+ */
+#define NRS_CTL_DRR_RD_QUANTUM	PTLRPC_NRS_CTL_POL_SPEC_01
+/**
+ * Write the quantum of a DRR policy.
+ */
+#define NRS_CTL_DRR_WR_QUANTUM	PTLRPC_NRS_CTL_POL_SPEC_02
+/**
+ * Dump the weight rules and classes of a DRR policy to a seq_file.
+ */
+#define NRS_CTL_DRR_RD_WEIGHT	PTLRPC_NRS_CTL_POL_SPEC_03
+/**
+ * Set the weight of a class of a DRR policy.
+ */
+#define NRS_CTL_DRR_WR_WEIGHT	PTLRPC_NRS_CTL_POL_SPEC_04
+
+/** @} DRR */
+#endif
@@ -184,6 +184,12 @@ struct nrs_tbf_rule {
 	atomic_t			 tr_ref;
 	/** Generation of the rule. */
 	__u64				 tr_generation;
+	/**
+	 * Bounds of the RPC rate for adaptive rules, whose rate is scaled
+	 * with the load of the service partition; 0 for a static rule.
+	 */
+	__u64				 tr_rate_min;
+	__u64				 tr_rate_max;
 };
 
 struct nrs_tbf_ops {
@@ -286,6 +292,25 @@ struct nrs_tbf_head {
 	 * Index of bucket on hash table while purging.
 	 */
 	int				 th_purge_start;
+	/**
+	 * Adaptive rate control of the rules with rate bounds, protected by
+	 * ptlrpc_service_part::scp_req_lock.
+	 *
+	 * Target service latency, in nsec; 0 disables the adaptation.
+	 */
+	__u64				 th_adapt_target;
+	/** Start of the current sampling interval. */
+	__u64				 th_adapt_check;
+	/** Service time of the requests finished in the interval. */
+	__u64				 th_adapt_lat_sum;
+	__u32				 th_adapt_lat_cnt;
+	/** Times a class of an adaptive rule ran out of tokens. */
+	__u32				 th_adapt_throttled;
+	/** Mean service latency of the last interval, in nsec. */
+	__u64				 th_adapt_latency;
+	/** Rate changes made by the controller, for debugfs. */
+	__u64				 th_adapt_raised;
+	__u64				 th_adapt_lowered;
 };
 
 enum nrs_tbf_cmd_type {
@@ -312,10 +337,15 @@ struct nrs_tbf_cmd {
 			__u32			 ts_valid_type;
 			enum nrs_rule_flags	 ts_rule_flags;
 			char			*ts_next_name;
+			__u64			 ts_rate_min;
+			__u64			 ts_rate_max;
 		} tc_start;
 		struct nrs_tbf_cmd_change {
 			__u64			 tc_rpc_rate;
 			char			*tc_next_name;
+			__u64			 tc_rate_min;
+			__u64			 tc_rate_max;
+			bool			 tc_static;
 		} tc_change;
 	} u;
 };
@@ -356,6 +386,10 @@ struct nrs_tbf_req {
 	 * Sequence of the request.
 	 */
 	__u64			tr_sequence;
+	/**
+	 * When the request was handed to a service thread, in nsec.
+	 */
+	__u64			tr_start;
 };
 
 /**
@@ -372,6 +406,14 @@ struct nrs_tbf_req {
  * Read the TBF policy type preset by proc entry "nrs_policies".
  */
 #define NRS_CTL_TBF_RD_TYPE_FLAG PTLRPC_NRS_CTL_POL_SPEC_03
+/**
+ * Dump the adaptive rate control state of a TBF policy to a seq_file.
+ */
+#define NRS_CTL_TBF_RD_ADAPTIVE PTLRPC_NRS_CTL_POL_SPEC_04
+/**
+ * Set the target service latency of a TBF policy, in usec.
+ */
+#define NRS_CTL_TBF_WR_ADAPTIVE PTLRPC_NRS_CTL_POL_SPEC_05
 
 /** @} tbf */
 #endif
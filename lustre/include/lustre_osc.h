@@ -109,6 +109,9 @@ struct osc_device {
 		ktime_t		os_init;
 		uint64_t	os_lockless_writes;    /* by bytes */
 		uint64_t	os_lockless_reads;     /* by bytes */
+		/* compressed writes, by bytes before and after compression */
+		uint64_t	os_compr_raw;
+		uint64_t	os_compr_sent;
 	} osc_stats;
 
 	/* configuration item(s) */
@@ -133,6 +136,9 @@ struct osc_io {
 			   oi_is_readahead:1;
 	/** how many LRU pages are reserved for this IO */
 	unsigned long	   oi_lru_reserved;
+	/** job slot of the writing task, held until the IO iteration ends,
+	 * see osc_job_slot_get() */
+	struct osc_job_slot *oi_job_slot;
 
 	/** active extents, we know how many bytes is going to be written,
 	 * so having an active extent will prevent it from being fragmented */
@@ -175,6 +181,8 @@ struct osc_thread_info {
 	struct cl_sync_io	oti_anchor;
 	struct cl_req_attr	oti_req_attr;
 	struct lu_buf		oti_ladvise_buf;
+	/* owner of the objects batched into one write RPC */
+	struct obdo		oti_oa;
 };
 
 static inline __u64 osc_enq2ldlm_flags(__u32 enqflags)
@@ -550,6 +558,9 @@ struct osc_brw_async_args {
 	struct client_obd	*aa_cli;
 	struct list_head	 aa_oaps;
 	struct list_head	 aa_exts;
+	/* obdos of the 2nd and following objects of a multi-object write */
+	struct obdo		*aa_obj_oa;
+	u32			 aa_obj_count;
 };
 
 extern struct kmem_cache *osc_lock_kmem;
@@ -582,6 +593,9 @@ int osc_set_async_flags(struct osc_object *obj, struct osc_page *opg,
 			u32 async_flags);
 int osc_prep_async_page(struct osc_object *osc, struct osc_page *ops,
 			struct cl_page *page, loff_t offset);
+struct osc_job_slot *osc_job_slot_get(struct client_obd *cli,
+				      const char *jobid);
+void osc_job_slot_put(struct client_obd *cli, struct osc_job_slot *slot);
 int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 		       struct osc_page *ops, cl_commit_cbt cb);
 int osc_page_cache_add(const struct lu_env *env, struct osc_page *opg,
@@ -604,7 +618,12 @@ int osc_io_unplug0(const struct lu_env *env, struct client_obd *cli,
 		   struct osc_object *osc, int async);
 static inline void osc_wake_cache_waiters(struct client_obd *cli)
 {
-	wake_up(&cli->cl_cache_waiters);
+	/* the first waiter may be held back by its job's fair share, let
+	 * the waiters of other jobs check too */
+	if (cli->cl_job_waiting > 1)
+		wake_up_all(&cli->cl_cache_waiters);
+	else
+		wake_up(&cli->cl_cache_waiters);
 }
 
 static inline int osc_io_unplug_async(const struct lu_env *env,
@@ -980,6 +999,9 @@ struct osc_extent {
 	unsigned int		oe_mppr;
 	/** FLR: layout version when this osc_extent is publised */
 	__u32			oe_layout_version;
+	/** job slot the dirty pages of this extent are accounted to,
+	 * -1 if not accounted (sync and direct IO extents) */
+	int			oe_job;
 };
 
 /** @} osc */
@@ -169,6 +169,26 @@ enum tgt_sync_lock_cancel {
 #define OBD_MAX_EA_SIZE		XATTR_SIZE_MAX
 
 
+/* number of jobs tracked by the write cache of each OSC */
+#define OSC_JOB_SLOTS		32
+
+struct osc_job_slot {
+	char		ojs_jobid[LUSTRE_JOBID_SIZE];
+	/* # of dirty pages cached by this job */
+	atomic_long_t	ojs_dirty;
+	/* # of threads of this job waiting for cache/grant */
+	unsigned int	ojs_waiters;
+	/* # of IOs holding this slot, see osc_job_slot_get() */
+	unsigned int	ojs_refs;
+	time64_t	ojs_last_used;
+	/* stats */
+	__u64		ojs_waits;
+	__u64		ojs_wait_us;
+	__u64		ojs_wait_max_us;
+	__u64		ojs_throttled;
+	__u64		ojs_sync;
+};
+
 enum obd_cl_sem_lock_class {
 	OBD_CLI_SEM_NORMAL,
 	OBD_CLI_SEM_MGC,
@@ -216,7 +236,10 @@ struct client_obd {
 	unsigned int		 cl_checksum:1, /* 0 = disabled, 1 = enabled */
 				 cl_checksum_dump:1, /* same */
 				 cl_ocd_grant_param:1,
-				 cl_lsom_update:1; /* send LSOM updates */
+				 cl_lsom_update:1, /* send LSOM updates */
+				 cl_readdir_prefetch:1, /* mdc readdir */
+				 cl_brw_compress:1, /* LZ4 write bulk */
+				 cl_job_fair:1; /* per-job write cache share */
 	enum lustre_sec_part	 cl_sp_me;
 	enum lustre_sec_part	 cl_sp_to;
 	struct sptlrpc_flavor	 cl_flvr_mgc; /* fixed flavor of mgc->mgs */
@@ -235,6 +258,12 @@ struct client_obd {
 	 * See osc_{reserve|unreserve}_grant for details. */
 	long			cl_reserved_grant;
 	wait_queue_head_t	cl_cache_waiters; /* waiting for cache/grant */
+	/* per-job dirty accounting, protected by loi_list_lock below
+	 * except ojs_dirty. See osc_job_slot_get() for details. */
+	struct osc_job_slot	*cl_job_slots;
+	/* # of jobs with threads in cl_cache_waiters */
+	int			cl_job_waiting;
+	ktime_t			cl_job_stats_init;
 	time64_t		cl_next_shrink_grant;	/* seconds */
 	struct list_head	cl_grant_chain;
 	time64_t		cl_grant_shrink_interval; /* seconds */
@@ -316,6 +345,9 @@ struct client_obd {
 	struct list_head         cl_lru_list;
 	/** Lock for LRU page list */
 	spinlock_t		 cl_lru_list_lock;
+	/** stats: # of times cl_lru_list_lock was found held by the LRU
+	 * add/delete paths */
+	atomic_long_t		 cl_lru_lock_contended;
 	/** # of unstable pages in this client_obd.
 	 * An unstable page is a page state that WRITE RPC has finished but
 	 * the transaction has NOT yet committed. */
@@ -327,6 +359,11 @@ struct client_obd {
 	atomic_t		 cl_destroy_in_flight;
 	wait_queue_head_t	 cl_destroy_waitq;
 
+	/* dir pages read ahead by mdc readdir prefetch, and the ones of
+	 * them that readdir then found in the cache */
+	atomic_t		 cl_readdir_prefetch_pages;
+	atomic_t		 cl_readdir_prefetch_hits;
+
 	/* modify rpcs in flight
 	 * currently used for metadata only */
 	__u16			 cl_max_mod_rpcs_in_flight;
@@ -955,6 +992,8 @@ struct md_op_data {
 	__u32			op_stripe_index;
 	/* Archive ID for PCC attach */
 	__u32			op_archive_id;
+	/* DoM file data expected in the open reply, see mdc_intent_open_pack */
+	__u32			op_inline_size;
 };
 
 struct md_readdir_info {
@@ -438,6 +438,7 @@ extern char obd_jobid_var[];
 #define OBD_FAIL_OSC_DELAY_CANCEL        0x416
 #define OBD_FAIL_OSC_SLOW_PAGE_EVICT	 0x417
 #define OBD_FAIL_OSC_FIEMAP		 0x418
+#define OBD_FAIL_OSC_NO_MULTIOBJ_BRW	 0x419
 
 #define OBD_FAIL_PTLRPC                  0x500
 #define OBD_FAIL_PTLRPC_ACK              0x501
@@ -622,6 +623,7 @@ extern char obd_jobid_var[];
 #define OBD_FAIL_LLITE_PAGE_ALLOC		    0x1418
 #define OBD_FAIL_LLITE_OPEN_DELAY		    0x1419
 #define OBD_FAIL_LLITE_XATTR_PAUSE		    0x1420
+#define OBD_FAIL_LLITE_PAGE_BULK_ALLOC		    0x1421
 #define OBD_FAIL_LLITE_READPAGE_PAUSE2		    0x1424
 #define OBD_FAIL_LLITE_FAULT_PAUSE		    0x1425
 #define OBD_FAIL_LLITE_DELAY_TRUNCATE		    0x1430
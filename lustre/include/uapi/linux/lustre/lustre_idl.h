@@ -853,6 +853,12 @@ struct ptlrpc_body_v2 {
 #define OBD_CONNECT2_PCCRO	      0x800000ULL /* Read-only PCC */
 #define OBD_CONNECT2_ATOMIC_OPEN_LOCK 0x4000000ULL/* request lock on 1st open */
 #define OBD_CONNECT2_ENCRYPT_NAME     0x8000000ULL /* name encrypt */
+#define OBD_CONNECT2_ENCRYPT_FID2PATH 0x10000000ULL /* fid2path enc support */
+#define OBD_CONNECT2_DMV_IMP_INHERIT 0x20000000ULL /* implicit DMV inherit */
+#define OBD_CONNECT2_UNALIGNED_DIO   0x40000000ULL /* unaligned DIO */
+#define OBD_CONNECT2_LARGE_NID	     0x80000000ULL /* large/IPv6 NIDs */
+#define OBD_CONNECT2_COMPRESS	    0x100000000ULL /* compressed BRW bulk */
+#define OBD_CONNECT2_MULTIOBJ_BRW   0x200000000ULL /* multi-object write */
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
  * flag value is not in use on some other branch.  Please clear any such
@@ -939,7 +945,8 @@ struct ptlrpc_body_v2 {
 
 #define OST_CONNECT_SUPPORTED2 (OBD_CONNECT2_LOCKAHEAD | OBD_CONNECT2_INC_XID |\
 				OBD_CONNECT2_ENCRYPT | OBD_CONNECT2_LSEEK |\
-				OBD_CONNECT2_REP_MBITS)
+				OBD_CONNECT2_REP_MBITS | OBD_CONNECT2_COMPRESS |\
+				OBD_CONNECT2_MULTIOBJ_BRW)
 
 #define ECHO_CONNECT_SUPPORTED (OBD_CONNECT_FID | OBD_CONNECT_FLAGS2)
 #define ECHO_CONNECT_SUPPORTED2 OBD_CONNECT2_REP_MBITS
@@ -1105,6 +1112,7 @@ enum obdo_flags {
 	OBD_FL_FLUSH	    = 0x00200000, /* flush pages on the OST */
 	OBD_FL_SHORT_IO	    = 0x00400000, /* short io request */
 	OBD_FL_ROOT_SQUASH  = 0x00800000, /* root squash */
+	OBD_FL_COMPRESSED   = 0x01000000, /* write bulk is LZ4 compressed */
 	/* OBD_FL_LOCAL_MASK = 0xF0000000, was local-only flags until 2.10 */
 
 	/*
@@ -1449,6 +1457,19 @@ struct niobuf_remote {
 	__u32	rnb_flags;
 };
 
+/*
+ * With OBD_FL_COMPRESSED set, the write bulk is a series of these headers,
+ * each followed by bcc_len bytes that hold the next bcc_raw_len bytes of the
+ * data described by the remote niobufs. A chunk with bcc_len equal to
+ * bcc_raw_len is stored uncompressed. Bulk data is not swabbed, so the
+ * fields are little-endian.
+ */
+#define BRW_COMPR_CHUNK_SIZE	(64 * 1024)
+struct brw_compr_chunk {
+	__u32	bcc_raw_len;
+	__u32	bcc_len;
+};
+
 /* lock value block communicated between the filter and llite */
 
 /* OST_LVB_ERR_INIT is needed because the return code in rc is
@@ -3120,8 +3141,8 @@ struct obdo {
 						 * brw: grant space consumed on
 						 * the client for the write */
 	__u32			o_projid;
-	__u32			o_padding_4;	/* also fix
-						 * lustre_swab_obdo() */
+	__u32			o_compr_len;	/* brw: bytes of compressed
+						 * bulk */
 	__u64			o_padding_5;
 	__u64			o_padding_6;
 };
@@ -2698,6 +2698,7 @@ struct lu_heat {
 enum lu_pcc_type {
 	LU_PCC_NONE = 0,
 	LU_PCC_READWRITE,
+	LU_PCC_READONLY,
 	LU_PCC_MAX
 };
 
@@ -2708,6 +2709,8 @@ static inline const char *pcc_type2string(enum lu_pcc_type type)
 		return "none";
 	case LU_PCC_READWRITE:
 		return "readwrite";
+	case LU_PCC_READONLY:
+		return "readonly";
 	default:
 		return "fault";
 	}
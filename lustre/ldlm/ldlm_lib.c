@@ -452,6 +452,7 @@ int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	atomic_long_set(&cli->cl_lru_in_list, 0);
 	INIT_LIST_HEAD(&cli->cl_lru_list);
 	spin_lock_init(&cli->cl_lru_list_lock);
+	atomic_long_set(&cli->cl_lru_lock_contended, 0);
 	atomic_long_set(&cli->cl_unstable_count, 0);
 	INIT_LIST_HEAD(&cli->cl_shrink_list);
 	INIT_LIST_HEAD(&cli->cl_grant_chain);
@@ -461,6 +462,8 @@ int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 
 	init_waitqueue_head(&cli->cl_destroy_waitq);
 	atomic_set(&cli->cl_destroy_in_flight, 0);
+	atomic_set(&cli->cl_readdir_prefetch_pages, 0);
+	atomic_set(&cli->cl_readdir_prefetch_hits, 0);
 
 
 	cli->cl_supp_cksum_types = OBD_CKSUM_CRC32;
@@ -344,6 +344,10 @@ static int ll_revalidate_dentry(struct dentry *dentry,
 	if (lookup_flags & LOOKUP_RCU)
 		return -ECHILD;
 
+	/* invalid dentries are already skipped by ll_dcompare() */
+	if (!dentry->d_inode)
+		ll_stats_ops_tally(ll_i2sbi(dir), LPROC_LL_NEG_DENTRY_HITS, 1);
+
 	if (dentry_may_statahead(dir, dentry))
 		ll_revalidate_statahead(dir, &dentry, dentry->d_inode == NULL);
 
@@ -622,6 +622,37 @@ out_io:
 	EXIT;
 }
 
+/*
+ * Size of the data the MDT may return with the open of @inode, that is the
+ * file size if the whole file is in the DoM component, 0 otherwise. This is
+ * only a hint to size the reply buffer, so a stale size or layout is fine.
+ */
+static __u32 ll_dom_inline_size(struct inode *inode)
+{
+	struct cl_object *obj = ll_i2info(inode)->lli_clob;
+	struct cl_layout cl = {
+		.cl_dom_comp_size = 0,
+	};
+	loff_t size = i_size_read(inode);
+	struct lu_env *env;
+	__u16 refcheck;
+	int rc;
+
+	if (obj == NULL || !S_ISREG(inode->i_mode) || size == 0)
+		return 0;
+
+	env = cl_env_get(&refcheck);
+	if (IS_ERR(env))
+		return 0;
+
+	rc = cl_object_layout_get(env, obj, &cl);
+	cl_env_put(env, &refcheck);
+	if (rc < 0 || size > cl.cl_dom_comp_size)
+		return 0;
+
+	return min_t(loff_t, size, U32_MAX);
+}
+
 static int ll_intent_file_open(struct dentry *de, void *lmm, int lmmsize,
 				struct lookup_intent *itp)
 {
@@ -672,6 +703,8 @@ retry:
 	}
 	op_data->op_data = lmm;
 	op_data->op_data_size = lmmsize;
+	if (!(itp->it_flags & O_TRUNC))
+		op_data->op_inline_size = ll_dom_inline_size(de->d_inode);
 
 	OBD_FAIL_TIMEOUT(OBD_FAIL_LLITE_OPEN_DELAY, cfs_fail_val);
 
@@ -1642,6 +1675,57 @@ static void ll_heat_add(struct inode *inode, enum cl_io_type iot,
 	spin_unlock(&lli->lli_heat_lock);
 }
 
+/*
+ * Large buffered I/O is dominated by copying into the page cache and by
+ * dirty extent management in osc.  Above the per-mount thresholds, page
+ * aligned synchronous buffered I/O is sent through the direct I/O path
+ * instead.  The kernel writes back and invalidates the cached range before
+ * direct I/O, so the page cache stays coherent with what was sent.
+ */
+static bool ll_hybrid_io_switch(struct file *file, struct vvp_io_args *args,
+				enum cl_io_type iot, size_t count)
+{
+#ifdef IOCB_APPEND
+	struct kiocb *iocb = args->u.normal.via_iocb;
+	struct iov_iter *iter = args->u.normal.via_iter;
+	struct inode *inode = file_inode(file);
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	unsigned int threshold;
+
+	if (!test_bit(LL_SBI_HYBRID_IO, sbi->ll_flags))
+		return false;
+
+	if (iot == CIT_READ)
+		threshold = sbi->ll_hybrid_io_read_threshold_bytes;
+	else
+		threshold = sbi->ll_hybrid_io_write_threshold_bytes;
+	if (count < threshold)
+		return false;
+
+	/* AIO completion and appends keep the buffered semantics */
+	if (iocb->ki_flags & (IOCB_DIRECT | IOCB_APPEND) ||
+	    !is_sync_kiocb(iocb) || iov_iter_is_pipe(iter))
+		return false;
+
+	if ((iocb->ki_pos & ~PAGE_MASK) ||
+	    (iov_iter_alignment(iter) & ~PAGE_MASK))
+		return false;
+
+	/* mapped pages cannot be invalidated before direct I/O */
+	if (IS_ENCRYPTED(inode) || mapping_mapped(file->f_mapping))
+		return false;
+
+	iocb->ki_flags |= IOCB_DIRECT;
+	ll_stats_ops_tally(sbi, iot == CIT_READ ? LPROC_LL_HYBRID_READ_BYTES :
+						  LPROC_LL_HYBRID_WRITE_BYTES,
+			   count);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
 static ssize_t
 ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 		   struct file *file, enum cl_io_type iot,
@@ -1665,6 +1749,7 @@ ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 	struct cl_dio_aio *ci_dio_aio = NULL;
 	size_t per_bytes;
 	bool partial_io = false;
+	bool hybrid_io;
 	size_t max_io_pages, max_cached_pages;
 
 	ENTRY;
@@ -1673,6 +1758,10 @@ ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 		file_dentry(file)->d_name.name,
 		iot == CIT_READ ? "read" : "write", *ppos, count);
 
+	hybrid_io = ll_hybrid_io_switch(file, args, iot, count);
+	if (hybrid_io)
+		flags = vvp_io_args_flags(file, args);
+
 	max_io_pages = PTLRPC_MAX_BRW_PAGES * OBD_MAX_RIF_DEFAULT;
 	max_cached_pages = sbi->ll_cache->ccc_lru_max;
 	if (max_io_pages > (max_cached_pages >> 2))
@@ -1920,6 +2009,11 @@ out:
 		}
 	}
 
+#ifdef IOCB_APPEND
+	if (hybrid_io)
+		args->u.normal.via_iocb->ki_flags &= ~IOCB_DIRECT;
+#endif
+
 	CDEBUG(D_VFSTRACE, "iot: %d, result: %zd\n", iot, result);
 	if (result > 0)
 		ll_heat_add(inode, iot, result);
@@ -5527,7 +5621,7 @@ static int ll_inode_revalidate_fini(struct inode *inode, int rc)
 	return rc;
 }
 
-static int ll_inode_revalidate(struct dentry *dentry, enum ldlm_intent_flags op)
+int ll_inode_revalidate(struct dentry *dentry, enum ldlm_intent_flags op)
 {
 	struct inode *parent;
 	struct inode *inode = dentry->d_inode;
@@ -5643,6 +5737,9 @@ int ll_getattr_dentry(struct dentry *de, struct kstat *stat, u32 request_mask,
 	if (dentry_may_statahead(dir, de))
 		ll_start_statahead(dir, de, need_glimpse &&
 				   !(flags & AT_STATX_DONT_SYNC));
+	else
+		ll_statahead_fname_check(dir, de, need_glimpse &&
+					 !(flags & AT_STATX_DONT_SYNC));
 
 	if (flags & AT_STATX_DONT_SYNC)
 		GOTO(fill_attr, rc = 0);
@@ -184,6 +184,23 @@ struct ll_inode_info {
 			unsigned short			lli_sa_enabled:1;
 			/* generation for statahead */
 			unsigned int			lli_sa_generation;
+			/* statahead file name pattern detection: hash and
+			 * length of the common name prefix, numeric suffix
+			 * of the last name and count of consecutive names
+			 * stat'ed by lli_sa_fname_pid */
+			unsigned int			lli_sa_fname_hash;
+			unsigned short			lli_sa_fname_prefix_len;
+			unsigned short			lli_sa_fname_hits;
+			pid_t				lli_sa_fname_pid;
+			__u64				lli_sa_fname_index;
+			/* creates by this client in a burst, each within
+			 * ll_oc_thrsh_ms of the previous one, and the time
+			 * of the last one, see ll_create_burst() */
+			unsigned int			lli_create_count;
+			ktime_t				lli_create_time;
+			/* negative lookups sent to the MDS since the UPDATE
+			 * lock of this directory was lost */
+			atomic_t			lli_neg_lookups;
 			/* rw lock protects lli_lsm_md */
 			struct rw_semaphore		lli_lsm_sem;
 			/* directory stripe information */
@@ -468,6 +485,8 @@ int ll_xattr_cache_insert(struct inode *inode,
 			  char *buffer,
 			  size_t size);
 
+int ll_xattr_cache_prefetch(struct inode *inode);
+
 static inline bool obd_connect_has_secctx(struct obd_connect_data *data)
 {
 #ifdef CONFIG_SECURITY
@@ -581,6 +600,10 @@ static inline struct pcc_inode *ll_i2pcci(struct inode *inode)
 /* default read-ahead for a single file descriptor */
 #define SBI_DEFAULT_READ_AHEAD_PER_FILE_MAX	MiB_TO_PAGES(256UL)
 
+/* default async read-ahead works in flight for a single file descriptor */
+#define LL_RA_ASYNC_PER_FILE_DEF		4
+#define LL_RA_ASYNC_PER_FILE_MAX		64
+
 /* default read-ahead full files smaller than limit on the second read */
 #define SBI_DEFAULT_READ_AHEAD_WHOLE_MAX	MiB_TO_PAGES(2UL)
 
@@ -607,6 +630,7 @@ enum ra_stat {
 	RA_STAT_ASYNC,
 	RA_STAT_FAILED_FAST_READ,
 	RA_STAT_MMAP_RANGE_READ,
+	RA_STAT_SKIPPED_CACHED,
 	_NR_RA_STAT,
 };
 
@@ -616,12 +640,15 @@ struct ll_ra_info {
 	unsigned long	ra_max_pages_per_file;
 	unsigned long	ra_range_pages;
 	unsigned long	ra_max_read_ahead_whole_pages;
-	struct workqueue_struct  *ll_readahead_wq;
+	/* async readahead workqueues, one per CPU partition */
+	struct workqueue_struct **ll_readahead_wqs;
 	/*
 	 * Max number of active works could be triggered
 	 * for async readahead.
 	 */
 	unsigned int ra_async_max_active;
+	/* max number of async readahead works in flight for one file */
+	unsigned int ra_async_max_per_file;
 	/* how many async readahead triggered in flight */
 	atomic_t ra_async_inflight;
 	/* Threshold to control when to trigger async readahead */
@@ -679,6 +706,42 @@ struct ll_rw_process_info {
         struct ll_file_data      *rw_last_file;
 };
 
+/* readahead statistics of the last LL_RA_JOB_HIST_MAX jobs */
+#define LL_RA_JOB_HIST_MAX 16
+struct ll_ra_job_info {
+	char			rji_jobid[LUSTRE_JOBID_SIZE];
+	__u64			rji_stats[_NR_RA_STAT];
+};
+
+/* how ras_update() handled an access, see ll_ra_trace_add() */
+enum ll_ra_trace_decision {
+	LL_RA_TRACE_WHOLE_FILE = 0,	/* window covers the whole file */
+	LL_RA_TRACE_RANDOM,		/* random read, window left alone */
+	LL_RA_TRACE_SEQ_RANGE,		/* mmap sequential read miss */
+	LL_RA_TRACE_MMAP_RANGE,		/* mmap range read */
+	LL_RA_TRACE_STRIDE_RESET,	/* miss in stride window */
+	LL_RA_TRACE_RESET,		/* miss in window, everything reset */
+	LL_RA_TRACE_KEEP,		/* window start updated */
+	LL_RA_TRACE_INCREASE,		/* window increased */
+	_NR_LL_RA_TRACE,
+};
+
+#define LL_RA_TRACE_MAX 256
+struct ll_ra_trace_entry {
+	ktime_t			rte_time;
+	struct lu_fid		rte_fid;
+	char			rte_jobid[LUSTRE_JOBID_SIZE];
+	pgoff_t			rte_index;
+	pgoff_t			rte_window_start_idx;
+	unsigned long		rte_window_pages;
+	pgoff_t			rte_next_readahead_idx;
+	loff_t			rte_stride_length;
+	loff_t			rte_stride_bytes;
+	unsigned int		rte_hit:1,
+				rte_mmap:1;
+	enum ll_ra_trace_decision rte_decision;
+};
+
 enum stats_track_type {
         STATS_TRACK_ALL = 0,  /* track all processes */
         STATS_TRACK_PID,      /* track process with this pid */
@@ -719,6 +782,10 @@ enum ll_sbi_flags {
 	LL_SBI_FILE_HEAT,		/* file heat support */
 	LL_SBI_PARALLEL_DIO,		/* parallel (async) O_DIRECT RPCs */
 	LL_SBI_ENCRYPT_NAME,		/* name encryption */
+	LL_SBI_STATAHEAD_FNAME,		/* statahead by file name pattern */
+	LL_SBI_UNALIGNED_DIO,		/* unaligned O_DIRECT via bounce pages */
+	LL_SBI_HYBRID_IO,		/* large buffered I/O sent as direct */
+	LL_SBI_STATAHEAD_XATTR,		/* statahead prefetches xattrs */
 	LL_SBI_NUM_FLAGS
 };
 
@@ -789,10 +856,22 @@ struct ll_sb_info {
 	enum stats_track_type	  ll_stats_track_type;
 	int			  ll_rw_stats_on;
 
+	/* per-job readahead statistics and ras_update() trace */
+	spinlock_t		  ll_ra_job_lock;
+	struct ll_ra_job_info	 *ll_ra_job_info;
+	unsigned int		  ll_ra_job_count;
+	struct ll_ra_trace_entry *ll_ra_trace;
+	unsigned int		  ll_ra_trace_count;
+	ktime_t			  ll_ra_job_stats_init;
+	int			  ll_ra_job_stats_on;
+
 	/* metadata stat-ahead */
 	unsigned int		  ll_sa_running_max;/* max concurrent
 						     * statahead instances */
 	unsigned int		  ll_sa_max;     /* max statahead RPCs */
+	unsigned int		  ll_sa_batch_max;/* max statahead RPCs sent
+						   * before replies are
+						   * instantiated */
 	atomic_t		  ll_sa_total;   /* statahead thread started
 						  * count */
 	atomic_t		  ll_sa_wrong;   /* statahead thread stopped for
@@ -800,6 +879,10 @@ struct ll_sb_info {
 	atomic_t		  ll_sa_running; /* running statahead thread
 						  * count */
 	atomic_t		  ll_agl_total;  /* AGL thread started count */
+	atomic_t		  ll_sa_fname_total; /* statahead by file name
+						      * pattern started count */
+	atomic_t		  ll_sa_xattr_total; /* xattr caches filled by
+						      * statahead */
 
 	dev_t			  ll_sdev_orig; /* save s_dev before assign for
 						 * clustred nfs */
@@ -813,6 +896,10 @@ struct ll_sb_info {
 	/* maximum relative age of cached statfs results */
 	unsigned int		  ll_statfs_max_age;
 
+	/* buffered I/O of at least this size is switched to direct I/O */
+	unsigned int		  ll_hybrid_io_read_threshold_bytes;
+	unsigned int		  ll_hybrid_io_write_threshold_bytes;
+
 	struct kset		  ll_kset;	/* sysfs object */
 	struct completion	  ll_kobj_unregister;
 
@@ -831,6 +918,16 @@ struct ll_sb_info {
 	/* Time in ms after last file close that we no longer count prior opens*/
 	u32			  ll_oc_max_ms;
 
+	/* Creates in a burst in one directory before new files are created
+	 * with an open lock
+	 */
+	u32			  ll_oc_create_thrsh;
+
+	/* Negative lookups in a directory before its UPDATE lock is fetched
+	 * so that further misses are answered from negative dentries
+	 */
+	u32			  ll_neg_dentry_thrsh;
+
 	/* filesystem fsname */
 	char			  ll_fsname[LUSTRE_MAXFSNAME + 1];
 
@@ -861,6 +958,11 @@ struct ll_sb_info {
 #define SBI_DEFAULT_OPENCACHE_THRESHOLD_COUNT	(5)
 #define SBI_DEFAULT_OPENCACHE_THRESHOLD_MS	(100) /* 0.1 second */
 #define SBI_DEFAULT_OPENCACHE_THRESHOLD_MAX_MS	(60000) /* 1 minute */
+#define SBI_DEFAULT_OPENCACHE_CREATE_THRESHOLD	(16)
+#define SBI_DEFAULT_NEG_DENTRY_THRESHOLD	(0) /* off */
+
+#define SBI_DEFAULT_HYBRID_IO_READ_THRESHOLD	(8 << 20) /* 8 MiB */
+#define SBI_DEFAULT_HYBRID_IO_WRITE_THRESHOLD	(2 << 20) /* 2 MiB */
 
 /*
  * per file-descriptor read-ahead data.
@@ -947,6 +1049,8 @@ struct ll_readahead_state {
 	unsigned long	ras_consecutive_stride_requests;
 	/* index of the last page that async readahead starts */
 	pgoff_t		ras_async_last_readpage_idx;
+	/* number of async readahead works in flight for this file */
+	atomic_t	ras_async_inflight;
 	/* whether we should increase readahead window */
 	bool		ras_need_increase_window;
 	/* whether ra miss check should be skipped */
@@ -1069,10 +1173,13 @@ int ll_debugfs_register_super(struct super_block *sb, const char *name);
 void ll_debugfs_unregister_super(struct super_block *sb);
 void ll_stats_ops_tally(struct ll_sb_info *sbi, int op, long count);
 void ll_free_rw_stats_info(struct ll_sb_info *sbi);
+void ll_free_ra_job_stats_info(struct ll_sb_info *sbi);
 
 enum {
 	LPROC_LL_READ_BYTES,
 	LPROC_LL_WRITE_BYTES,
+	LPROC_LL_HYBRID_READ_BYTES,
+	LPROC_LL_HYBRID_WRITE_BYTES,
 	LPROC_LL_READ,
 	LPROC_LL_WRITE,
 	LPROC_LL_IOCTL,
@@ -1100,6 +1207,8 @@ enum {
 	LPROC_LL_SETXATTR,
 	LPROC_LL_GETXATTR,
 	LPROC_LL_GETXATTR_HITS,
+	LPROC_LL_NEG_DENTRY_HITS,
+	LPROC_LL_NEG_DENTRY_MISSES,
 	LPROC_LL_LISTXATTR,
 	LPROC_LL_REMOVEXATTR,
 	LPROC_LL_INODE_PERM,
@@ -1185,6 +1294,7 @@ int ll_getattr(struct mnt_idmap *, const struct path *path,
 #else
 int ll_getattr(struct vfsmount *mnt, struct dentry *de, struct kstat *stat);
 #endif /* HAVE_USER_NAMESPACE_ARG */
+int ll_inode_revalidate(struct dentry *dentry, enum ldlm_intent_flags op);
 int ll_getattr_dentry(struct dentry *de, struct kstat *stat, u32 request_mask,
 		      unsigned int flags, bool foreign);
 #ifdef CONFIG_LUSTRE_FS_POSIX_ACL
@@ -1553,6 +1663,9 @@ enum ras_update_flags {
 	LL_RAS_MMAP = 0x2
 };
 void ll_ra_count_put(struct ll_sb_info *sbi, unsigned long len);
+int ll_readahead_wq_init(struct ll_ra_info *ra);
+void ll_readahead_wq_set_max_active(struct ll_ra_info *ra);
+void ll_readahead_wq_fini(struct ll_ra_info *ra);
 void ll_ra_stats_inc(struct inode *inode, enum ra_stat which);
 
 /* statahead.c */
@@ -1568,6 +1681,16 @@ void ll_ra_stats_inc(struct inode *inode, enum ra_stat which);
 #define LL_SA_RUNNING_MAX	256
 #define LL_SA_RUNNING_DEF	16
 
+#define LL_SA_BATCH_MAX		1024
+#define LL_SA_BATCH_DEF		64
+
+/* consecutive names in a file name pattern needed to start statahead */
+#define LL_SA_FNAME_MIN		4
+/* consecutive negative lookups to stop statahead by file name pattern */
+#define LL_SA_FNAME_ENOENT_MAX	8
+/* idle time after which statahead by file name pattern quits */
+#define LL_SA_FNAME_IDLE	cfs_time_seconds(1)
+
 #define LL_SA_CACHE_BIT         5
 #define LL_SA_CACHE_SIZE        (1 << LL_SA_CACHE_BIT)
 #define LL_SA_CACHE_MASK        (LL_SA_CACHE_SIZE - 1)
@@ -1582,6 +1705,8 @@ struct ll_statahead_info {
 	__u64                   sai_replied;    /* stat requests which received
 						 * reply */
 	__u64                   sai_index;      /* index of statahead entry */
+	unsigned int		sai_batch_sent; /* stat requests sent since
+						 * replies were last handled */
 	__u64                   sai_index_wait; /* index of entry which is the
 						 * caller is waiting for */
 	__u64                   sai_hit;        /* hit count */
@@ -1600,7 +1725,19 @@ struct ll_statahead_info {
 						 */
 	unsigned int            sai_ls_all:1,   /* "ls -al", do stat-ahead for
 						 * hidden entries */
-				sai_in_readpage:1;/* statahead is in readdir()*/
+				sai_in_readpage:1,/* statahead is in readdir()*/
+				sai_fname:1,	/* statahead by file name
+						 * pattern, not readdir */
+				sai_agl_glimpse:1,/* AGL thread glimpses size */
+				sai_xattr:1;	/* AGL thread fills the xattr
+						 * cache */
+	unsigned int		sai_fname_enoent; /* consecutive negative
+						   * lookups in fname mode */
+	int			sai_fname_width;  /* zero-padded width of the
+						   * numeric suffix, or 0 */
+	int			sai_fname_prefix_len;
+	__u64			sai_fname_index;  /* next numeric suffix */
+	char			sai_fname_prefix[NAME_MAX + 1];
 	wait_queue_head_t	sai_waitq;	/* stat-ahead wait queue */
 	struct task_struct	*sai_task;	/* stat-ahead thread */
 	struct task_struct	*sai_agl_task;	/* AGL thread */
@@ -1617,6 +1754,8 @@ struct ll_statahead_info {
 int ll_revalidate_statahead(struct inode *dir, struct dentry **dentry,
 			    bool unplug);
 int ll_start_statahead(struct inode *dir, struct dentry *dentry, bool agl);
+void ll_statahead_fname_check(struct inode *dir, struct dentry *dentry,
+			      bool agl);
 void ll_authorize_statahead(struct inode *dir, void *key);
 void ll_deauthorize_statahead(struct inode *dir, void *key);
 
@@ -112,6 +112,7 @@ static struct ll_sb_info *ll_init_sbi(void)
 	spin_lock_init(&sbi->ll_pp_extent_lock);
 	spin_lock_init(&sbi->ll_process_lock);
         sbi->ll_rw_stats_on = 0;
+	spin_lock_init(&sbi->ll_ra_job_lock);
 	sbi->ll_statfs_max_age = OBD_STATFS_CACHE_SECONDS;
 
         si_meminfo(&si);
@@ -119,12 +120,10 @@ static struct ll_sb_info *ll_init_sbi(void)
 	lru_page_max = pages / 2;
 
 	sbi->ll_ra_info.ra_async_max_active = ll_get_ra_async_max_active();
-	sbi->ll_ra_info.ll_readahead_wq =
-		cfs_cpt_bind_workqueue("ll-readahead-wq", cfs_cpt_tab,
-				       0, CFS_CPT_ANY,
-				       sbi->ll_ra_info.ra_async_max_active);
-	if (IS_ERR(sbi->ll_ra_info.ll_readahead_wq))
-		GOTO(out_pcc, rc = PTR_ERR(sbi->ll_ra_info.ll_readahead_wq));
+	sbi->ll_ra_info.ra_async_max_per_file = LL_RA_ASYNC_PER_FILE_DEF;
+	rc = ll_readahead_wq_init(&sbi->ll_ra_info);
+	if (rc)
+		GOTO(out_pcc, rc);
 
 	/* initialize ll_cache data */
 	sbi->ll_cache = cl_cache_init(lru_page_max);
@@ -180,14 +179,19 @@ static struct ll_sb_info *ll_init_sbi(void)
 	/* metadata statahead is enabled by default */
 	sbi->ll_sa_running_max = LL_SA_RUNNING_DEF;
 	sbi->ll_sa_max = LL_SA_RPC_DEF;
+	sbi->ll_sa_batch_max = LL_SA_BATCH_DEF;
 	atomic_set(&sbi->ll_sa_total, 0);
 	atomic_set(&sbi->ll_sa_wrong, 0);
 	atomic_set(&sbi->ll_sa_running, 0);
 	atomic_set(&sbi->ll_agl_total, 0);
+	atomic_set(&sbi->ll_sa_fname_total, 0);
+	atomic_set(&sbi->ll_sa_xattr_total, 0);
 	set_bit(LL_SBI_AGL_ENABLED, sbi->ll_flags);
+	set_bit(LL_SBI_STATAHEAD_FNAME, sbi->ll_flags);
 	set_bit(LL_SBI_FAST_READ, sbi->ll_flags);
 	set_bit(LL_SBI_TINY_WRITE, sbi->ll_flags);
 	set_bit(LL_SBI_PARALLEL_DIO, sbi->ll_flags);
+	set_bit(LL_SBI_UNALIGNED_DIO, sbi->ll_flags);
 	set_bit(LL_SBI_STATFS_PROJECT, sbi->ll_flags);
 	ll_sbi_set_encrypt(sbi, true);
 	ll_sbi_set_name_encrypt(sbi, true);
@@ -205,6 +209,13 @@ static struct ll_sb_info *ll_init_sbi(void)
 	/* Per-fs open heat level before requesting open lock */
 	sbi->ll_oc_thrsh_count = SBI_DEFAULT_OPENCACHE_THRESHOLD_COUNT;
 	sbi->ll_oc_max_ms = SBI_DEFAULT_OPENCACHE_THRESHOLD_MAX_MS;
+	sbi->ll_oc_create_thrsh = SBI_DEFAULT_OPENCACHE_CREATE_THRESHOLD;
+	sbi->ll_neg_dentry_thrsh = SBI_DEFAULT_NEG_DENTRY_THRESHOLD;
+
+	sbi->ll_hybrid_io_read_threshold_bytes =
+		SBI_DEFAULT_HYBRID_IO_READ_THRESHOLD;
+	sbi->ll_hybrid_io_write_threshold_bytes =
+		SBI_DEFAULT_HYBRID_IO_WRITE_THRESHOLD;
 	sbi->ll_oc_thrsh_ms = SBI_DEFAULT_OPENCACHE_THRESHOLD_MS;
 	RETURN(sbi);
 out_destroy_ra:
@@ -214,7 +225,7 @@ out_destroy_ra:
 		cl_cache_decref(sbi->ll_cache);
 		sbi->ll_cache = NULL;
 	}
-	destroy_workqueue(sbi->ll_ra_info.ll_readahead_wq);
+	ll_readahead_wq_fini(&sbi->ll_ra_info);
 out_pcc:
 	pcc_super_fini(&sbi->ll_pcc_super);
 out_sbi:
@@ -230,8 +241,7 @@ static void ll_free_sbi(struct super_block *sb)
 	if (sbi != NULL) {
 		if (!list_empty(&sbi->ll_squash.rsi_nosquash_nids))
 			cfs_free_nidlist(&sbi->ll_squash.rsi_nosquash_nids);
-		if (sbi->ll_ra_info.ll_readahead_wq)
-			destroy_workqueue(sbi->ll_ra_info.ll_readahead_wq);
+		ll_readahead_wq_fini(&sbi->ll_ra_info);
 		if (sbi->ll_cache != NULL) {
 			cl_cache_decref(sbi->ll_cache);
 			sbi->ll_cache = NULL;
@@ -266,6 +276,7 @@ static void ll_free_sbi(struct super_block *sb)
 			ll_secctx_name_free(sbi);
 
 		ll_free_rw_stats_info(sbi);
+		ll_free_ra_job_stats_info(sbi);
 		pcc_super_fini(&sbi->ll_pcc_super);
 		OBD_FREE_LARGE(sbi, sizeof(*sbi));
 	}
@@ -556,7 +567,11 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt)
 				  OBD_CONNECT_FLAGS2 | OBD_CONNECT_GRANT_SHRINK;
 	data->ocd_connect_flags2 = OBD_CONNECT2_LOCKAHEAD |
 				   OBD_CONNECT2_INC_XID | OBD_CONNECT2_LSEEK |
-				   OBD_CONNECT2_REP_MBITS;
+				   OBD_CONNECT2_REP_MBITS |
+				   OBD_CONNECT2_MULTIOBJ_BRW;
+#if IS_ENABLED(CONFIG_LZ4_COMPRESS)
+	data->ocd_connect_flags2 |= OBD_CONNECT2_COMPRESS;
+#endif
 
 	if (!OBD_FAIL_CHECK(OBD_FAIL_OSC_CONNECT_GRANT_PARAM))
 		data->ocd_connect_flags |= OBD_CONNECT_GRANT_PARAM;
@@ -988,6 +1003,10 @@ static const match_table_t ll_sbi_flags_name = {
 	{LL_SBI_FILE_HEAT,		"file_heat"},
 	{LL_SBI_PARALLEL_DIO,		"parallel_dio"},
 	{LL_SBI_ENCRYPT_NAME,		"name_encrypt"},
+	{LL_SBI_STATAHEAD_FNAME,	"statahead_fname"},
+	{LL_SBI_UNALIGNED_DIO,		"unaligned_dio"},
+	{LL_SBI_HYBRID_IO,		"hybrid_io"},
+	{LL_SBI_STATAHEAD_XATTR,	"statahead_xattr"},
 };
 
 int ll_sbi_flags_seq_show(struct seq_file *m, void *v)
@@ -1222,6 +1241,11 @@ void ll_lli_init(struct ll_inode_info *lli)
 		spin_lock_init(&lli->lli_sa_lock);
 		lli->lli_opendir_pid = 0;
 		lli->lli_sa_enabled = 0;
+		lli->lli_sa_fname_hits = 0;
+		lli->lli_sa_fname_pid = 0;
+		lli->lli_create_count = 0;
+		lli->lli_create_time = ktime_set(0, 0);
+		atomic_set(&lli->lli_neg_lookups, 0);
 		init_rwsem(&lli->lli_lsm_sem);
 	} else {
 		mutex_init(&lli->lli_size_mutex);
@@ -3130,6 +3154,8 @@ void ll_umount_begin(struct super_block *sb)
 	}
 	obd->obd_force = 1;
 
+	pcc_super_ro_flush(&sbi->ll_pcc_super);
+
 	OBD_ALLOC_PTR(ioc_data);
 	if (ioc_data) {
 		obd_iocontrol(IOC_OSC_SET_ACTIVE, sbi->ll_md_exp,
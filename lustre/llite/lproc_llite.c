@@ -93,6 +93,8 @@ void llite_tunables_unregister(void)
 static const struct file_operations ll_rw_extents_stats_fops;
 static const struct file_operations ll_rw_extents_stats_pp_fops;
 static const struct file_operations ll_rw_offset_stats_fops;
+static const struct file_operations ll_ra_job_stats_fops;
+static const struct file_operations ll_ra_trace_fops;
 
 /**
  * ll_stats_pid_write() - Determine if stats collection should be enabled
@@ -463,7 +465,7 @@ static int ll_max_cached_mb_seq_show(struct seq_file *m, void *v)
 
 	mutex_lock(&cache->ccc_max_cache_mb_lock);
 	max_cached_mb = PAGES_TO_MiB(cache->ccc_lru_max);
-	unused_mb = PAGES_TO_MiB(atomic_long_read(&cache->ccc_lru_left));
+	unused_mb = PAGES_TO_MiB(cl_cache_lru_left(cache));
 	mutex_unlock(&cache->ccc_max_cache_mb_lock);
 
 	seq_printf(m, "users: %d\n"
@@ -472,14 +474,16 @@ static int ll_max_cached_mb_seq_show(struct seq_file *m, void *v)
 		      "unused_mb: %ld\n"
 		      "reclaim_count: %u\n"
 		      "max_read_ahead_mb: %lu\n"
-		      "used_read_ahead_mb: %d\n",
+		      "used_read_ahead_mb: %d\n"
+		      "lru_pcp_refill: %ld\n",
 		   atomic_read(&cache->ccc_users),
 		   max_cached_mb,
 		   max_cached_mb - unused_mb,
 		   unused_mb,
 		   cache->ccc_lru_shrinkers,
 		   PAGES_TO_MiB(ra->ra_max_pages),
-		   PAGES_TO_MiB(atomic_read(&ra->ra_cur_pages)));
+		   PAGES_TO_MiB(atomic_read(&ra->ra_cur_pages)),
+		   atomic_long_read(&cache->ccc_lru_pcp_refill));
 	return 0;
 }
 
@@ -541,6 +545,7 @@ static ssize_t ll_max_cached_mb_seq_write(struct file *file,
 		long tmp;
 
 		/* reduce LRU budget from free slots. */
+		cl_cache_lru_drain(cache);
 		do {
 			long lru_left_old, lru_left_new, lru_left_ret;
 
@@ -792,6 +797,41 @@ static ssize_t statahead_max_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(statahead_max);
 
+static ssize_t statahead_batch_max_show(struct kobject *kobj,
+					struct attribute *attr,
+					char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", sbi->ll_sa_batch_max);
+}
+
+static ssize_t statahead_batch_max_store(struct kobject *kobj,
+					 struct attribute *attr,
+					 const char *buffer,
+					 size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned long val;
+	int rc;
+
+	rc = kstrtoul(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > LL_SA_BATCH_MAX) {
+		CERROR("%s: Bad statahead_batch_max value %lu. Valid values are in the range [0, %d]\n",
+		       sbi->ll_fsname, val, LL_SA_BATCH_MAX);
+		return -ERANGE;
+	}
+
+	sbi->ll_sa_batch_max = val;
+	return count;
+}
+LUSTRE_RW_ATTR(statahead_batch_max);
+
 static ssize_t statahead_agl_show(struct kobject *kobj,
 				  struct attribute *attr,
 				  char *buf)
@@ -826,6 +866,77 @@ static ssize_t statahead_agl_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(statahead_agl);
 
+static ssize_t statahead_fname_show(struct kobject *kobj,
+				    struct attribute *attr,
+				    char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 test_bit(LL_SBI_STATAHEAD_FNAME, sbi->ll_flags));
+}
+
+static ssize_t statahead_fname_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer,
+				     size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		set_bit(LL_SBI_STATAHEAD_FNAME, sbi->ll_flags);
+	else
+		clear_bit(LL_SBI_STATAHEAD_FNAME, sbi->ll_flags);
+
+	return count;
+}
+LUSTRE_RW_ATTR(statahead_fname);
+
+static ssize_t statahead_xattr_show(struct kobject *kobj,
+				    struct attribute *attr,
+				    char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 test_bit(LL_SBI_STATAHEAD_XATTR, sbi->ll_flags));
+}
+
+static ssize_t statahead_xattr_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer,
+				     size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	if (val && !test_bit(LL_SBI_XATTR_CACHE, sbi->ll_flags))
+		return -ENOTSUPP;
+
+	if (val)
+		set_bit(LL_SBI_STATAHEAD_XATTR, sbi->ll_flags);
+	else
+		clear_bit(LL_SBI_STATAHEAD_XATTR, sbi->ll_flags);
+
+	return count;
+}
+LUSTRE_RW_ATTR(statahead_xattr);
+
 static int ll_statahead_stats_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block *sb = m->private;
@@ -833,10 +944,14 @@ static int ll_statahead_stats_seq_show(struct seq_file *m, void *v)
 
 	seq_printf(m, "statahead total: %u\n"
 		      "statahead wrong: %u\n"
-		      "agl total: %u\n",
+		      "agl total: %u\n"
+		      "fname total: %u\n"
+		      "xattr total: %u\n",
 		   atomic_read(&sbi->ll_sa_total),
 		   atomic_read(&sbi->ll_sa_wrong),
-		   atomic_read(&sbi->ll_agl_total));
+		   atomic_read(&sbi->ll_agl_total),
+		   atomic_read(&sbi->ll_sa_fname_total),
+		   atomic_read(&sbi->ll_sa_xattr_total));
 	return 0;
 }
 
@@ -1137,6 +1252,148 @@ static ssize_t parallel_dio_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(parallel_dio);
 
+static ssize_t unaligned_dio_show(struct kobject *kobj,
+				  struct attribute *attr,
+				  char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n",
+			test_bit(LL_SBI_UNALIGNED_DIO, sbi->ll_flags));
+}
+
+static ssize_t unaligned_dio_store(struct kobject *kobj,
+				   struct attribute *attr,
+				   const char *buffer,
+				   size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&sbi->ll_lock);
+	if (val)
+		set_bit(LL_SBI_UNALIGNED_DIO, sbi->ll_flags);
+	else
+		clear_bit(LL_SBI_UNALIGNED_DIO, sbi->ll_flags);
+	spin_unlock(&sbi->ll_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(unaligned_dio);
+
+static ssize_t hybrid_io_show(struct kobject *kobj, struct attribute *attr,
+			      char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n",
+			test_bit(LL_SBI_HYBRID_IO, sbi->ll_flags));
+}
+
+static ssize_t hybrid_io_store(struct kobject *kobj, struct attribute *attr,
+			       const char *buffer, size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&sbi->ll_lock);
+	if (val)
+		set_bit(LL_SBI_HYBRID_IO, sbi->ll_flags);
+	else
+		clear_bit(LL_SBI_HYBRID_IO, sbi->ll_flags);
+	spin_unlock(&sbi->ll_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(hybrid_io);
+
+static int ll_hybrid_io_threshold_parse(const char *buffer, size_t count,
+					unsigned int *threshold)
+{
+	u64 val;
+	int rc;
+
+	rc = sysfs_memparse(buffer, count, &val, "B");
+	if (rc)
+		return rc;
+
+	/* only whole pages can be sent directly */
+	if (val < PAGE_SIZE || val > UINT_MAX)
+		return -ERANGE;
+
+	*threshold = val;
+
+	return 0;
+}
+
+static ssize_t hybrid_io_read_threshold_bytes_show(struct kobject *kobj,
+						   struct attribute *attr,
+						   char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n",
+			sbi->ll_hybrid_io_read_threshold_bytes);
+}
+
+static ssize_t hybrid_io_read_threshold_bytes_store(struct kobject *kobj,
+						    struct attribute *attr,
+						    const char *buffer,
+						    size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	int rc;
+
+	rc = ll_hybrid_io_threshold_parse(buffer, count,
+				&sbi->ll_hybrid_io_read_threshold_bytes);
+
+	return rc ? rc : count;
+}
+LUSTRE_RW_ATTR(hybrid_io_read_threshold_bytes);
+
+static ssize_t hybrid_io_write_threshold_bytes_show(struct kobject *kobj,
+						    struct attribute *attr,
+						    char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n",
+			sbi->ll_hybrid_io_write_threshold_bytes);
+}
+
+static ssize_t hybrid_io_write_threshold_bytes_store(struct kobject *kobj,
+						     struct attribute *attr,
+						     const char *buffer,
+						     size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	int rc;
+
+	rc = ll_hybrid_io_threshold_parse(buffer, count,
+				&sbi->ll_hybrid_io_write_threshold_bytes);
+
+	return rc ? rc : count;
+}
+LUSTRE_RW_ATTR(hybrid_io_write_threshold_bytes);
+
 static ssize_t max_read_ahead_async_active_show(struct kobject *kobj,
 					       struct attribute *attr,
 					       char *buf)
@@ -1178,10 +1435,49 @@ static ssize_t max_read_ahead_async_active_store(struct kobject *kobj,
 	sbi->ll_ra_info.ra_async_max_active = val;
 	spin_unlock(&sbi->ll_lock);
 
+	ll_readahead_wq_set_max_active(&sbi->ll_ra_info);
+
 	return count;
 }
 LUSTRE_RW_ATTR(max_read_ahead_async_active);
 
+static ssize_t max_read_ahead_async_per_file_show(struct kobject *kobj,
+						  struct attribute *attr,
+						  char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 sbi->ll_ra_info.ra_async_max_per_file);
+}
+
+static ssize_t max_read_ahead_async_per_file_store(struct kobject *kobj,
+						   struct attribute *attr,
+						   const char *buffer,
+						   size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > LL_RA_ASYNC_PER_FILE_MAX) {
+		CERROR("%s: cannot set max_read_ahead_async_per_file=%u, valid range is [1, %u]\n",
+		       sbi->ll_fsname, val, LL_RA_ASYNC_PER_FILE_MAX);
+		return -ERANGE;
+	}
+
+	sbi->ll_ra_info.ra_async_max_per_file = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(max_read_ahead_async_per_file);
+
 static ssize_t read_ahead_async_file_threshold_mb_show(struct kobject *kobj,
 						       struct attribute *attr,
 						       char *buf)
@@ -1476,6 +1772,84 @@ static ssize_t opencache_threshold_ms_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(opencache_threshold_ms);
 
+static ssize_t opencache_create_threshold_show(struct kobject *kobj,
+					       struct attribute *attr,
+					       char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	if (sbi->ll_oc_create_thrsh)
+		return snprintf(buf, PAGE_SIZE, "%u\n",
+				sbi->ll_oc_create_thrsh);
+	else
+		return snprintf(buf, PAGE_SIZE, "off\n");
+}
+
+static ssize_t opencache_create_threshold_store(struct kobject *kobj,
+						struct attribute *attr,
+						const char *buffer,
+						size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc) {
+		bool enable;
+		/* also accept "off" to disable and "on" for every create */
+		rc = kstrtobool(buffer, &enable);
+		if (rc)
+			return rc;
+		val = enable;
+	}
+	sbi->ll_oc_create_thrsh = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(opencache_create_threshold);
+
+static ssize_t negative_dentry_threshold_show(struct kobject *kobj,
+					      struct attribute *attr,
+					      char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	if (sbi->ll_neg_dentry_thrsh)
+		return snprintf(buf, PAGE_SIZE, "%u\n",
+				sbi->ll_neg_dentry_thrsh);
+	else
+		return snprintf(buf, PAGE_SIZE, "off\n");
+}
+
+static ssize_t negative_dentry_threshold_store(struct kobject *kobj,
+					       struct attribute *attr,
+					       const char *buffer,
+					       size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc) {
+		bool enable;
+		/* also accept "off" to disable and "on" to fetch on any miss */
+		rc = kstrtobool(buffer, &enable);
+		if (rc)
+			return rc;
+		val = enable;
+	}
+	sbi->ll_neg_dentry_thrsh = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(negative_dentry_threshold);
+
 static ssize_t opencache_max_ms_show(struct kobject *kobj,
 				     struct attribute *attr,
 				     char *buf)
@@ -1805,6 +2179,7 @@ static struct attribute *llite_attrs[] = {
 	&lustre_attr_max_read_ahead_per_file_mb.attr,
 	&lustre_attr_max_read_ahead_whole_mb.attr,
 	&lustre_attr_max_read_ahead_async_active.attr,
+	&lustre_attr_max_read_ahead_async_per_file.attr,
 	&lustre_attr_read_ahead_async_file_threshold_mb.attr,
 	&lustre_attr_read_ahead_range_kb.attr,
 	&lustre_attr_stats_track_pid.attr,
@@ -1812,7 +2187,10 @@ static struct attribute *llite_attrs[] = {
 	&lustre_attr_stats_track_gid.attr,
 	&lustre_attr_statahead_running_max.attr,
 	&lustre_attr_statahead_max.attr,
+	&lustre_attr_statahead_batch_max.attr,
 	&lustre_attr_statahead_agl.attr,
+	&lustre_attr_statahead_fname.attr,
+	&lustre_attr_statahead_xattr.attr,
 	&lustre_attr_lazystatfs.attr,
 	&lustre_attr_statfs_max_age.attr,
 	&lustre_attr_statfs_project.attr,
@@ -1822,11 +2200,17 @@ static struct attribute *llite_attrs[] = {
 	&lustre_attr_fast_read.attr,
 	&lustre_attr_tiny_write.attr,
 	&lustre_attr_parallel_dio.attr,
+	&lustre_attr_unaligned_dio.attr,
+	&lustre_attr_hybrid_io.attr,
+	&lustre_attr_hybrid_io_read_threshold_bytes.attr,
+	&lustre_attr_hybrid_io_write_threshold_bytes.attr,
 	&lustre_attr_file_heat.attr,
 	&lustre_attr_heat_decay_percentage.attr,
 	&lustre_attr_heat_period_second.attr,
 	&lustre_attr_opencache_threshold_count.attr,
 	&lustre_attr_opencache_threshold_ms.attr,
+	&lustre_attr_opencache_create_threshold.attr,
+	&lustre_attr_negative_dentry_threshold.attr,
 	&lustre_attr_opencache_max_ms.attr,
 	NULL,
 };
@@ -1854,6 +2238,10 @@ static const struct llite_file_opcode {
 	/* file operation */
 	{ LPROC_LL_READ_BYTES,	LPROCFS_TYPE_BYTES_FULL, "read_bytes" },
 	{ LPROC_LL_WRITE_BYTES,	LPROCFS_TYPE_BYTES_FULL, "write_bytes" },
+	{ LPROC_LL_HYBRID_READ_BYTES, LPROCFS_TYPE_BYTES_FULL,
+						"hybrid_read_bytes" },
+	{ LPROC_LL_HYBRID_WRITE_BYTES, LPROCFS_TYPE_BYTES_FULL,
+						"hybrid_write_bytes" },
 	{ LPROC_LL_READ,	LPROCFS_TYPE_LATENCY,	"read" },
 	{ LPROC_LL_WRITE,	LPROCFS_TYPE_LATENCY,	"write" },
 	{ LPROC_LL_IOCTL,	LPROCFS_TYPE_REQS,	"ioctl" },
@@ -1889,6 +2277,9 @@ static const struct llite_file_opcode {
 	{ LPROC_LL_SETXATTR,	LPROCFS_TYPE_LATENCY,	"setxattr" },
 	{ LPROC_LL_GETXATTR,	LPROCFS_TYPE_LATENCY,	"getxattr" },
 	{ LPROC_LL_GETXATTR_HITS, LPROCFS_TYPE_REQS,	"getxattr_hits" },
+	{ LPROC_LL_NEG_DENTRY_HITS, LPROCFS_TYPE_REQS,	"negative_dentry_hits" },
+	{ LPROC_LL_NEG_DENTRY_MISSES, LPROCFS_TYPE_REQS,
+						"negative_dentry_misses" },
 	{ LPROC_LL_LISTXATTR,	LPROCFS_TYPE_LATENCY,	"listxattr" },
 	{ LPROC_LL_REMOVEXATTR,	LPROCFS_TYPE_LATENCY,	"removexattr" },
 	{ LPROC_LL_INODE_PERM,	LPROCFS_TYPE_LATENCY,	"inode_permission" },
@@ -1931,6 +2322,7 @@ static const char *const ra_stat_string[] = {
 	[RA_STAT_ASYNC]			= "async_readahead",
 	[RA_STAT_FAILED_FAST_READ]	= "failed_to_fast_read",
 	[RA_STAT_MMAP_RANGE_READ]	= "mmap_range_read",
+	[RA_STAT_SKIPPED_CACHED]	= "skipped_cached_pages",
 };
 
 int ll_debugfs_register_super(struct super_block *sb, const char *name)
@@ -1998,6 +2390,13 @@ int ll_debugfs_register_super(struct super_block *sb, const char *name)
 	debugfs_create_file("read_ahead_stats", 0644, sbi->ll_debugfs_entry,
 			    sbi->ll_ra_stats, &ldebugfs_stats_seq_fops);
 
+	debugfs_create_file("read_ahead_job_stats", 0644,
+			    sbi->ll_debugfs_entry, sbi,
+			    &ll_ra_job_stats_fops);
+
+	debugfs_create_file("read_ahead_trace", 0644, sbi->ll_debugfs_entry,
+			    sbi, &ll_ra_trace_fops);
+
 out_ll_kset:
 	/* Yes we also register sysfs mount kset here as well */
 	sbi->ll_kset.kobj.parent = llite_kobj;
@@ -2510,3 +2909,194 @@ static ssize_t ll_rw_offset_stats_seq_write(struct file *file,
 }
 
 LDEBUGFS_SEQ_FOPS(ll_rw_offset_stats);
+
+static int alloc_ra_job_stats_info(struct ll_sb_info *sbi)
+{
+	struct ll_ra_job_info *job;
+	struct ll_ra_trace_entry *trace;
+
+	OBD_ALLOC_PTR_ARRAY(job, LL_RA_JOB_HIST_MAX);
+	if (!job)
+		return -ENOMEM;
+	OBD_ALLOC_PTR_ARRAY_LARGE(trace, LL_RA_TRACE_MAX);
+	if (!trace) {
+		OBD_FREE_PTR_ARRAY(job, LL_RA_JOB_HIST_MAX);
+		return -ENOMEM;
+	}
+
+	spin_lock(&sbi->ll_ra_job_lock);
+	if (!sbi->ll_ra_job_info) {
+		sbi->ll_ra_job_info = job;
+		job = NULL;
+	}
+	if (!sbi->ll_ra_trace) {
+		sbi->ll_ra_trace = trace;
+		trace = NULL;
+	}
+	spin_unlock(&sbi->ll_ra_job_lock);
+
+	/* another writer allocated the structs before we got the lock */
+	if (job)
+		OBD_FREE_PTR_ARRAY(job, LL_RA_JOB_HIST_MAX);
+	if (trace)
+		OBD_FREE_PTR_ARRAY_LARGE(trace, LL_RA_TRACE_MAX);
+
+	return 0;
+}
+
+void ll_free_ra_job_stats_info(struct ll_sb_info *sbi)
+{
+	if (sbi->ll_ra_job_info) {
+		OBD_FREE_PTR_ARRAY(sbi->ll_ra_job_info, LL_RA_JOB_HIST_MAX);
+		sbi->ll_ra_job_info = NULL;
+	}
+	if (sbi->ll_ra_trace) {
+		OBD_FREE_PTR_ARRAY_LARGE(sbi->ll_ra_trace, LL_RA_TRACE_MAX);
+		sbi->ll_ra_trace = NULL;
+	}
+}
+
+/* enables/disables and resets both read_ahead_job_stats and read_ahead_trace */
+static ssize_t ll_ra_job_stats_write(struct ll_sb_info *sbi,
+				     const char __user *buf, size_t len)
+{
+	__s64 value;
+
+	if (len == 0)
+		return -EINVAL;
+
+	value = ll_stats_pid_write(buf, len);
+
+	if (value == 0) {
+		sbi->ll_ra_job_stats_on = 0;
+	} else {
+		if (!sbi->ll_ra_job_info || !sbi->ll_ra_trace) {
+			int rc = alloc_ra_job_stats_info(sbi);
+
+			if (rc)
+				return rc;
+		}
+		sbi->ll_ra_job_stats_on = 1;
+	}
+
+	spin_lock(&sbi->ll_ra_job_lock);
+	sbi->ll_ra_job_count = 0;
+	sbi->ll_ra_trace_count = 0;
+	sbi->ll_ra_job_stats_init = ktime_get_real();
+	if (sbi->ll_ra_job_info)
+		memset(sbi->ll_ra_job_info, 0,
+		       sizeof(*sbi->ll_ra_job_info) * LL_RA_JOB_HIST_MAX);
+	if (sbi->ll_ra_trace)
+		memset(sbi->ll_ra_trace, 0,
+		       sizeof(*sbi->ll_ra_trace) * LL_RA_TRACE_MAX);
+	spin_unlock(&sbi->ll_ra_job_lock);
+
+	return len;
+}
+
+static int ll_ra_job_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct ll_sb_info *sbi = seq->private;
+	struct ll_ra_job_info *job;
+	int i, j;
+
+	if (!sbi->ll_ra_job_stats_on) {
+		seq_puts(seq, "disabled\n write anything to this file to activate, then '0' or 'disable' to deactivate\n");
+		return 0;
+	}
+
+	spin_lock(&sbi->ll_ra_job_lock);
+	lprocfs_stats_header(seq, ktime_get_real(), sbi->ll_ra_job_stats_init,
+			     25, ":", true, "");
+	seq_puts(seq, "job_stats:\n");
+	job = sbi->ll_ra_job_info;
+	for (i = 0; job && i < LL_RA_JOB_HIST_MAX; i++) {
+		if (job[i].rji_jobid[0] == '\0')
+			continue;
+
+		seq_printf(seq, "- %-16s %s\n", "job_id:", job[i].rji_jobid);
+		for (j = 0; j < _NR_RA_STAT; j++) {
+			if (job[i].rji_stats[j] == 0)
+				continue;
+			seq_printf(seq, "  %-31s %llu\n", ra_stat_string[j],
+				   job[i].rji_stats[j]);
+		}
+	}
+	spin_unlock(&sbi->ll_ra_job_lock);
+
+	return 0;
+}
+
+static ssize_t ll_ra_job_stats_seq_write(struct file *file,
+					 const char __user *buf,
+					 size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+
+	return ll_ra_job_stats_write(seq->private, buf, len);
+}
+
+LDEBUGFS_SEQ_FOPS(ll_ra_job_stats);
+
+static const char *const ra_trace_decision_string[] = {
+	[LL_RA_TRACE_WHOLE_FILE]	= "whole_file",
+	[LL_RA_TRACE_RANDOM]		= "random",
+	[LL_RA_TRACE_SEQ_RANGE]		= "seq_range",
+	[LL_RA_TRACE_MMAP_RANGE]	= "mmap_range",
+	[LL_RA_TRACE_STRIDE_RESET]	= "stride_reset",
+	[LL_RA_TRACE_RESET]		= "reset",
+	[LL_RA_TRACE_KEEP]		= "keep",
+	[LL_RA_TRACE_INCREASE]		= "increase",
+};
+
+static int ll_ra_trace_seq_show(struct seq_file *seq, void *v)
+{
+	struct ll_sb_info *sbi = seq->private;
+	struct ll_ra_trace_entry *rte;
+	unsigned int i;
+
+	BUILD_BUG_ON(ARRAY_SIZE(ra_trace_decision_string) != _NR_LL_RA_TRACE);
+
+	if (!sbi->ll_ra_job_stats_on) {
+		seq_puts(seq, "disabled\n write anything to this file to activate, then '0' or 'disable' to deactivate\n");
+		return 0;
+	}
+
+	spin_lock(&sbi->ll_ra_job_lock);
+	seq_printf(seq, "%-20s %-24s %-16s %4s %12s %12s %10s %12s %12s %12s %s\n",
+		   "TIME", "FID", "JOBID", "HIT", "INDEX", "WIN_START",
+		   "WIN_PAGES", "NEXT_RA", "STRIDE_LEN", "STRIDE_BYTES",
+		   "DECISION");
+	/* oldest entry first */
+	i = sbi->ll_ra_trace_count > LL_RA_TRACE_MAX ?
+	    sbi->ll_ra_trace_count - LL_RA_TRACE_MAX : 0;
+	for (; sbi->ll_ra_trace && i < sbi->ll_ra_trace_count; i++) {
+		struct timespec64 ts;
+
+		rte = &sbi->ll_ra_trace[i % LL_RA_TRACE_MAX];
+		ts = ktime_to_timespec64(rte->rte_time);
+		seq_printf(seq, "%10llu.%09lu "DFID" %-16s %3s%c %12lu %12lu %10lu %12lu %12lld %12lld %s\n",
+			   (s64)ts.tv_sec, ts.tv_nsec, PFID(&rte->rte_fid),
+			   rte->rte_jobid[0] ? rte->rte_jobid : "-",
+			   rte->rte_hit ? "hit" : "mis",
+			   rte->rte_mmap ? 'm' : ' ',
+			   rte->rte_index, rte->rte_window_start_idx,
+			   rte->rte_window_pages, rte->rte_next_readahead_idx,
+			   rte->rte_stride_length, rte->rte_stride_bytes,
+			   ra_trace_decision_string[rte->rte_decision]);
+	}
+	spin_unlock(&sbi->ll_ra_job_lock);
+
+	return 0;
+}
+
+static ssize_t ll_ra_trace_seq_write(struct file *file,
+				     const char __user *buf,
+				     size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+
+	return ll_ra_job_stats_write(seq->private, buf, len);
+}
+
+LDEBUGFS_SEQ_FOPS(ll_ra_trace);
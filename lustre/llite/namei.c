@@ -174,6 +174,8 @@ static void ll_prune_negative_children(struct inode *dir)
 
 	ENTRY;
 
+	/* UPDATE lock is gone, start counting lookup misses again */
+	atomic_set(&ll_i2info(dir)->lli_neg_lookups, 0);
 restart:
 	spin_lock(&dir->i_lock);
 	hlist_for_each_entry(dentry, &dir->i_dentry, d_alias) {
@@ -650,6 +652,40 @@ struct dentry *ll_splice_alias(struct inode *inode, struct dentry *de)
         return de;
 }
 
+/*
+ * A negative dentry can only be trusted while the UPDATE lock of its parent
+ * is cached, which a plain lookup does not return.  After several lookup
+ * misses in the same directory (compilers and loaders probing search paths)
+ * fetch the lock with a getattr of the parent, so that further misses are
+ * answered from the dcache until the directory is modified.
+ *
+ * \retval true if the parent was revalidated and its lock may be cached
+ */
+static bool ll_neg_dentry_fetch_lock(struct inode *parent, struct dentry *de)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(parent);
+	struct ll_inode_info *lli = ll_i2info(parent);
+	struct dentry *pde = de->d_parent;
+	unsigned int thrsh = sbi->ll_neg_dentry_thrsh;
+
+	ll_stats_ops_tally(sbi, LPROC_LL_NEG_DENTRY_MISSES, 1);
+
+	/* a striped directory caches its negative dentries under the lock
+	 * of each stripe, which a getattr of the master doesn't return
+	 */
+	if (!thrsh || ll_dir_striped(parent) || pde->d_inode != parent)
+		return false;
+
+	if (atomic_inc_return(&lli->lli_neg_lookups) < thrsh)
+		return false;
+
+	atomic_set(&lli->lli_neg_lookups, 0);
+	CDEBUG(D_DENTRY, "%s: fetch UPDATE lock of "DFID" after %u misses\n",
+	       sbi->ll_fsname, PFID(ll_inode2fid(parent)), thrsh);
+
+	return ll_inode_revalidate(pde, IT_GETATTR) == 0;
+}
+
 static int ll_lookup_it_finish(struct ptlrpc_request *request,
 			       struct lookup_intent *it,
 			       struct inode *parent, struct dentry **de,
@@ -786,8 +822,15 @@ static int ll_lookup_it_finish(struct ptlrpc_request *request,
 				GOTO(out, rc);
 		}
 
-		if (md_revalidate_lock(ll_i2mdexp(parent), &parent_it, &fid,
-				       NULL)) {
+		if (!md_revalidate_lock(ll_i2mdexp(parent), &parent_it, &fid,
+					NULL) &&
+		    ll_neg_dentry_fetch_lock(parent, *de)) {
+			/* the UPDATE lock was just fetched, retry */
+			md_revalidate_lock(ll_i2mdexp(parent), &parent_it,
+					   &fid, NULL);
+		}
+
+		if (parent_it.it_lock_mode) {
 			d_lustre_revalidate(*de);
 			ll_intent_release(&parent_it);
 		}
@@ -1158,6 +1201,37 @@ do {									\
 
 #endif
 
+/*
+ * Files created in a burst in one directory, e.g. by untar or by a job
+ * writing checkpoint shards, are created with an open lock, so that their
+ * close is handled locally and the CLOSE RPC is only sent when the lock is
+ * cancelled. A burst is opencache_create_threshold creates by this client,
+ * each within opencache_threshold_ms of the previous one.
+ */
+static bool ll_create_burst(struct inode *dir)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	struct ll_inode_info *lli = ll_i2info(dir);
+	ktime_t now = ktime_get();
+	bool burst;
+
+	/* opencache is disabled altogether */
+	if (!sbi->ll_oc_create_thrsh || !sbi->ll_oc_thrsh_count)
+		return false;
+
+	write_lock(&lli->lli_lock);
+	if (ktime_before(now, ktime_add_ms(lli->lli_create_time,
+					   sbi->ll_oc_thrsh_ms)))
+		lli->lli_create_count++;
+	else
+		lli->lli_create_count = 1;
+	lli->lli_create_time = now;
+	burst = lli->lli_create_count >= sbi->ll_oc_create_thrsh;
+	write_unlock(&lli->lli_lock);
+
+	return burst;
+}
+
 /*
  * For cached negative dentry and new dentry, handle lookup/create/open
  * together.
@@ -1227,6 +1301,7 @@ static int ll_atomic_open(struct inode *dir, struct dentry *dentry,
 			item.pm_projid = ll_i2info(dir)->lli_projid;
 			item.pm_name = &dentry->d_name;
 			dataset = pcc_dataset_match_get(&sbi->ll_pcc_super,
+							LU_PCC_READWRITE,
 							&item);
 			pca.pca_dataset = dataset;
 		}
@@ -1260,11 +1335,12 @@ static int ll_atomic_open(struct inode *dir, struct dentry *dentry,
 
 	/* We can only arrive at this path when we have no inode, so
 	 * we only need to request open lock if it was requested
-	 * for every open
+	 * for every open, or if files are created here in a burst
 	 */
-	if (ll_i2sbi(dir)->ll_oc_thrsh_count == 1 &&
-	    exp_connect_flags2(ll_i2mdexp(dir)) &
-	    OBD_CONNECT2_ATOMIC_OPEN_LOCK)
+	if (exp_connect_flags2(ll_i2mdexp(dir)) &
+	    OBD_CONNECT2_ATOMIC_OPEN_LOCK &&
+	    (ll_i2sbi(dir)->ll_oc_thrsh_count == 1 ||
+	     (open_flags & O_CREAT && ll_create_burst(dir))))
 		it->it_flags |= MDS_OPEN_LOCK;
 
 	/* Dentry added to dcache tree in ll_lookup_it */
@@ -107,6 +107,7 @@
 #include "pcc.h"
 #include <linux/namei.h>
 #include <linux/file.h>
+#include <linux/mount.h>
 #include <lustre_compat.h>
 #include "llite_internal.h"
 
@@ -126,6 +127,12 @@ int pcc_super_init(struct pcc_super *super)
 	INIT_LIST_HEAD(&super->pccs_datasets);
 	super->pccs_generation = 1;
 
+	super->pccs_ro_wq = alloc_workqueue("pcc_ro", WQ_UNBOUND, 0);
+	if (!super->pccs_ro_wq) {
+		put_cred(super->pccs_cred);
+		return -ENOMEM;
+	}
+
 	return 0;
 }
 
@@ -496,6 +503,11 @@ pcc_parse_value_pair(struct pcc_cmd *cmd, char *buffer)
 			return rc;
 		if (id > 0)
 			cmd->u.pccc_add.pccc_flags |= PCC_DATASET_ROPCC;
+	} else if (strcmp(key, "romax_mb") == 0) {
+		rc = kstrtoul(val, 10, &id);
+		if (rc)
+			return rc;
+		cmd->u.pccc_add.pccc_ro_max_bytes = (__u64)id << 20;
 	} else {
 		return -EINVAL;
 	}
@@ -694,15 +706,27 @@ pcc_cond_match(struct pcc_match_rule *rule, struct pcc_matcher *matcher)
 	return 0;
 }
 
+static inline bool pcc_dataset_type_match(struct pcc_dataset *dataset,
+					  enum lu_pcc_type type)
+{
+	if (type == LU_PCC_READWRITE)
+		return dataset->pccd_flags & PCC_DATASET_RWPCC;
+	if (type == LU_PCC_READONLY)
+		return dataset->pccd_flags & PCC_DATASET_ROPCC &&
+		       dataset->pccd_ro_max_bytes != 0;
+	return false;
+}
+
 struct pcc_dataset*
-pcc_dataset_match_get(struct pcc_super *super, struct pcc_matcher *matcher)
+pcc_dataset_match_get(struct pcc_super *super, enum lu_pcc_type type,
+		      struct pcc_matcher *matcher)
 {
 	struct pcc_dataset *dataset;
 	struct pcc_dataset *selected = NULL;
 
 	down_read(&super->pccs_rw_sem);
 	list_for_each_entry(dataset, &super->pccs_datasets, pccd_linkage) {
-		if (!(dataset->pccd_flags & PCC_DATASET_RWPCC))
+		if (!pcc_dataset_type_match(dataset, type))
 			continue;
 
 		if (pcc_cond_match(&dataset->pccd_rule, matcher)) {
@@ -713,14 +737,28 @@ pcc_dataset_match_get(struct pcc_super *super, struct pcc_matcher *matcher)
 	}
 	up_read(&super->pccs_rw_sem);
 	if (selected)
-		CDEBUG(D_CACHE, "PCC create, matched %s - %d:%d:%d:%s\n",
-		       dataset->pccd_rule.pmr_conds_str,
+		CDEBUG(D_CACHE, "PCC %s, matched %s - %d:%d:%d:%s\n",
+		       pcc_type2string(type), dataset->pccd_rule.pmr_conds_str,
 		       matcher->pm_uid, matcher->pm_gid,
 		       matcher->pm_projid, matcher->pm_name->name);
 
 	return selected;
 }
 
+static const struct rhashtable_params pcc_ro_hash_params = {
+	.key_len	= sizeof(struct lu_fid),
+	.key_offset	= offsetof(struct pcc_ro_entry, pre_fid),
+	.head_offset	= offsetof(struct pcc_ro_entry, pre_hash),
+	.automatic_shrinking = true,
+};
+
+static void pcc_ro_entry_free(void *ptr, void *arg)
+{
+	struct pcc_ro_entry *entry = ptr;
+
+	OBD_FREE_PTR(entry);
+}
+
 /**
  * pcc_dataset_add - Add a Cache policy to control which files need be
  * cached and where it will be cached.
@@ -750,6 +788,15 @@ pcc_dataset_add(struct pcc_super *super, struct pcc_cmd *cmd)
 	dataset->pccd_rwid = cmd->u.pccc_add.pccc_rwid;
 	dataset->pccd_roid = cmd->u.pccc_add.pccc_roid;
 	dataset->pccd_flags = cmd->u.pccc_add.pccc_flags;
+	dataset->pccd_ro_max_bytes = cmd->u.pccc_add.pccc_ro_max_bytes;
+	spin_lock_init(&dataset->pccd_ro_lock);
+	INIT_LIST_HEAD(&dataset->pccd_ro_lru);
+	rc = rhashtable_init(&dataset->pccd_ro_hash, &pcc_ro_hash_params);
+	if (rc) {
+		path_put(&dataset->pccd_path);
+		OBD_FREE_PTR(dataset);
+		return rc;
+	}
 	atomic_set(&dataset->pccd_refcount, 1);
 
 	rc = pcc_dataset_rule_init(&dataset->pccd_rule, cmd);
@@ -799,6 +846,9 @@ pcc_dataset_get(struct pcc_super *super, enum lu_pcc_type type, __u32 id)
 		if (type == LU_PCC_READWRITE && (dataset->pccd_rwid != id ||
 		    !(dataset->pccd_flags & PCC_DATASET_RWPCC)))
 			continue;
+		if (type == LU_PCC_READONLY && (dataset->pccd_roid != id ||
+		    !(dataset->pccd_flags & PCC_DATASET_ROPCC)))
+			continue;
 		atomic_inc(&dataset->pccd_refcount);
 		selected = dataset;
 		break;
@@ -815,6 +865,9 @@ pcc_dataset_put(struct pcc_dataset *dataset)
 {
 	if (atomic_dec_and_test(&dataset->pccd_refcount)) {
 		pcc_dataset_rule_fini(&dataset->pccd_rule);
+		/* Copies stay on disk, they are adopted again on next use */
+		rhashtable_free_and_destroy(&dataset->pccd_ro_hash,
+					    pcc_ro_entry_free, NULL);
 		path_put(&dataset->pccd_path);
 		OBD_FREE_PTR(dataset);
 	}
@@ -847,7 +900,12 @@ pcc_dataset_dump(struct pcc_dataset *dataset, struct seq_file *m)
 {
 	seq_printf(m, "%s:\n", dataset->pccd_pathname);
 	seq_printf(m, "  rwid: %u\n", dataset->pccd_rwid);
+	seq_printf(m, "  roid: %u\n", dataset->pccd_roid);
 	seq_printf(m, "  flags: %x\n", dataset->pccd_flags);
+	spin_lock(&dataset->pccd_ro_lock);
+	seq_printf(m, "  romax_mb: %llu\n", dataset->pccd_ro_max_bytes >> 20);
+	seq_printf(m, "  rocached_bytes: %llu\n", dataset->pccd_ro_bytes);
+	spin_unlock(&dataset->pccd_ro_lock);
 	seq_printf(m, "  autocache: %s\n", dataset->pccd_rule.pmr_conds_str);
 }
 
@@ -878,8 +936,21 @@ static void pcc_remove_datasets(struct pcc_super *super)
 	up_write(&super->pccs_rw_sem);
 }
 
+/*
+ * Abort the queued and running RO-PCC copies on a forced umount. A plain
+ * umount is not blocked by them since they go through a private clone of
+ * the Lustre mount, they only keep the client alive until they end.
+ */
+void pcc_super_ro_flush(struct pcc_super *super)
+{
+	WRITE_ONCE(super->pccs_ro_stopping, true);
+	flush_workqueue(super->pccs_ro_wq);
+	WRITE_ONCE(super->pccs_ro_stopping, false);
+}
+
 void pcc_super_fini(struct pcc_super *super)
 {
+	destroy_workqueue(super->pccs_ro_wq);
 	pcc_remove_datasets(super);
 	put_cred(super->pccs_cred);
 }
@@ -1094,6 +1165,8 @@ static inline bool pcc_auto_attach_enabled(enum pcc_dataset_flags flags,
 }
 
 static const char pcc_xattr_layout[] = XATTR_USER_PREFIX "PCC.layout";
+/* Data version of the Lustre file a RO-PCC copy was made from */
+static const char pcc_xattr_dv[] = XATTR_USER_PREFIX "PCC.dv";
 
 static int pcc_layout_xattr_set(struct pcc_inode *pcci, __u32 gen)
 {
@@ -1183,6 +1256,19 @@ static inline bool pcc_inode_has_layout(struct pcc_inode *pcci)
 	return pcci->pcci_layout_gen != CL_LAYOUT_GEN_NONE;
 }
 
+static void __pcc_layout_invalidate(struct pcc_inode *pcci)
+{
+	pcci->pcci_type = LU_PCC_NONE;
+	pcc_layout_gen_set(pcci, CL_LAYOUT_GEN_NONE);
+	if (atomic_read(&pcci->pcci_active_ios) == 0)
+		return;
+
+	CDEBUG(D_CACHE, "Waiting for IO completion: %d\n",
+		       atomic_read(&pcci->pcci_active_ios));
+	wait_event_idle(pcci->pcci_waitq,
+			atomic_read(&pcci->pcci_active_ios) == 0);
+}
+
 static struct dentry *pcc_lookup(struct dentry *base, char *pathname)
 {
 	char *ptr = NULL, *component;
@@ -1249,6 +1335,173 @@ static struct dentry *pcc_lookup(struct dentry *base, char *pathname)
 	return child;
 }
 
+/* Unlink a PCC copy, the caller must run with the PCC credentials */
+static int pcc_ro_unlink(struct dentry *dentry)
+{
+	struct dentry *parent = dget_parent(dentry);
+	struct inode *dir = parent->d_inode;
+	int rc = 0;
+
+	inode_lock_nested(dir, I_MUTEX_PARENT);
+	if (dentry->d_parent == parent && !d_unhashed(dentry) &&
+	    d_is_positive(dentry))
+		rc = vfs_unlink(&nop_mnt_idmap, dir, dentry);
+	inode_unlock(dir);
+	dput(parent);
+
+	return rc;
+}
+
+/* Account the RO-PCC copy of @fid as the most recently used one */
+static void pcc_ro_lru_add(struct pcc_dataset *dataset, struct lu_fid *fid,
+			   loff_t size)
+{
+	struct pcc_ro_entry *entry;
+	struct pcc_ro_entry *old;
+
+	OBD_ALLOC_PTR(entry);
+	if (entry == NULL)
+		return;
+
+	entry->pre_fid = *fid;
+	entry->pre_size = size;
+	spin_lock(&dataset->pccd_ro_lock);
+	old = rhashtable_lookup_get_insert_fast(&dataset->pccd_ro_hash,
+						&entry->pre_hash,
+						pcc_ro_hash_params);
+	if (IS_ERR(old)) {
+		spin_unlock(&dataset->pccd_ro_lock);
+		OBD_FREE_PTR(entry);
+		return;
+	}
+
+	if (old) {
+		dataset->pccd_ro_bytes -= old->pre_size;
+		old->pre_size = size;
+		list_move(&old->pre_lru, &dataset->pccd_ro_lru);
+	} else {
+		list_add(&entry->pre_lru, &dataset->pccd_ro_lru);
+		entry = NULL;
+	}
+	dataset->pccd_ro_bytes += size;
+	spin_unlock(&dataset->pccd_ro_lock);
+
+	if (entry)
+		OBD_FREE_PTR(entry);
+}
+
+/*
+ * Remove the least recently used RO-PCC copies until the dataset is back
+ * under its limit. The caller must run with the PCC credentials.
+ */
+static void pcc_ro_evict(struct pcc_dataset *dataset)
+{
+	char pathname[PCC_DATASET_MAX_PATH];
+	struct pcc_ro_entry *entry;
+	struct dentry *dentry;
+	LIST_HEAD(victims);
+
+	spin_lock(&dataset->pccd_ro_lock);
+	while (dataset->pccd_ro_bytes > dataset->pccd_ro_max_bytes &&
+	       !list_empty(&dataset->pccd_ro_lru)) {
+		entry = list_last_entry(&dataset->pccd_ro_lru,
+					struct pcc_ro_entry, pre_lru);
+		rhashtable_remove_fast(&dataset->pccd_ro_hash,
+				       &entry->pre_hash, pcc_ro_hash_params);
+		list_move(&entry->pre_lru, &victims);
+		dataset->pccd_ro_bytes -= entry->pre_size;
+	}
+	spin_unlock(&dataset->pccd_ro_lock);
+
+	while ((entry = list_first_entry_or_null(&victims, struct pcc_ro_entry,
+						 pre_lru)) != NULL) {
+		list_del(&entry->pre_lru);
+		CDEBUG(D_CACHE, "RO-PCC evict "DFID", size %lld\n",
+		       PFID(&entry->pre_fid), entry->pre_size);
+		pcc_fid2dataset_path(pathname, sizeof(pathname),
+				     &entry->pre_fid);
+		dentry = pcc_lookup(dataset->pccd_path.dentry, pathname);
+		if (!IS_ERR(dentry)) {
+			(void) pcc_ro_unlink(dentry);
+			dput(dentry);
+		}
+		OBD_FREE_PTR(entry);
+	}
+}
+
+static struct pcc_ro_entry *
+pcc_ro_entry_lookup(struct pcc_dataset *dataset, struct lu_fid *fid)
+{
+	return rhashtable_lookup_fast(&dataset->pccd_ro_hash, fid,
+				      pcc_ro_hash_params);
+}
+
+/* Move the RO-PCC copy of @fid to the head of the LRU of its dataset */
+static void pcc_ro_lru_touch(struct pcc_super *super, struct lu_fid *fid)
+{
+	struct pcc_dataset *dataset;
+	struct pcc_ro_entry *entry;
+
+	down_read(&super->pccs_rw_sem);
+	list_for_each_entry(dataset, &super->pccs_datasets, pccd_linkage) {
+		spin_lock(&dataset->pccd_ro_lock);
+		entry = pcc_ro_entry_lookup(dataset, fid);
+		if (entry)
+			list_move(&entry->pre_lru, &dataset->pccd_ro_lru);
+		spin_unlock(&dataset->pccd_ro_lock);
+		if (entry)
+			break;
+	}
+	up_read(&super->pccs_rw_sem);
+}
+
+static void pcc_ro_lru_del(struct pcc_super *super, struct lu_fid *fid)
+{
+	struct pcc_dataset *dataset;
+	struct pcc_ro_entry *entry;
+
+	down_read(&super->pccs_rw_sem);
+	list_for_each_entry(dataset, &super->pccs_datasets, pccd_linkage) {
+		spin_lock(&dataset->pccd_ro_lock);
+		entry = pcc_ro_entry_lookup(dataset, fid);
+		if (entry) {
+			rhashtable_remove_fast(&dataset->pccd_ro_hash,
+					       &entry->pre_hash,
+					       pcc_ro_hash_params);
+			list_del(&entry->pre_lru);
+			dataset->pccd_ro_bytes -= entry->pre_size;
+		}
+		spin_unlock(&dataset->pccd_ro_lock);
+		if (entry) {
+			OBD_FREE_PTR(entry);
+			break;
+		}
+	}
+	up_read(&super->pccs_rw_sem);
+}
+
+/* Whether the RO-PCC copy still holds the current data of the Lustre file */
+static bool pcc_readonly_dv_match(struct inode *inode,
+				  struct dentry *pcc_dentry, __u64 *dv)
+{
+	__u64 pcc_dv;
+	int rc;
+
+	rc = ll_vfs_getxattr(pcc_dentry, pcc_dentry->d_inode, pcc_xattr_dv,
+			     &pcc_dv, sizeof(pcc_dv));
+	if (rc != sizeof(pcc_dv))
+		return false;
+
+	rc = ll_data_version(inode, dv, LL_DV_RD_FLUSH);
+	if (rc)
+		return false;
+
+	CDEBUG(D_CACHE, DFID" data version %llu, RO-PCC copy %llu\n",
+	       PFID(ll_inode2fid(inode)), *dv, pcc_dv);
+
+	return *dv == pcc_dv;
+}
+
 static int pcc_try_dataset_attach(struct inode *inode, __u32 gen,
 				  enum lu_pcc_type type,
 				  struct pcc_dataset *dataset,
@@ -1260,12 +1513,12 @@ static int pcc_try_dataset_attach(struct inode *inode, __u32 gen,
 	struct dentry *pcc_dentry = NULL;
 	char pathname[PCC_DATASET_MAX_PATH];
 	__u32 pcc_gen;
+	__u64 dv = 0;
 	int rc;
 
 	ENTRY;
 
-	if (type == LU_PCC_READWRITE &&
-	    !(dataset->pccd_flags & PCC_DATASET_RWPCC))
+	if (!pcc_dataset_type_match(dataset, type))
 		RETURN(0);
 
 	rc = pcc_fid2dataset_path(pathname, PCC_DATASET_MAX_PATH,
@@ -1289,6 +1542,11 @@ static int pcc_try_dataset_attach(struct inode *inode, __u32 gen,
 		GOTO(out_put_pcc_dentry, rc = 0);
 
 	rc = 0;
+	/* A RO-PCC copy must also hold the current data of the file */
+	if (pcc_gen == gen && type == LU_PCC_READONLY &&
+	    !pcc_readonly_dv_match(inode, pcc_dentry, &dv))
+		GOTO(out_put_pcc_dentry, rc);
+
 	/* The file is still valid cached in PCC, attach it immediately. */
 	if (pcc_gen == gen) {
 		CDEBUG(D_CACHE, DFID" L.Gen (%d) consistent, auto attached.\n",
@@ -1316,6 +1574,12 @@ static int pcc_try_dataset_attach(struct inode *inode, __u32 gen,
 		}
 		pcc_inode_dsflags_set(lli, dataset);
 		pcc_layout_gen_set(pcci, gen);
+		if (type == LU_PCC_READONLY) {
+			/* A copy made before the client was remounted */
+			pcci->pcci_data_version = dv;
+			pcc_ro_lru_add(dataset, &lli->lli_fid,
+				       i_size_read(pcc_dentry->d_inode));
+		}
 		*cached = true;
 	}
 out_put_pcc_dentry:
@@ -1349,8 +1613,9 @@ static int pcc_try_datasets_attach(struct inode *inode, enum pcc_io_type iot,
 
 	/*
 	 * Update the saved dataset flags for the inode accordingly if failed.
+	 * A file without a RO-PCC copy may still get one on a later open.
 	 */
-	if (!rc && !*cached) {
+	if (!rc && !*cached && type == LU_PCC_READWRITE) {
 		/*
 		 * Currently auto attach strategy for a PCC backend is
 		 * unchangeable once once it was added into the PCC datasets on
@@ -1446,6 +1711,9 @@ static int pcc_try_auto_attach(struct inode *inode, bool *cached,
 	if (clt.cl_is_released)
 		rc = pcc_try_datasets_attach(inode, iot, clt.cl_layout_gen,
 					     LU_PCC_READWRITE, cached);
+	else if (iot == PIT_OPEN && !lli->lli_open_fd_write_count)
+		rc = pcc_try_datasets_attach(inode, iot, clt.cl_layout_gen,
+					     LU_PCC_READONLY, cached);
 
 	RETURN(rc);
 }
@@ -1485,6 +1753,37 @@ static inline bool pcc_may_auto_attach(struct inode *inode,
 	return lli->lli_pcc_dsflags & PCC_DATASET_IO_ATTACH;
 }
 
+/*
+ * RO-PCC gives close-to-open coherency: a new open uses the copy only if the
+ * file is not opened for write on this client and its data version is still
+ * the one the copy was made from. Must be called with pcc_inode_lock held.
+ */
+static bool pcc_readonly_valid(struct inode *inode, struct file *file,
+			       struct pcc_inode *pcci)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	__u64 dv;
+
+	if (file->f_mode & FMODE_WRITE || lli->lli_open_fd_write_count)
+		return false;
+
+	/* The copy was evicted from the dataset */
+	if (d_unhashed(pcci->pcci_path.dentry))
+		return false;
+
+	if (ll_data_version(inode, &dv, LL_DV_RD_FLUSH) ||
+	    dv != pcci->pcci_data_version) {
+		CDEBUG(D_CACHE, DFID" modified since RO-PCC copy was made\n",
+		       PFID(&lli->lli_fid));
+		return false;
+	}
+
+	pcc_ro_lru_touch(ll_i2pccs(inode), &lli->lli_fid);
+	return true;
+}
+
+static void pcc_readonly_prefetch(struct inode *inode, struct file *file);
+
 int pcc_file_open(struct inode *inode, struct file *file)
 {
 	struct pcc_inode *pcci;
@@ -1510,10 +1809,21 @@ int pcc_file_open(struct inode *inode, struct file *file)
 	if (lli->lli_pcc_state & PCC_STATE_FL_ATTACHING)
 		GOTO(out_unlock, rc = 0);
 
+	if (pcci && pcc_inode_has_layout(pcci) &&
+	    pcci->pcci_type == LU_PCC_READONLY &&
+	    !pcc_readonly_valid(inode, file, pcci)) {
+		__pcc_layout_invalidate(pcci);
+		pcc_inode_put(pcci);
+		pcci = ll_i2pcci(inode);
+	}
+
 	if (!pcci || !pcc_inode_has_layout(pcci)) {
 		if (pcc_may_auto_attach(inode, PIT_OPEN))
 			rc = pcc_try_auto_attach(inode, &cached, PIT_OPEN);
 
+		if (rc == 0 && !cached)
+			pcc_readonly_prefetch(inode, file);
+
 		if (rc < 0 || !cached)
 			GOTO(out_unlock, rc);
 
@@ -1748,6 +2058,20 @@ out:
 	RETURN(result);
 }
 
+static void pcc_readonly_detach(struct inode *inode)
+{
+	struct pcc_inode *pcci;
+
+	pcc_inode_lock(inode);
+	pcci = ll_i2pcci(inode);
+	if (pcci && pcc_inode_has_layout(pcci) &&
+	    pcci->pcci_type == LU_PCC_READONLY) {
+		__pcc_layout_invalidate(pcci);
+		pcc_inode_put(pcci);
+	}
+	pcc_inode_unlock(inode);
+}
+
 int pcc_inode_setattr(struct inode *inode, struct iattr *attr,
 		      bool *cached)
 {
@@ -1768,6 +2092,15 @@ int pcc_inode_setattr(struct inode *inode, struct iattr *attr,
 	if (!*cached)
 		RETURN(0);
 
+	/* Lustre keeps the attributes of a RO-PCC file, drop a stale copy */
+	if (ll_i2pcci(inode)->pcci_type == LU_PCC_READONLY) {
+		pcc_io_fini(inode);
+		if (attr->ia_valid & ATTR_SIZE)
+			pcc_readonly_detach(inode);
+		*cached = false;
+		RETURN(0);
+	}
+
 	attr2.ia_valid = attr->ia_valid & (ATTR_SIZE | ATTR_ATIME |
 			 ATTR_ATIME_SET | ATTR_MTIME | ATTR_MTIME_SET |
 			 ATTR_CTIME | ATTR_UID | ATTR_GID);
@@ -1810,6 +2143,12 @@ int pcc_inode_getattr(struct inode *inode, u32 request_mask,
 	if (!*cached)
 		RETURN(0);
 
+	if (ll_i2pcci(inode)->pcci_type == LU_PCC_READONLY) {
+		pcc_io_fini(inode);
+		*cached = false;
+		RETURN(0);
+	}
+
 	old_cred = override_creds(pcc_super_cred(inode->i_sb));
 	rc = ll_vfs_getattr(&ll_i2pcci(inode)->pcci_path, &stat, request_mask,
 			    flags);
@@ -2102,19 +2441,6 @@ int pcc_fault(struct vm_area_struct *vma, struct vm_fault *vmf,
 	RETURN(rc);
 }
 
-static void __pcc_layout_invalidate(struct pcc_inode *pcci)
-{
-	pcci->pcci_type = LU_PCC_NONE;
-	pcc_layout_gen_set(pcci, CL_LAYOUT_GEN_NONE);
-	if (atomic_read(&pcci->pcci_active_ios) == 0)
-		return;
-
-	CDEBUG(D_CACHE, "Waiting for IO completion: %d\n",
-		       atomic_read(&pcci->pcci_active_ios));
-	wait_event_idle(pcci->pcci_waitq,
-			atomic_read(&pcci->pcci_active_ios) == 0);
-}
-
 void pcc_layout_invalidate(struct inode *inode)
 {
 	struct pcc_inode *pcci;
@@ -2405,7 +2731,9 @@ static int pcc_filp_write(struct file *filp, const void *buf, ssize_t count,
 	return 0;
 }
 
-static ssize_t pcc_copy_data(struct file *src, struct file *dst)
+/* The RO-PCC copies pass \a super to be aborted by pcc_super_ro_flush() */
+static ssize_t pcc_copy_data(struct file *src, struct file *dst,
+			     struct pcc_super *super)
 {
 	ssize_t rc = 0;
 	ssize_t rc2;
@@ -2423,6 +2751,9 @@ static ssize_t pcc_copy_data(struct file *src, struct file *dst)
 		if (signal_pending(current))
 			GOTO(out_free, rc = -EINTR);
 
+		if (super && READ_ONCE(super->pccs_ro_stopping))
+			GOTO(out_free, rc = -ESHUTDOWN);
+
 		pos = offset;
 		rc2 = cfs_kernel_read(src, buf, buf_len, &pos);
 		if (rc2 < 0)
@@ -2508,7 +2839,7 @@ int pcc_readwrite_attach(struct file *file, struct inode *inode,
 	if (rc)
 		GOTO(out_fput, rc);
 
-	ret = pcc_copy_data(file, pcc_filp);
+	ret = pcc_copy_data(file, pcc_filp, NULL);
 	if (ret < 0)
 		GOTO(out_fput, rc = ret);
 
@@ -2605,6 +2936,239 @@ out_unlock:
 	RETURN(rc);
 }
 
+struct pcc_ro_work {
+	struct work_struct	 prw_work;
+	struct pcc_dataset	*prw_dataset;
+	/*
+	 * Lustre file to copy, opened with the credentials of its opener.
+	 * Its mount is a private clone of the one it was opened through,
+	 * which is then not kept busy by the copy.
+	 */
+	struct path		 prw_path;
+	const struct cred	*prw_cred;
+};
+
+static void pcc_readonly_prefetch_work(struct work_struct *wk)
+{
+	struct pcc_ro_work *work = container_of(wk, struct pcc_ro_work,
+						prw_work);
+	struct pcc_dataset *dataset = work->prw_dataset;
+	struct inode *inode = d_inode(work->prw_path.dentry);
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct pcc_super *super = ll_i2pccs(inode);
+	struct dentry *dentry = NULL;
+	const struct cred *old_cred;
+	struct pcc_inode *pcci;
+	struct file *src;
+	struct file *dst;
+	struct path path;
+	__u32 gen, gen2;
+	__u64 dv, dv2;
+	ssize_t ret;
+	int rc;
+
+	ENTRY;
+
+	old_cred = override_creds(super->pccs_cred);
+	if (READ_ONCE(super->pccs_ro_stopping))
+		GOTO(out_clear, rc = -ESHUTDOWN);
+
+	rc = ll_layout_refresh(inode, &gen);
+	if (rc)
+		GOTO(out_clear, rc);
+
+	rc = ll_data_version(inode, &dv, LL_DV_RD_FLUSH);
+	if (rc)
+		GOTO(out_clear, rc);
+
+	/* Overwrite a stale copy left from an older data version */
+	rc = __pcc_inode_create(dataset, &lli->lli_fid, &dentry);
+	if (rc)
+		GOTO(out_clear, rc);
+
+	path.mnt = dataset->pccd_path.mnt;
+	path.dentry = dentry;
+	dst = dentry_open(&path, O_WRONLY | O_LARGEFILE, current_cred());
+	if (IS_ERR(dst))
+		GOTO(out_remove, rc = PTR_ERR(dst));
+
+	src = dentry_open(&work->prw_path, O_RDONLY | O_LARGEFILE,
+			  work->prw_cred);
+	if (IS_ERR(src)) {
+		fput(dst);
+		GOTO(out_remove, rc = PTR_ERR(src));
+	}
+
+	ret = pcc_copy_data(src, dst, super);
+	fput(src);
+	fput(dst);
+	if (ret < 0)
+		GOTO(out_remove, rc = ret);
+	if (ret > dataset->pccd_ro_max_bytes)
+		GOTO(out_remove, rc = -EFBIG);
+
+	rc = pcc_inode_reset_iattr(dentry, ATTR_SIZE, KUIDT_INIT(0),
+				   KGIDT_INIT(0), ret);
+	if (rc)
+		GOTO(out_remove, rc);
+
+	/* The file was modified by somebody while it was copied */
+	rc = ll_data_version(inode, &dv2, LL_DV_RD_FLUSH);
+	if (!rc && dv2 != dv)
+		rc = -ESTALE;
+	if (rc)
+		GOTO(out_remove, rc);
+
+	rc = ll_vfs_setxattr(dentry, dentry->d_inode, pcc_xattr_layout,
+			     &gen, sizeof(gen), 0);
+	if (!rc)
+		rc = ll_vfs_setxattr(dentry, dentry->d_inode, pcc_xattr_dv,
+				     &dv, sizeof(dv), 0);
+	if (rc)
+		GOTO(out_remove, rc);
+
+	pcc_ro_lru_add(dataset, &lli->lli_fid, ret);
+	pcc_ro_evict(dataset);
+
+	/*
+	 * The copy is complete and can be attached by a later open even if
+	 * it cannot be attached now.
+	 */
+	rc = ll_layout_refresh(inode, &gen2);
+	if (!rc && gen2 != gen)
+		rc = -ESTALE;
+	if (rc)
+		GOTO(out_clear, rc);
+
+	pcc_inode_lock(inode);
+	pcci = ll_i2pcci(inode);
+	if (lli->lli_open_fd_write_count) {
+		rc = -EBUSY;
+	} else if (!pcci) {
+		OBD_SLAB_ALLOC_PTR_GFP(pcci, pcc_inode_slab, GFP_NOFS);
+		if (pcci == NULL)
+			GOTO(out_unlock, rc = -ENOMEM);
+
+		pcc_inode_attach_set(super, dataset, lli, pcci,
+				     dentry, LU_PCC_READONLY);
+		dentry = NULL;
+	} else if (!pcc_inode_has_layout(pcci) &&
+		   pcci->pcci_path.dentry == dentry) {
+		/* Still opened through the copy of an older attach */
+		pcc_inode_get(pcci);
+		pcci->pcci_type = LU_PCC_READONLY;
+		down_read(&super->pccs_rw_sem);
+		pcc_inode_dsflags_set(lli, dataset);
+		up_read(&super->pccs_rw_sem);
+	} else {
+		rc = -EBUSY;
+	}
+
+	if (!rc) {
+		pcci->pcci_data_version = dv;
+		pcc_layout_gen_set(pcci, gen);
+		CDEBUG(D_CACHE, DFID" RO-PCC attached, size %zd, dv %llu\n",
+		       PFID(&lli->lli_fid), ret, dv);
+	}
+out_unlock:
+	lli->lli_pcc_state &= ~PCC_STATE_FL_ATTACHING;
+	pcc_inode_unlock(inode);
+	GOTO(out_dput, rc);
+
+out_remove:
+	(void) pcc_ro_unlink(dentry);
+out_clear:
+	pcc_inode_lock(inode);
+	lli->lli_pcc_state &= ~PCC_STATE_FL_ATTACHING;
+	pcc_inode_unlock(inode);
+out_dput:
+	if (dentry)
+		dput(dentry);
+	revert_creds(old_cred);
+	if (rc)
+		CDEBUG(D_CACHE, DFID" RO-PCC prefetch failed: rc = %d\n",
+		       PFID(&lli->lli_fid), rc);
+
+	put_cred(work->prw_cred);
+	dput(work->prw_path.dentry);
+	kern_unmount(work->prw_path.mnt);
+	pcc_dataset_put(dataset);
+	OBD_FREE_PTR(work);
+	EXIT;
+}
+
+/*
+ * Copy a file matching a RO-PCC rule into the dataset in the background on
+ * its first read-only open. This open and the ones done before the copy is
+ * attached are served by Lustre. Must be called with pcc_inode_lock held.
+ */
+static void pcc_readonly_prefetch(struct inode *inode, struct file *file)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct pcc_super *super = ll_i2pccs(inode);
+	struct cl_layout clt = {
+		.cl_layout_gen = 0,
+		.cl_is_released = false,
+	};
+	struct dentry *dentry = file_dentry(file);
+	const struct cred *old_cred;
+	struct pcc_dataset *dataset;
+	struct pcc_matcher item;
+	struct pcc_ro_work *work;
+	struct vfsmount *mnt;
+
+	if (list_empty(&super->pccs_datasets))
+		return;
+
+	if (file->f_mode & FMODE_WRITE || lli->lli_open_fd_write_count)
+		return;
+
+	if (READ_ONCE(super->pccs_ro_stopping))
+		return;
+
+	item.pm_uid = from_kuid(&init_user_ns, current_uid());
+	item.pm_gid = from_kgid(&init_user_ns, current_gid());
+	item.pm_projid = lli->lli_projid;
+	item.pm_name = &dentry->d_name;
+	dataset = pcc_dataset_match_get(super, LU_PCC_READONLY, &item);
+	if (dataset == NULL)
+		return;
+
+	if (i_size_read(inode) > dataset->pccd_ro_max_bytes)
+		goto out_put;
+
+	/* Released files are handled by RW-PCC */
+	if (pcc_get_layout_info(inode, &clt) || clt.cl_is_released)
+		goto out_put;
+
+	OBD_ALLOC_PTR(work);
+	if (work == NULL)
+		goto out_put;
+
+	/* the opener may not be allowed to clone the mount */
+	old_cred = override_creds(super->pccs_cred);
+	mnt = clone_private_mount(&file->f_path);
+	revert_creds(old_cred);
+	if (IS_ERR(mnt)) {
+		CDEBUG(D_CACHE, DFID" RO-PCC cannot clone mount: rc = %ld\n",
+		       PFID(&lli->lli_fid), PTR_ERR(mnt));
+		OBD_FREE_PTR(work);
+		goto out_put;
+	}
+
+	INIT_WORK(&work->prw_work, pcc_readonly_prefetch_work);
+	work->prw_dataset = dataset;
+	work->prw_path.mnt = mnt;
+	work->prw_path.dentry = dget(file->f_path.dentry);
+	work->prw_cred = get_current_cred();
+	lli->lli_pcc_state |= PCC_STATE_FL_ATTACHING;
+	queue_work(super->pccs_ro_wq, &work->prw_work);
+	return;
+
+out_put:
+	pcc_dataset_put(dataset);
+}
+
 static int pcc_hsm_remove(struct inode *inode)
 {
 	struct hsm_user_request *hur;
@@ -2650,6 +3214,7 @@ static int pcc_hsm_remove(struct inode *inode)
 int pcc_ioctl_detach(struct inode *inode, __u32 opt)
 {
 	struct ll_inode_info *lli = ll_i2info(inode);
+	struct dentry *ro_dentry = NULL;
 	struct pcc_inode *pcci;
 	bool hsm_remove = false;
 	int rc = 0;
@@ -2674,13 +3239,25 @@ int pcc_ioctl_detach(struct inode *inode, __u32 opt)
 			 */
 			lli->lli_pcc_dsflags = PCC_DATASET_NONE;
 		}
-
-		__pcc_layout_invalidate(pcci);
-		pcc_inode_put(pcci);
+	} else if (pcci->pcci_type == LU_PCC_READONLY) {
+		if (opt == PCC_DETACH_OPT_UNCACHE)
+			ro_dentry = dget(pcci->pcci_path.dentry);
 	}
 
+	__pcc_layout_invalidate(pcci);
+	pcc_inode_put(pcci);
+
 out_unlock:
 	pcc_inode_unlock(inode);
+	if (ro_dentry) {
+		const struct cred *old_cred;
+
+		old_cred = override_creds(pcc_super_cred(inode->i_sb));
+		pcc_ro_lru_del(ll_i2pccs(inode), &lli->lli_fid);
+		rc = pcc_ro_unlink(ro_dentry);
+		revert_creds(old_cred);
+		dput(ro_dentry);
+	}
 	if (hsm_remove) {
 		const struct cred *old_cred;
 
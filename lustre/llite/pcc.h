@@ -36,6 +36,7 @@
 #include <linux/fs.h>
 #include <linux/seq_file.h>
 #include <linux/mm.h>
+#include <linux/rhashtable.h>
 #include <uapi/linux/lustre/lustre_user.h>
 
 extern struct kmem_cache *pcc_inode_slab;
@@ -111,6 +112,14 @@ enum pcc_dataset_flags {
 	PCC_DATASET_PCC_ALL	= PCC_DATASET_RWPCC | PCC_DATASET_ROPCC,
 };
 
+/* RO-PCC copy made by this client, on the LRU of its dataset */
+struct pcc_ro_entry {
+	struct lu_fid		pre_fid;
+	loff_t			pre_size;
+	struct rhash_head	pre_hash;	/* Linked to pccd_ro_hash */
+	struct list_head	pre_lru;	/* Linked to pccd_ro_lru */
+};
+
 struct pcc_dataset {
 	__u32			pccd_rwid;	 /* Archive ID */
 	__u32			pccd_roid;	 /* Readonly ID */
@@ -120,6 +129,16 @@ struct pcc_dataset {
 	struct path		pccd_path;	 /* Root path */
 	struct list_head	pccd_linkage;  /* Linked to pccs_datasets */
 	atomic_t		pccd_refcount; /* Reference count */
+	/*
+	 * RO-PCC: files matching the rule are copied in on their first
+	 * read-only open, up to pccd_ro_max_bytes in total, and the least
+	 * recently opened copies are removed beyond that. 0 disables it.
+	 */
+	__u64			pccd_ro_max_bytes;
+	__u64			pccd_ro_bytes;	 /* Size of copies on LRU */
+	spinlock_t		pccd_ro_lock;	 /* Protect LRU and hash */
+	struct list_head	pccd_ro_lru;
+	struct rhashtable	pccd_ro_hash;	 /* FID to pcc_ro_entry */
 };
 
 struct pcc_super {
@@ -135,6 +154,10 @@ struct pcc_super {
 	 * parameters for PCC.
 	 */
 	__u64			 pccs_generation;
+	/* Copy files into RO-PCC in the background */
+	struct workqueue_struct	*pccs_ro_wq;
+	/* set while the copies are aborted for umount -f */
+	bool			 pccs_ro_stopping;
 };
 
 struct pcc_inode {
@@ -152,6 +175,8 @@ struct pcc_inode {
 	bool			 pcci_attr_valid;
 	/* Layout generation */
 	__u32			 pcci_layout_gen;
+	/* Data version of the Lustre file the RO-PCC copy was made from */
+	__u64			 pcci_data_version;
 	/*
 	 * How many IOs are on going on this cached object. Layout can be
 	 * changed only if there is no active IO.
@@ -204,6 +229,7 @@ struct pcc_cmd {
 		struct pcc_cmd_add {
 			__u32			 pccc_rwid;
 			__u32			 pccc_roid;
+			__u64			 pccc_ro_max_bytes;
 			struct list_head	 pccc_conds;
 			char			*pccc_conds_str;
 			enum pcc_dataset_flags	 pccc_flags;
@@ -221,6 +247,7 @@ struct pcc_create_attach {
 
 int pcc_super_init(struct pcc_super *super);
 void pcc_super_fini(struct pcc_super *super);
+void pcc_super_ro_flush(struct pcc_super *super);
 int pcc_cmd_handle(char *buffer, unsigned long count,
 		   struct pcc_super *super);
 int pcc_super_dump(struct pcc_super *super, struct seq_file *m);
@@ -261,6 +288,7 @@ int pcc_inode_create_fini(struct inode *inode, struct pcc_create_attach *pca);
 void pcc_create_attach_cleanup(struct super_block *sb,
 			       struct pcc_create_attach *pca);
 struct pcc_dataset *pcc_dataset_match_get(struct pcc_super *super,
+					  enum lu_pcc_type type,
 					  struct pcc_matcher *matcher);
 void pcc_dataset_put(struct pcc_dataset *dataset);
 void pcc_inode_free(struct inode *inode);
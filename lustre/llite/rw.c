@@ -145,10 +145,97 @@ static inline bool ll_readahead_enabled(struct ll_sb_info *sbi)
 		sbi->ll_ra_info.ra_max_pages > 0;
 }
 
-void ll_ra_stats_inc(struct inode *inode, enum ra_stat which)
+/*
+ * Account readahead event @which to the job the inode was last accessed by,
+ * when read_ahead_job_stats is enabled. The slot of the oldest job is reused
+ * when a new one shows up.
+ */
+static void ll_ra_job_stats_add(struct ll_sb_info *sbi, struct inode *inode,
+				enum ra_stat which, long amount)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct ll_ra_job_info *job;
+	int i;
+
+	if (!sbi->ll_ra_job_stats_on || !S_ISREG(inode->i_mode) ||
+	    lli->lli_jobid[0] == '\0')
+		return;
+
+	spin_lock(&sbi->ll_ra_job_lock);
+	job = sbi->ll_ra_job_info;
+	if (!job)
+		goto out_unlock;
+
+	for (i = 0; i < LL_RA_JOB_HIST_MAX; i++) {
+		if (strncmp(job[i].rji_jobid, lli->lli_jobid,
+			    sizeof(job[i].rji_jobid)) == 0)
+			break;
+	}
+	if (i == LL_RA_JOB_HIST_MAX) {
+		sbi->ll_ra_job_count =
+			(sbi->ll_ra_job_count + 1) % LL_RA_JOB_HIST_MAX;
+		i = sbi->ll_ra_job_count;
+		memset(&job[i], 0, sizeof(job[i]));
+		memcpy(job[i].rji_jobid, lli->lli_jobid,
+		       sizeof(job[i].rji_jobid));
+		job[i].rji_jobid[sizeof(job[i].rji_jobid) - 1] = '\0';
+	}
+	job[i].rji_stats[which] += amount;
+out_unlock:
+	spin_unlock(&sbi->ll_ra_job_lock);
+}
+
+static void ll_ra_stats_add(struct inode *inode, enum ra_stat which,
+			    long amount)
 {
 	struct ll_sb_info *sbi = ll_i2sbi(inode);
-	ll_ra_stats_inc_sbi(sbi, which);
+
+	LASSERTF(which < _NR_RA_STAT, "which: %u\n", which);
+	lprocfs_counter_add(sbi->ll_ra_stats, which, amount);
+	ll_ra_job_stats_add(sbi, inode, which, amount);
+}
+
+void ll_ra_stats_inc(struct inode *inode, enum ra_stat which)
+{
+	ll_ra_stats_add(inode, which, 1);
+}
+
+/*
+ * Record how ras_update() handled an access to @index in the trace ring
+ * shown by read_ahead_trace. Hits that only moved the window start are not
+ * recorded, they would push everything interesting out of the ring.
+ */
+static void ll_ra_trace_add(struct ll_sb_info *sbi, struct inode *inode,
+			    struct ll_readahead_state *ras, pgoff_t index,
+			    enum ras_update_flags flags,
+			    enum ll_ra_trace_decision decision)
+{
+	struct ll_ra_trace_entry *rte;
+
+	if (!sbi->ll_ra_job_stats_on ||
+	    ((flags & LL_RAS_HIT) && decision == LL_RA_TRACE_KEEP))
+		return;
+
+	spin_lock(&sbi->ll_ra_job_lock);
+	if (sbi->ll_ra_trace) {
+		rte = &sbi->ll_ra_trace[sbi->ll_ra_trace_count++ %
+					LL_RA_TRACE_MAX];
+		rte->rte_time = ktime_get_real();
+		rte->rte_fid = *ll_inode2fid(inode);
+		memcpy(rte->rte_jobid, ll_i2info(inode)->lli_jobid,
+		       sizeof(rte->rte_jobid));
+		rte->rte_jobid[sizeof(rte->rte_jobid) - 1] = '\0';
+		rte->rte_index = index;
+		rte->rte_window_start_idx = ras->ras_window_start_idx;
+		rte->rte_window_pages = ras->ras_window_pages;
+		rte->rte_next_readahead_idx = ras->ras_next_readahead_idx;
+		rte->rte_stride_length = ras->ras_stride_length;
+		rte->rte_stride_bytes = ras->ras_stride_bytes;
+		rte->rte_hit = !!(flags & LL_RAS_HIT);
+		rte->rte_mmap = !!(flags & LL_RAS_MMAP);
+		rte->rte_decision = decision;
+	}
+	spin_unlock(&sbi->ll_ra_job_lock);
 }
 
 #define RAS_CDEBUG(ras) \
@@ -410,19 +497,63 @@ static bool ras_inside_ra_window(pgoff_t idx, struct ra_io_arg *ria)
 	return false;
 }
 
+/*
+ * Return how many pages starting at @index, but not beyond @end, are already
+ * uptodate in the page cache. They are looked up a batch of folios at a time,
+ * so cached parts of the readahead window are stepped over without locking
+ * every page and looking up its cl_page.
+ */
+static pgoff_t ll_ra_count_cached(struct address_space *mapping,
+				  pgoff_t index, pgoff_t end)
+{
+#ifdef HAVE_FILEMAP_GET_FOLIOS_CONTIG
+	struct folio_batch fbatch;
+	pgoff_t start = index;
+	pgoff_t next = index;
+	int nr, i;
+
+	folio_batch_init(&fbatch);
+	while (next <= end) {
+		nr = filemap_get_folios_contig(mapping, &start, end, &fbatch);
+		if (nr == 0)
+			break;
+
+		for (i = 0; i < nr; i++) {
+			struct folio *folio = fbatch.folios[i];
+
+			if (folio->index > next || !folio_test_uptodate(folio))
+				break;
+			next = folio->index + folio_nr_pages(folio);
+		}
+		folio_batch_release(&fbatch);
+		if (i < nr)
+			break;
+	}
+
+	return min(next, end + 1) - index;
+#else
+	return 0;
+#endif
+}
+
 static unsigned long
 ll_read_ahead_pages(const struct lu_env *env, struct cl_io *io,
 		    struct cl_page_list *queue, struct ll_readahead_state *ras,
 		    struct ra_io_arg *ria, pgoff_t *ra_end, pgoff_t skip_index)
 {
+	struct inode *inode = vvp_object_inode(io->ci_obj);
 	struct cl_read_ahead ra = { 0 };
 	/* busy page count is per stride */
 	int rc = 0, count = 0, busy_page_count = 0;
 	pgoff_t page_idx;
+	bool prealloc;
 
 	LASSERT(ria != NULL);
 	RIA_DEBUG(ria);
 
+	prealloc = cl_page_prealloc_begin(env, io->ci_obj,
+				min_t(unsigned long, ria->ria_reserved,
+				      ria->ria_end_idx - ria->ria_start_idx + 1));
 	for (page_idx = ria->ria_start_idx;
 	     page_idx <= ria->ria_end_idx && ria->ria_reserved > 0;
 	     page_idx++) {
@@ -488,6 +619,20 @@ ll_read_ahead_pages(const struct lu_env *env, struct cl_io *io,
 						MAYNEED);
 			if (rc < 0 && rc != -EBUSY)
 				break;
+			/* the page was cached, so probably are the next ones */
+			if (rc == 1 && page_idx < ria->ria_end_idx) {
+				pgoff_t nr;
+
+				nr = ll_ra_count_cached(inode->i_mapping,
+							page_idx + 1,
+							ria->ria_end_idx);
+				if (nr > 0) {
+					ll_ra_stats_add(inode,
+							RA_STAT_SKIPPED_CACHED,
+							nr);
+					page_idx += nr;
+				}
+			}
 			if (rc == -EBUSY) {
 				busy_page_count++;
 				CDEBUG(D_READA,
@@ -532,12 +677,90 @@ ll_read_ahead_pages(const struct lu_env *env, struct cl_io *io,
 	}
 
 	cl_read_ahead_release(env, &ra);
+	if (prealloc)
+		cl_page_prealloc_end(env);
 
 	return count;
 }
 
+/*
+ * The workers of the readahead workqueue of partition \a cpt, its share of
+ * ll_ra_info::ra_async_max_active by the number of its CPUs.
+ */
+static int ll_readahead_wq_max_active(struct ll_ra_info *ra, int cpt)
+{
+	int total = cfs_cpt_weight(cfs_cpt_tab, CFS_CPT_ANY);
+
+	return max_t(int, ra->ra_async_max_active *
+			  cfs_cpt_weight(cfs_cpt_tab, cpt) / max(total, 1), 1);
+}
+
+/*
+ * Async readahead works are queued on the workqueue of the CPU partition the
+ * reader runs on, so readahead pages are allocated and RPCs are built close
+ * to the reader, and readers on different partitions don't compete for the
+ * same set of workers. max_read_ahead_async_active is shared among the
+ * workqueues.
+ */
+int ll_readahead_wq_init(struct ll_ra_info *ra)
+{
+	int ncpts = cfs_cpt_number(cfs_cpt_tab);
+	int i;
+
+	OBD_ALLOC_PTR_ARRAY(ra->ll_readahead_wqs, ncpts);
+	if (!ra->ll_readahead_wqs)
+		return -ENOMEM;
+
+	for (i = 0; i < ncpts; i++) {
+		struct workqueue_struct *wq;
+		char name[32];
+
+		snprintf(name, sizeof(name), "ll-readahead-wq-%d", i);
+		wq = cfs_cpt_bind_workqueue(name, cfs_cpt_tab, 0, i,
+					    ll_readahead_wq_max_active(ra, i));
+		if (IS_ERR(wq)) {
+			ll_readahead_wq_fini(ra);
+			return PTR_ERR(wq);
+		}
+		ra->ll_readahead_wqs[i] = wq;
+	}
+
+	return 0;
+}
+
+/* apply a new max_read_ahead_async_active to the readahead workqueues */
+void ll_readahead_wq_set_max_active(struct ll_ra_info *ra)
+{
+	int i;
+
+	if (!ra->ll_readahead_wqs)
+		return;
+
+	for (i = 0; i < cfs_cpt_number(cfs_cpt_tab); i++)
+		workqueue_set_max_active(ra->ll_readahead_wqs[i],
+					 ll_readahead_wq_max_active(ra, i));
+}
+
+void ll_readahead_wq_fini(struct ll_ra_info *ra)
+{
+	int i;
+
+	if (!ra->ll_readahead_wqs)
+		return;
+
+	for (i = 0; i < cfs_cpt_number(cfs_cpt_tab); i++) {
+		if (ra->ll_readahead_wqs[i])
+			destroy_workqueue(ra->ll_readahead_wqs[i]);
+	}
+	OBD_FREE_PTR_ARRAY(ra->ll_readahead_wqs, cfs_cpt_number(cfs_cpt_tab));
+	ra->ll_readahead_wqs = NULL;
+}
+
 static void ll_readahead_work_free(struct ll_readahead_work *work)
 {
+	struct ll_file_data *fd = work->lrw_file->private_data;
+
+	atomic_dec(&fd->fd_ras.ras_async_inflight);
 	fput(work->lrw_file);
 	OBD_FREE_PTR(work);
 }
@@ -546,8 +769,10 @@ static void ll_readahead_handle_work(struct work_struct *wq);
 static void ll_readahead_work_add(struct inode *inode,
 				  struct ll_readahead_work *work)
 {
+	int cpt = cfs_cpt_current(cfs_cpt_tab, 1);
+
 	INIT_WORK(&work->lrw_readahead_work, ll_readahead_handle_work);
-	queue_work(ll_i2sbi(inode)->ll_ra_info.ll_readahead_wq,
+	queue_work(ll_i2sbi(inode)->ll_ra_info.ll_readahead_wqs[cpt],
 		   &work->lrw_readahead_work);
 }
 
@@ -949,6 +1174,7 @@ void ll_readahead_init(struct inode *inode, struct ll_readahead_state *ras)
 {
 	spin_lock_init(&ras->ras_lock);
 	ras->ras_rpc_pages = PTLRPC_MAX_BRW_PAGES;
+	atomic_set(&ras->ras_async_inflight, 0);
 	ras_reset(ras, 0);
 	ras->ras_last_read_end_bytes = 0;
 	ras->ras_requests = 0;
@@ -1172,9 +1398,10 @@ out:
 }
 
 static void ras_detect_read_pattern(struct ll_readahead_state *ras,
-				    struct ll_sb_info *sbi,
+				    struct inode *inode,
 				    loff_t pos, size_t count, bool mmap)
 {
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
 	bool stride_detect = false;
 	pgoff_t index = pos >> PAGE_SHIFT;
 
@@ -1201,7 +1428,7 @@ static void ras_detect_read_pattern(struct ll_readahead_state *ras,
 				stride_detect = true;
 			RAS_CDEBUG(ras);
 		}
-		ll_ra_stats_inc_sbi(sbi, RA_STAT_DISTANT_READPAGE);
+		ll_ra_stats_inc(inode, RA_STAT_DISTANT_READPAGE);
 	} else if (stride_io_mode(ras)) {
 		/*
 		 * If this is contiguous read but in stride I/O mode
@@ -1274,7 +1501,7 @@ void ll_ras_enter(struct file *f, loff_t pos, size_t count)
 			GOTO(out_unlock, 0);
 		}
 	}
-	ras_detect_read_pattern(ras, sbi, pos, count, false);
+	ras_detect_read_pattern(ras, inode, pos, count, false);
 out_unlock:
 	spin_unlock(&ras->ras_lock);
 }
@@ -1315,6 +1542,8 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 {
 	struct ll_ra_info *ra = &sbi->ll_ra_info;
 	bool hit = flags & LL_RAS_HIT;
+	enum ll_ra_trace_decision decision = LL_RA_TRACE_KEEP;
+	pgoff_t trace_index = index;
 
 	ENTRY;
 	spin_lock(&ras->ras_lock);
@@ -1322,7 +1551,7 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 	if (!hit)
 		CDEBUG(D_READA|D_IOTRACE, DFID " pages at %lu miss.\n",
 		       PFID(ll_inode2fid(inode)), index);
-	ll_ra_stats_inc_sbi(sbi, hit ? RA_STAT_HIT : RA_STAT_MISS);
+	ll_ra_stats_inc(inode, hit ? RA_STAT_HIT : RA_STAT_MISS);
 
 	/*
 	 * The readahead window has been expanded to cover whole
@@ -1331,16 +1560,17 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 	 * some pages missed.
 	 */
 	if (ras->ras_no_miss_check)
-		GOTO(out_unlock, 0);
+		GOTO(out_unlock, decision = LL_RA_TRACE_WHOLE_FILE);
 
 	if (io && io->ci_rand_read)
-		GOTO(out_unlock, 0);
+		GOTO(out_unlock, decision = LL_RA_TRACE_RANDOM);
 
 	if (io && io->ci_seq_read) {
 		if (!hit) {
 			/* to avoid many small read RPC here */
 			ras->ras_window_pages = sbi->ll_ra_info.ra_range_pages;
-			ll_ra_stats_inc_sbi(sbi, RA_STAT_MMAP_RANGE_READ);
+			ll_ra_stats_inc(inode, RA_STAT_MMAP_RANGE_READ);
+			decision = LL_RA_TRACE_SEQ_RANGE;
 		}
 		goto skip;
 	}
@@ -1350,7 +1580,7 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 
 		ras_detect_cluster_range(ras, sbi, index << PAGE_SHIFT,
 					 PAGE_SIZE);
-		ras_detect_read_pattern(ras, sbi, (loff_t)index << PAGE_SHIFT,
+		ras_detect_read_pattern(ras, inode, (loff_t)index << PAGE_SHIFT,
 					PAGE_SIZE, true);
 
 		/* we did not detect anything but we could prefetch */
@@ -1366,8 +1596,9 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 				else
 					index -= ra_pages / 2;
 				ras->ras_window_pages = ra_pages;
-				ll_ra_stats_inc_sbi(sbi,
-					RA_STAT_MMAP_RANGE_READ);
+				ll_ra_stats_inc(inode,
+						RA_STAT_MMAP_RANGE_READ);
+				decision = LL_RA_TRACE_MMAP_RANGE;
 			} else {
 				ras->ras_window_pages = 0;
 			}
@@ -1379,7 +1610,7 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 	    index < ras->ras_next_readahead_idx &&
 	    pos_in_window(index, ras->ras_window_start_idx, 0,
 			  ras->ras_window_pages)) {
-		ll_ra_stats_inc_sbi(sbi, RA_STAT_MISS_IN_WINDOW);
+		ll_ra_stats_inc(inode, RA_STAT_MISS_IN_WINDOW);
 		ras->ras_need_increase_window = false;
 
 		if (index_in_stride_window(ras, index) &&
@@ -1401,6 +1632,7 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 			if (ras->ras_window_start_idx < ras->ras_stride_offset)
 				ras_stride_reset(ras);
 			RAS_CDEBUG(ras);
+			decision = LL_RA_TRACE_STRIDE_RESET;
 		} else {
 			/*
 			 * Reset both stride window and normal RA
@@ -1410,7 +1642,7 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 			/* ras->ras_consecutive_pages++; */
 			ras->ras_consecutive_bytes = 0;
 			ras_stride_reset(ras);
-			GOTO(out_unlock, 0);
+			GOTO(out_unlock, decision = LL_RA_TRACE_RESET);
 		}
 	}
 
@@ -1437,10 +1669,13 @@ skip:
 	if (ras->ras_need_increase_window) {
 		ras_increase_window(inode, ras, ra);
 		ras->ras_need_increase_window = false;
+		if (decision == LL_RA_TRACE_KEEP)
+			decision = LL_RA_TRACE_INCREASE;
 	}
 
 	EXIT;
 out_unlock:
+	ll_ra_trace_add(sbi, inode, ras, trace_index, flags, decision);
 	spin_unlock(&ras->ras_lock);
 }
 
@@ -1793,6 +2028,10 @@ int ll_io_read_page(const struct lu_env *env, struct cl_io *io,
  * 1 no async readahead, but fast read could be used.
  * 2 async readahead triggered and fast read could be used too.
  * < 0 on error.
+ *
+ * Up to ra_async_max_per_file async readahead works of @pages each may be in
+ * flight for a file, so that a single sequential reader keeps RPCs in flight
+ * to all OSTs of a widely striped file instead of waiting for each chunk.
  */
 static int kickoff_async_readahead(struct file *file, unsigned long pages)
 {
@@ -1805,6 +2044,7 @@ static int kickoff_async_readahead(struct file *file, unsigned long pages)
 	unsigned long throttle;
 	pgoff_t start_idx = ras_align(ras, ras->ras_next_readahead_idx);
 	pgoff_t end_idx = start_idx + pages - 1;
+	int kicked = 0;
 
 	/**
 	 * In case we have a limited max_cached_mb, readahead
@@ -1830,13 +2070,18 @@ static int kickoff_async_readahead(struct file *file, unsigned long pages)
 	if ((atomic_read(&ra->ra_cur_pages) + pages) > ra->ra_max_pages)
 		return 0;
 
-	if (ras->ras_async_last_readpage_idx == start_idx)
+	if (ras->ras_async_last_readpage_idx == start_idx ||
+	    atomic_read(&ras->ras_async_inflight) >= ra->ra_async_max_per_file)
 		return 1;
 
-	/* ll_readahead_work_free() free it */
-	OBD_ALLOC_PTR(lrw);
-	if (lrw) {
+	do {
+		/* ll_readahead_work_free() free it */
+		OBD_ALLOC_PTR(lrw);
+		if (!lrw)
+			return kicked ? 2 : -ENOMEM;
+
 		atomic_inc(&sbi->ll_ra_info.ra_async_inflight);
+		atomic_inc(&ras->ras_async_inflight);
 		lrw->lrw_file = get_file(file);
 		lrw->lrw_start_idx = start_idx;
 		lrw->lrw_end_idx = end_idx;
@@ -1848,9 +2093,18 @@ static int kickoff_async_readahead(struct file *file, unsigned long pages)
 		memcpy(lrw->lrw_jobid, ll_i2info(inode)->lli_jobid,
 		       sizeof(lrw->lrw_jobid));
 		ll_readahead_work_add(inode, lrw);
-	} else {
-		return -ENOMEM;
-	}
+		kicked++;
+
+		/* pipeline the next chunk only inside the readahead window */
+		start_idx = ras_align(ras, ras->ras_next_readahead_idx);
+		end_idx = start_idx + pages - 1;
+	} while (end_idx < ras->ras_window_start_idx + ras->ras_window_pages &&
+		 atomic_read(&ras->ras_async_inflight) <
+		 ra->ra_async_max_per_file &&
+		 atomic_read(&ra->ra_async_inflight) <=
+		 ra->ra_async_max_active &&
+		 atomic_read(&ra->ra_cur_pages) + pages * (kicked + 1) <=
+		 ra->ra_max_pages);
 
 	return 2;
 }
@@ -365,14 +365,19 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 	loff_t offset   = pv->ldp_file_offset;
 	int io_pages    = 0;
 	size_t page_size = cl_page_size(obj);
+	bool prealloc;
 	int i;
 	ssize_t rc = 0;
 
 	ENTRY;
 
 	cl_2queue_init(queue);
+	prealloc = cl_page_prealloc_begin(env, obj, pv->ldp_count);
 	for (i = 0; i < pv->ldp_count; i++) {
-		LASSERT(!(offset & (PAGE_SIZE - 1)));
+		/* only bounce pages may start or end inside a page */
+		size_t from = offset & (page_size - 1);
+		size_t to = min_t(size_t, page_size, from + size);
+
 		page = cl_page_find(env, obj, cl_index(obj, offset),
 				    pv->ldp_pages[i], CPT_TRANSIENT);
 		if (IS_ERR(page)) {
@@ -403,15 +408,18 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 		cl_2queue_add(queue, page, false);
 		/*
 		 * Set page clip to tell transfer formation engine
-		 * that page has to be sent even if it is beyond KMS.
+		 * that page has to be sent even if it is beyond KMS,
+		 * and which part of an unaligned page is transferred.
 		 */
-		if (size < page_size)
-			cl_page_clip(env, page, 0, size);
+		if (from != 0 || to < page_size)
+			cl_page_clip(env, page, from, to);
 		++io_pages;
 
-		offset += page_size;
-		size -= page_size;
+		offset += to - from;
+		size -= to - from;
 	}
+	if (prealloc)
+		cl_page_prealloc_end(env);
 	if (rc == 0 && io_pages > 0) {
 		int iot = rw == READ ? CRT_READ : CRT_WRITE;
 
@@ -460,6 +468,113 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 #define MAX_DIO_SIZE ((MAX_MALLOC / sizeof(struct brw_page) * PAGE_SIZE) & \
 		      ~((size_t)DT_MAX_BRW_SIZE - 1))
 
+/* Pages per bounce chunk of an unaligned O_DIRECT, one default RPC */
+#define LL_DIO_BOUNCE_PAGES	(DT_DEF_BRW_SIZE >> PAGE_SHIFT)
+
+/*
+ * Unaligned O_DIRECT cannot map user pages straight into the RPC, but it
+ * still should not go through the page cache.  Only synchronous DIO on a
+ * regular iovec is handled: the data is copied between the user buffer and
+ * pages from the sptlrpc pool laid out at the file offset, so only the first
+ * and the last page of each chunk are partial (see ll_direct_rw_pages()).
+ * Encrypted files need whole pages to encrypt, and AIO would have to copy in
+ * the completion context, so both still get -EINVAL.
+ */
+static bool ll_dio_bounce_allowed(struct kiocb *iocb, struct iov_iter *iter,
+				  struct inode *inode)
+{
+#ifdef HAVE_DIO_ITER
+	return test_bit(LL_SBI_UNALIGNED_DIO, ll_i2sbi(inode)->ll_flags) &&
+	       is_sync_kiocb(iocb) && !iov_iter_is_pipe(iter) &&
+	       !IS_ENCRYPTED(inode);
+#else
+	return false;
+#endif
+}
+
+static ssize_t ll_dio_bounce_get_pages(int rw, struct iov_iter *iter,
+				       struct ll_dio_pages *pv, size_t count)
+{
+	size_t from = pv->ldp_file_offset & ~PAGE_MASK;
+	struct page **pages;
+	int npages;
+	int rc;
+
+	count = min_t(size_t, count,
+		      ((size_t)LL_DIO_BOUNCE_PAGES << PAGE_SHIFT) - from);
+	npages = DIV_ROUND_UP(from + count, PAGE_SIZE);
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(pages, npages);
+	if (!pages)
+		return -ENOMEM;
+
+	rc = sptlrpc_enc_pool_get_pages_array(pages, npages);
+	if (rc) {
+		OBD_FREE_PTR_ARRAY_LARGE(pages, npages);
+		return rc;
+	}
+
+	if (rw == WRITE) {
+		/* the caller advances @iter once the chunk is done */
+		struct iov_iter it = *iter;
+		size_t done = 0;
+		int i;
+
+		for (i = 0; i < npages; i++) {
+			size_t bytes = min_t(size_t, PAGE_SIZE - from,
+					     count - done);
+
+			if (copy_page_from_iter(pages[i], from, bytes,
+						&it) != bytes) {
+				sptlrpc_enc_pool_put_pages_array(pages,
+								 npages);
+				OBD_FREE_PTR_ARRAY_LARGE(pages, npages);
+				return -EFAULT;
+			}
+			done += bytes;
+			from = 0;
+		}
+	}
+
+	pv->ldp_pages = pages;
+	pv->ldp_count = npages;
+
+	return count;
+}
+
+static ssize_t ll_dio_bounce_put_pages(int rw, struct iov_iter *iter,
+				       struct ll_dio_pages *pv, size_t count,
+				       ssize_t result)
+{
+	size_t from = pv->ldp_file_offset & ~PAGE_MASK;
+
+	if (rw == READ && result == 0) {
+		struct iov_iter it = *iter;
+		size_t done = 0;
+		int i;
+
+		for (i = 0; i < pv->ldp_count; i++) {
+			size_t bytes = min_t(size_t, PAGE_SIZE - from,
+					     count - done);
+
+			if (copy_page_to_iter(pv->ldp_pages[i], from, bytes,
+					      &it) != bytes) {
+				result = -EFAULT;
+				break;
+			}
+			done += bytes;
+			from = 0;
+		}
+	}
+
+	sptlrpc_enc_pool_put_pages_array(pv->ldp_pages, pv->ldp_count);
+	OBD_FREE_PTR_ARRAY_LARGE(pv->ldp_pages, pv->ldp_count);
+	pv->ldp_pages = NULL;
+	pv->ldp_count = 0;
+
+	return result;
+}
+
 static ssize_t
 ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 {
@@ -474,6 +589,7 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 	ssize_t tot_bytes = 0, result = 0;
 	loff_t file_offset = iocb->ki_pos;
 	bool sync_submit = false;
+	bool unaligned = false;
 	struct vvp_io *vio;
 	ssize_t rc2;
 
@@ -481,9 +597,15 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 	if (rw == READ && file_offset >= i_size_read(inode))
 		return 0;
 
-	/* FIXME: io smaller than PAGE_SIZE is broken on ia64 ??? */
-	if (file_offset & ~PAGE_MASK)
-		RETURN(-EINVAL);
+	/* Check that the file offset and all user buffers are aligned,
+	 * otherwise the data has to be bounced
+	 */
+	if ((file_offset & ~PAGE_MASK) ||
+	    (ll_iov_iter_alignment(iter) & ~PAGE_MASK)) {
+		if (!ll_dio_bounce_allowed(iocb, iter, inode))
+			RETURN(-EINVAL);
+		unaligned = true;
+	}
 
 	CDEBUG(D_VFSTRACE, "VFS Op:inode="DFID"(%p), size=%zd (max %lu), "
 	       "offset=%lld=%llx, pages %zd (max %lu)\n",
@@ -491,10 +613,6 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 	       file_offset, file_offset, count >> PAGE_SHIFT,
 	       MAX_DIO_SIZE >> PAGE_SHIFT);
 
-	/* Check that all user buffers are aligned as well */
-	if (ll_iov_iter_alignment(iter) & ~PAGE_MASK)
-		RETURN(-EINVAL);
-
 	lcc = ll_cl_find(inode);
 	if (lcc == NULL)
 		RETURN(-EIO);
@@ -521,6 +639,9 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 	 */
 	if (io->ci_dio_lock || (is_sync_kiocb(iocb) && !io->ci_parallel_dio))
 		sync_submit = true;
+	/* bounce pages are copied out and released by this thread */
+	if (unaligned)
+		sync_submit = true;
 
 	while (iov_iter_count(iter)) {
 		struct ll_dio_pages *pvec;
@@ -544,9 +665,16 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 			GOTO(out, result = -ENOMEM);
 
 		pvec = &ldp_aio->csd_dio_pages;
+		pvec->ldp_file_offset = file_offset;
 
-		result = ll_get_user_pages(rw, iter, &pages,
-					   &pvec->ldp_count, count);
+		if (unaligned) {
+			ldp_aio->csd_bounce = 1;
+			result = ll_dio_bounce_get_pages(rw, iter, pvec, count);
+			pages = pvec->ldp_pages;
+		} else {
+			result = ll_get_user_pages(rw, iter, &pages,
+						   &pvec->ldp_count, count);
+		}
 		if (unlikely(result <= 0)) {
 			cl_sync_io_note(env, &ldp_aio->csd_sync, result);
 			if (sync_submit) {
@@ -557,7 +685,6 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 		}
 
 		count = result;
-		pvec->ldp_file_offset = file_offset;
 		pvec->ldp_pages = pages;
 
 		result = ll_direct_rw_pages(env, io, count,
@@ -572,6 +699,9 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 					     0);
 			if (result == 0 && rc2)
 				result = rc2;
+			if (unaligned)
+				result = ll_dio_bounce_put_pages(rw, iter, pvec,
+								 count, result);
 			LASSERT(ldp_aio->csd_creator_free);
 			cl_sub_dio_free(ldp_aio);
 		}
@@ -36,6 +36,7 @@
 #include <linux/highmem.h>
 #include <linux/pagemap.h>
 #include <linux/delay.h>
+#include <linux/ctype.h>
 
 #define DEBUG_SUBSYSTEM S_LLITE
 
@@ -153,6 +154,19 @@ static inline int sa_has_callback(struct ll_statahead_info *sai)
 	return !list_empty(&sai->sai_interim_entries);
 }
 
+/*
+ * async stat replies should be instantiated now: enough requests were sent
+ * since the last batch was handled, the statahead window is full, or the
+ * scanner is waiting for an entry which may be among the pending replies.
+ */
+static inline bool sa_batch_ready(struct ll_statahead_info *sai)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(sai->sai_dentry->d_inode);
+
+	return sai->sai_batch_sent >= sbi->ll_sa_batch_max ||
+	       sa_sent_full(sai) || waitqueue_active(&sai->sai_waitq);
+}
+
 static inline int agl_list_empty(struct ll_statahead_info *sai)
 {
 	return list_empty(&sai->sai_agls);
@@ -574,6 +588,18 @@ static void ll_agl_trigger(struct inode *inode, struct ll_statahead_info *sai)
 		RETURN_EXIT;
 	}
 
+	if (sai->sai_xattr) {
+		rc = ll_xattr_cache_prefetch(inode);
+		CDEBUG(D_READA, "prefetch xattrs: inode = "DFID", rc = %d\n",
+		       PFID(&lli->lli_fid), rc);
+	}
+
+	if (!sai->sai_agl_glimpse) {
+		lli->lli_agl_index = 0;
+		iput(inode);
+		RETURN_EXIT;
+	}
+
 	/*
 	 * In case of restore, the MDT has the right size and has already
 	 * sent it back without granting the layout lock, inode is up-to-date.
@@ -663,8 +689,17 @@ static void sa_instantiate(struct ll_statahead_info *sai,
 		GOTO(out, rc = -EFAULT);
 
 	child = entry->se_inode;
-	/* revalidate; unlinked and re-created with the same name */
-	if (unlikely(!lu_fid_eq(&minfo->mi_data.op_fid2, &body->mbo_fid1))) {
+	if (fid_is_zero(&minfo->mi_data.op_fid2)) {
+		/*
+		 * statahead by file name pattern doesn't know the FID before
+		 * the reply, remote object needs another RPC to getattr from
+		 * the MDT holding it, skip such entry.
+		 */
+		if (body->mbo_valid & OBD_MD_MDS)
+			GOTO(out, rc = -EAGAIN);
+	} else if (unlikely(!lu_fid_eq(&minfo->mi_data.op_fid2,
+				       &body->mbo_fid1))) {
+		/* revalidate; unlinked and re-created with the same name */
 		if (child) {
 			entry->se_inode = NULL;
 			iput(child);
@@ -727,26 +762,28 @@ out:
 	sa_make_ready(sai, entry, rc);
 }
 
-/* once there are async stat replies, instantiate sa_entry from replies */
+/*
+ * once there are async stat replies, instantiate sa_entry from replies, all
+ * replies received so far are taken off sai_interim_entries in one batch so
+ * that lli_sa_lock is not bounced with ptlrpcd for every entry.
+ */
 static void sa_handle_callback(struct ll_statahead_info *sai)
 {
 	struct ll_inode_info *lli;
+	struct sa_entry *entry;
+	struct sa_entry *next;
+	LIST_HEAD(batch);
 
 	lli = ll_i2info(sai->sai_dentry->d_inode);
 
 	spin_lock(&lli->lli_sa_lock);
-	while (sa_has_callback(sai)) {
-		struct sa_entry *entry;
+	list_splice_init(&sai->sai_interim_entries, &batch);
+	spin_unlock(&lli->lli_sa_lock);
 
-		entry = list_entry(sai->sai_interim_entries.next,
-				   struct sa_entry, se_list);
+	list_for_each_entry_safe(entry, next, &batch, se_list) {
 		list_del_init(&entry->se_list);
-		spin_unlock(&lli->lli_sa_lock);
-
 		sa_instantiate(sai, entry);
-		spin_lock(&lli->lli_sa_lock);
 	}
-	spin_unlock(&lli->lli_sa_lock);
 }
 
 /*
@@ -795,6 +832,13 @@ static int ll_statahead_interpret(struct ptlrpc_request *req,
 	}
 
 	spin_lock(&lli->lli_sa_lock);
+	if (sai->sai_fname) {
+		if (rc == -ENOENT)
+			sai->sai_fname_enoent++;
+		else if (rc == 0)
+			sai->sai_fname_enoent = 0;
+	}
+
 	if (rc != 0) {
 		if (__sa_make_ready(sai, entry, rc))
 			wake_up(&sai->sai_waitq);
@@ -920,10 +964,12 @@ static void sa_statahead(struct dentry *parent, const char *name, int len,
 	if (dentry)
 		dput(dentry);
 
-	if (rc != 0)
+	if (rc != 0) {
 		sa_make_ready(sai, entry, rc);
-	else
+	} else {
 		sai->sai_sent++;
+		sai->sai_batch_sent++;
+	}
 
 	sai->sai_index++;
 
@@ -1032,6 +1078,113 @@ static void ll_start_agl(struct dentry *parent, struct ll_statahead_info *sai)
 	EXIT;
 }
 
+/* scanner hasn't accessed statahead cache since last check */
+static bool sa_fname_idle(struct ll_statahead_info *sai, __u64 *accessed)
+{
+	__u64 count = sai->sai_hit + sai->sai_miss;
+	bool idle = (count == *accessed);
+
+	*accessed = count;
+	return idle;
+}
+
+/*
+ * statahead by file name pattern: there is no opened directory to read, names
+ * are built from the common prefix and increasing numeric suffix of the names
+ * the scanner stat'ed. Stop on consecutive negative lookups or low hit ratio,
+ * and quit once the scanner stays idle for LL_SA_FNAME_IDLE, since no file
+ * release will tell this thread to quit.
+ */
+static int ll_statahead_by_fname(struct dentry *parent,
+				 struct ll_statahead_info *sai)
+{
+	struct inode *dir = parent->d_inode;
+	struct ll_inode_info *lli = ll_i2info(dir);
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	struct lu_fid fid = { 0 };
+	char name[NAME_MAX + 1];
+	__u64 accessed = 0;
+	bool idle = false;
+	int rc = 0;
+
+	ENTRY;
+
+	CDEBUG(D_READA, "%s: statahead by fname %.*s%0*llu in "DFID"\n",
+	       sbi->ll_fsname, sai->sai_fname_prefix_len,
+	       sai->sai_fname_prefix, sai->sai_fname_width,
+	       sai->sai_fname_index, PFID(&lli->lli_fid));
+
+	/* matches smp_store_release() in ll_deauthorize_statahead() */
+	while (!idle && smp_load_acquire(&sai->sai_task) && !sa_low_hit(sai) &&
+	       sai->sai_fname_enoent < LL_SA_FNAME_ENOENT_MAX) {
+		int namelen;
+
+		while (({set_current_state(TASK_IDLE);
+			 smp_load_acquire(&sai->sai_task); })) {
+			if (sa_has_callback(sai) && sa_batch_ready(sai)) {
+				__set_current_state(TASK_RUNNING);
+				sai->sai_batch_sent = 0;
+				sa_handle_callback(sai);
+			}
+
+			if (!sa_sent_full(sai))
+				break;
+
+			if (!schedule_timeout(LL_SA_FNAME_IDLE) &&
+			    sa_fname_idle(sai, &accessed)) {
+				idle = true;
+				break;
+			}
+		}
+		__set_current_state(TASK_RUNNING);
+
+		if (idle || !smp_load_acquire(&sai->sai_task))
+			break;
+
+		namelen = snprintf(name, sizeof(name), "%.*s%0*llu",
+				   sai->sai_fname_prefix_len,
+				   sai->sai_fname_prefix, sai->sai_fname_width,
+				   sai->sai_fname_index);
+		if (namelen >= sizeof(name) || namelen > sbi->ll_namelen)
+			break;
+
+		sa_statahead(parent, name, namelen, &fid);
+		sai->sai_fname_index++;
+	}
+
+	if (sa_low_hit(sai)) {
+		rc = -EFAULT;
+		atomic_inc(&sbi->ll_sa_wrong);
+		CDEBUG(D_READA,
+		       "Statahead by fname for dir "DFID" hit ratio too low: hit/miss %llu/%llu, sent/replied %llu/%llu\n",
+		       PFID(&lli->lli_fid), sai->sai_hit, sai->sai_miss,
+		       sai->sai_sent, sai->sai_replied);
+	}
+
+	/* keep statahead entries cached until the scanner is done with them */
+	while (!idle && ({set_current_state(TASK_IDLE);
+			  smp_load_acquire(&sai->sai_task); })) {
+		if (sa_has_callback(sai)) {
+			__set_current_state(TASK_RUNNING);
+			sa_handle_callback(sai);
+		} else if (!schedule_timeout(LL_SA_FNAME_IDLE) &&
+			   sa_fname_idle(sai, &accessed)) {
+			break;
+		}
+	}
+	__set_current_state(TASK_RUNNING);
+
+	/* nobody opened this dir for statahead, release it for others */
+	spin_lock(&lli->lli_sa_lock);
+	if (!lli->lli_opendir_key) {
+		lli->lli_opendir_pid = 0;
+		lli->lli_sa_enabled = 0;
+	}
+	spin_unlock(&lli->lli_sa_lock);
+
+	RETURN(rc);
+}
+
 /* statahead thread main function */
 static int ll_statahead_thread(void *arg)
 {
@@ -1051,6 +1204,11 @@ static int ll_statahead_thread(void *arg)
 	CDEBUG(D_READA, "statahead thread starting: sai %p, parent %pd\n",
 	       sai, parent);
 
+	if (sai->sai_fname) {
+		rc = ll_statahead_by_fname(parent, sai);
+		GOTO(out, rc);
+	}
+
 	OBD_ALLOC_PTR(op_data);
 	if (!op_data)
 		GOTO(out, rc = -ENOMEM);
@@ -1139,8 +1297,10 @@ static int ll_statahead_thread(void *arg)
 				 /* matches smp_store_release() in
 				  * ll_deauthorize_statahead() */
 				 smp_load_acquire(&sai->sai_task); })) {
-				if (sa_has_callback(sai)) {
+				if (sa_has_callback(sai) &&
+				    sa_batch_ready(sai)) {
 					__set_current_state(TASK_RUNNING);
+					sai->sai_batch_sent = 0;
 					sa_handle_callback(sai);
 				}
 
@@ -1618,13 +1778,46 @@ out:
 	RETURN(rc);
 }
 
+/*
+ * split @name into a prefix and a decimal numeric suffix, return false if
+ * @name doesn't end with digits.
+ */
+static bool sa_fname_parse(const struct qstr *name, int *prefix_len,
+			   __u64 *index, int *width)
+{
+	const unsigned char *p = name->name;
+	int len = name->len;
+	__u64 val = 0;
+	int i;
+
+	for (i = len; i > 0 && isdigit(p[i - 1]); i--)
+		;
+
+	/* no numeric suffix, or it may overflow */
+	if (i == len || len - i > 18)
+		return false;
+
+	*prefix_len = i;
+	for (; i < len; i++)
+		val = val * 10 + (p[i] - '0');
+	*index = val;
+	/* "file0001" keeps the suffix width, "file1" is not zero-padded */
+	*width = (p[*prefix_len] == '0' && len - *prefix_len > 1) ?
+		 len - *prefix_len : 0;
+
+	return true;
+}
+
 /**
  * start statahead thread
  *
  * \param[in] dir	parent directory
  * \param[in] dentry	dentry that triggers statahead, normally the first
- *			dirent under @dir
+ *			dirent under @dir, or the last name of a file name
+ *			pattern for \a fname
  * \param[in] agl	indicate whether AGL is needed
+ * \param[in] fname	statahead names following the file name pattern of
+ *			\a dentry instead of reading @dir
  * \retval		-EAGAIN on success, because when this function is
  *			called, it's already in lookup call, so client should
  *			do it itself instead of waiting for statahead thread
@@ -1632,7 +1825,7 @@ out:
  * \retval		negative number upon error
  */
 static int start_statahead_thread(struct inode *dir, struct dentry *dentry,
-				  bool agl)
+				  bool agl, bool fname)
 {
 	int node = cfs_cpt_spread_node(cfs_cpt_tab, CFS_CPT_ANY);
 	struct ll_inode_info *lli = ll_i2info(dir);
@@ -1646,7 +1839,8 @@ static int start_statahead_thread(struct inode *dir, struct dentry *dentry,
 	ENTRY;
 
 	/* I am the "lli_opendir_pid" owner, only me can set "lli_sai". */
-	first = is_first_dirent(dir, dentry);
+	if (!fname)
+		first = is_first_dirent(dir, dentry);
 	if (first == LS_NOT_FIRST_DE)
 		/* It is not "ls -{a}l" operation, no need statahead for it. */
 		GOTO(out, rc = -EFAULT);
@@ -1664,14 +1858,37 @@ static int start_statahead_thread(struct inode *dir, struct dentry *dentry,
 
 	sai->sai_ls_all = (first == LS_FIRST_DOT_DE);
 
+	if (fname) {
+		if (!sa_fname_parse(&dentry->d_name, &sai->sai_fname_prefix_len,
+				    &sai->sai_fname_index,
+				    &sai->sai_fname_width))
+			GOTO(out, rc = -EINVAL);
+
+		memcpy(sai->sai_fname_prefix, dentry->d_name.name,
+		       sai->sai_fname_prefix_len);
+		sai->sai_fname_index++;
+		sai->sai_fname = 1;
+		sai->sai_ls_all = 1;
+	}
+
 	/*
 	 * if current lli_opendir_key was deauthorized, or dir re-opened by
 	 * another process, don't start statahead, otherwise the newly spawned
-	 * statahead thread won't be notified to quit.
+	 * statahead thread won't be notified to quit. Statahead by file name
+	 * pattern is only started on a directory which is not opened, and the
+	 * current process becomes "lli_opendir_pid" owner until it quits.
 	 */
 	spin_lock(&lli->lli_sa_lock);
-	if (unlikely(lli->lli_sai || !lli->lli_opendir_key ||
-		     lli->lli_opendir_pid != current->pid)) {
+	if (fname) {
+		if (unlikely(lli->lli_sai || lli->lli_opendir_key ||
+			     lli->lli_opendir_pid)) {
+			spin_unlock(&lli->lli_sa_lock);
+			GOTO(out, rc = -EPERM);
+		}
+		lli->lli_opendir_pid = current->pid;
+		lli->lli_sa_enabled = 1;
+	} else if (unlikely(lli->lli_sai || !lli->lli_opendir_key ||
+			    lli->lli_opendir_pid != current->pid)) {
 		spin_unlock(&lli->lli_sa_lock);
 		GOTO(out, rc = -EPERM);
 	}
@@ -1686,16 +1903,25 @@ static int start_statahead_thread(struct inode *dir, struct dentry *dentry,
 	if (IS_ERR(task)) {
 		spin_lock(&lli->lli_sa_lock);
 		lli->lli_sai = NULL;
+		if (fname)
+			lli->lli_opendir_pid = 0;
 		spin_unlock(&lli->lli_sa_lock);
 		rc = PTR_ERR(task);
 		CERROR("can't start ll_sa thread, rc: %d\n", rc);
 		GOTO(out, rc);
 	}
 
-	if (test_bit(LL_SBI_AGL_ENABLED, sbi->ll_flags) && agl)
+	/* AGL thread also fills the xattr cache of the entries */
+	sai->sai_agl_glimpse = test_bit(LL_SBI_AGL_ENABLED, sbi->ll_flags) &&
+			       agl;
+	sai->sai_xattr = test_bit(LL_SBI_STATAHEAD_XATTR, sbi->ll_flags) &&
+			 sbi->ll_xattr_cache_enabled;
+	if (sai->sai_agl_glimpse || sai->sai_xattr)
 		ll_start_agl(parent, sai);
 
 	atomic_inc(&sbi->ll_sa_total);
+	if (fname)
+		atomic_inc(&sbi->ll_sa_fname_total);
 	sai->sai_task = task;
 
 	wake_up_process(task);
@@ -1733,11 +1959,11 @@ static inline bool ll_statahead_started(struct inode *dir, bool agl)
 
 	spin_lock(&lli->lli_sa_lock);
 	sai = lli->lli_sai;
-	if (sai && (sai->sai_agl_task != NULL) != agl)
+	if (sai && sai->sai_agl_glimpse != agl)
 		CDEBUG(D_READA,
 		       "%s: Statahead AGL hint changed from %d to %d\n",
 		       ll_i2sbi(dir)->ll_fsname,
-		       sai->sai_agl_task != NULL, agl);
+		       sai->sai_agl_glimpse, agl);
 	spin_unlock(&lli->lli_sa_lock);
 
 	return !!sai;
@@ -1761,10 +1987,67 @@ static inline bool ll_statahead_started(struct inode *dir, bool agl)
 int ll_start_statahead(struct inode *dir, struct dentry *dentry, bool agl)
 {
 	if (!ll_statahead_started(dir, agl))
-		return start_statahead_thread(dir, dentry, agl);
+		return start_statahead_thread(dir, dentry, agl, false);
 	return 0;
 }
 
+/**
+ * detect file name pattern in stat() calls on names of a directory which is
+ * not opened for readdir, e.g. file000001, file000002, ..., and start statahead
+ * thread to stat the following names if LL_SA_FNAME_MIN consecutive names were
+ * stat'ed by the same process.
+ *
+ * \param[in] dir	parent directory
+ * \param[in] dentry	dentry to getattr
+ * \param[in] agl	whether start the agl thread
+ */
+void ll_statahead_fname_check(struct inode *dir, struct dentry *dentry,
+			      bool agl)
+{
+	struct ll_inode_info *lli = ll_i2info(dir);
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	unsigned int hash;
+	bool start = false;
+	__u64 index;
+	int prefix_len;
+	int width;
+
+	if (sbi->ll_sa_max == 0 ||
+	    !test_bit(LL_SBI_STATAHEAD_FNAME, sbi->ll_flags))
+		return;
+
+	/* opened dir is handled by readdir statahead */
+	if (lli->lli_opendir_key || lli->lli_sai)
+		return;
+
+	if (!sa_fname_parse(&dentry->d_name, &prefix_len, &index, &width))
+		return;
+
+	hash = ll_full_name_hash(dentry->d_parent, dentry->d_name.name,
+				 prefix_len);
+
+	spin_lock(&lli->lli_sa_lock);
+	if (lli->lli_sa_fname_pid == current->pid &&
+	    lli->lli_sa_fname_hash == hash &&
+	    lli->lli_sa_fname_prefix_len == prefix_len &&
+	    lli->lli_sa_fname_index + 1 == index) {
+		if (++lli->lli_sa_fname_hits >= LL_SA_FNAME_MIN) {
+			lli->lli_sa_fname_hits = 0;
+			start = true;
+		}
+	} else {
+		lli->lli_sa_fname_pid = current->pid;
+		lli->lli_sa_fname_hash = hash;
+		lli->lli_sa_fname_prefix_len = prefix_len;
+		lli->lli_sa_fname_hits = 1;
+	}
+	lli->lli_sa_fname_index = index;
+	spin_unlock(&lli->lli_sa_lock);
+
+	if (start)
+		start_statahead_thread(dir, dentry, agl, true);
+}
+
 /**
  * revalidate dentry from statahead cache.
  *
@@ -642,6 +642,40 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Fill the xattr cache of @inode ahead of its first getxattr.
+ *
+ * Called by the statahead AGL thread for the entries of a directory being
+ * scanned, so that "ls --color", "lfs getstripe" and security checks find
+ * the xattrs cached instead of sending one getxattr RPC per file.
+ *
+ * \retval 0       the cache is filled, or was already
+ * \retval < 0     from ll_xattr_cache_refill()
+ */
+int ll_xattr_cache_prefetch(struct inode *inode)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	bool filled;
+	int rc;
+
+	ENTRY;
+
+	down_read(&lli->lli_xattrs_list_rwsem);
+	filled = ll_xattr_cache_filled(lli);
+	up_read(&lli->lli_xattrs_list_rwsem);
+	if (filled)
+		RETURN(0);
+
+	rc = ll_xattr_cache_refill(inode);
+	if (rc)
+		RETURN(rc);
+
+	up_write(&lli->lli_xattrs_list_rwsem);
+	atomic_inc(&ll_i2sbi(inode)->ll_sa_xattr_total);
+
+	RETURN(0);
+}
+
 /**
  * Insert an xattr value into the cache.
  *
@@ -3761,13 +3761,20 @@ static int lmv_intent_getattr_async(struct obd_export *exp,
 
 	ENTRY;
 
-	if (!fid_is_sane(&op_data->op_fid2))
-		RETURN(-EINVAL);
-
 	ptgt = lmv_locate_tgt(lmv, op_data);
 	if (IS_ERR(ptgt))
 		RETURN(PTR_ERR(ptgt));
 
+	/*
+	 * statahead by file name pattern doesn't know child FID, lookup by
+	 * name on the parent MDT, and the caller will skip remote object.
+	 */
+	if (fid_is_zero(&op_data->op_fid2))
+		RETURN(md_intent_getattr_async(ptgt->ltd_exp, minfo));
+
+	if (!fid_is_sane(&op_data->op_fid2))
+		RETURN(-EINVAL);
+
 	ctgt = lmv_fid2tgt(lmv, &op_data->op_fid2);
 	if (IS_ERR(ctgt))
 		RETURN(PTR_ERR(ctgt));
@@ -625,6 +625,74 @@ const struct lsm_operations *lsm_op_find(int magic)
 	}
 }
 
+/**
+ * Check whether the packed layout in @buf is the same version as @lsm.
+ *
+ * This applies the same test as lov_conf_set() does to an unpacked layout
+ * (layout generation, flags and pattern of the first component), but reads
+ * them from the LOV EA directly, so that a layout handed back unchanged with
+ * a re-enqueued layout lock doesn't need to be unpacked first.
+ *
+ * \retval true	@buf is the layout @lsm was unpacked from
+ * \retval false	@buf is a different layout, or not a plain or
+ *			composite one
+ */
+bool lsm_is_same_layout(const struct lov_stripe_md *lsm, void *buf,
+			size_t buf_size)
+{
+	struct lov_mds_md *lmm = buf;
+	u32 layout_gen;
+	u32 pattern;
+	u16 flags = 0;
+	u32 magic;
+
+	if (buf_size < sizeof(magic))
+		return false;
+
+	magic = le32_to_cpu(*(u32 *)buf);
+	if (magic != lsm->lsm_magic)
+		return false;
+
+	switch (magic) {
+	case LOV_MAGIC_V1:
+	case LOV_MAGIC_V3:
+		if (buf_size < sizeof(*lmm))
+			return false;
+		layout_gen = le16_to_cpu(lmm->lmm_layout_gen);
+		break;
+	case LOV_MAGIC_COMP_V1: {
+		struct lov_comp_md_v1 *lcm = buf;
+		size_t offset;
+
+		if (buf_size < offsetof(typeof(*lcm), lcm_entries[1]) ||
+		    le16_to_cpu(lcm->lcm_entry_count) != lsm->lsm_entry_count)
+			return false;
+
+		layout_gen = le32_to_cpu(lcm->lcm_layout_gen);
+		flags = le16_to_cpu(lcm->lcm_flags);
+		offset = le32_to_cpu(lcm->lcm_entries[0].lcme_offset);
+		if (offset > buf_size - sizeof(magic))
+			return false;
+
+		lmm = buf + offset;
+		if (le32_to_cpu(lmm->lmm_magic) == LOV_MAGIC_FOREIGN) {
+			pattern = LOV_PATTERN_FOREIGN;
+			goto check;
+		}
+		if (offset > buf_size - sizeof(*lmm))
+			return false;
+		break;
+	}
+	default:
+		return false;
+	}
+	pattern = le32_to_cpu(lmm->lmm_pattern);
+check:
+	return lsm->lsm_layout_gen == layout_gen &&
+	       lsm->lsm_flags == flags &&
+	       lsm->lsm_entries[0]->lsme_pattern == pattern;
+}
+
 void dump_lsm(unsigned int level, const struct lov_stripe_md *lsm)
 {
 	int i, j;
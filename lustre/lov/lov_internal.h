@@ -185,6 +185,8 @@ struct lsm_operations {
 
 const struct lsm_operations *lsm_op_find(int magic);
 void lsm_free(struct lov_stripe_md *lsm);
+bool lsm_is_same_layout(const struct lov_stripe_md *lsm, void *buf,
+			size_t buf_size);
 
 /* lov_do_div64(a, b) returns a % b, and a = a / b.
  * The 32-bit code is LOV-specific due to knowing about stripe limits in
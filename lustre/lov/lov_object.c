@@ -1355,6 +1355,32 @@ out_lsm:
 	RETURN(rc);
 }
 
+/*
+ * A layout lock dropped from the LRU, which happens all the time to clients
+ * touching many files, hands back the same layout on the next enqueue.  Check
+ * its version in the packed buffer so that an unchanged layout is revalidated
+ * without being unpacked again, only to be compared with lo_lsm and freed.
+ */
+static bool lov_layout_unchanged(struct lov_object *lov,
+				 const struct cl_object_conf *conf)
+{
+	bool same;
+
+	lov_conf_lock(lov);
+	same = lov->lo_lsm != NULL &&
+	       lsm_is_same_layout(lov->lo_lsm, conf->u.coc_layout.lb_buf,
+				  conf->u.coc_layout.lb_len);
+	if (same) {
+		clear_bit(LO_LAYOUT_INVALID, &lov->lo_obj_flags);
+		CDEBUG(D_INODE, DFID" layout gen %u unchanged\n",
+		       PFID(lu_object_fid(lov2lu(lov))),
+		       lov->lo_lsm->lsm_layout_gen);
+	}
+	lov_conf_unlock(lov);
+
+	return same;
+}
+
 static int lov_conf_set(const struct lu_env *env, struct cl_object *obj,
                         const struct cl_object_conf *conf)
 {
@@ -1365,6 +1391,9 @@ static int lov_conf_set(const struct lu_env *env, struct cl_object *obj,
 
 	if (conf->coc_opc == OBJECT_CONF_SET &&
 	    conf->u.coc_layout.lb_buf != NULL) {
+		if (lov_layout_unchanged(lov, conf))
+			RETURN(0);
+
 		lsm = lov_unpackmd(lov_object_dev(lov)->ld_lov,
 				   conf->u.coc_layout.lb_buf,
 				   conf->u.coc_layout.lb_len);
@@ -2175,6 +2204,7 @@ static int lov_object_layout_get(const struct lu_env *env,
 	if (lsm == NULL) {
 		cl->cl_size = 0;
 		cl->cl_layout_gen = CL_LAYOUT_GEN_EMPTY;
+		cl->cl_dom_comp_size = 0;
 
 		RETURN(0);
 	}
@@ -2183,6 +2213,12 @@ static int lov_object_layout_get(const struct lu_env *env,
 	cl->cl_layout_gen = lsm->lsm_layout_gen;
 	cl->cl_is_released = lsm->lsm_is_released;
 	cl->cl_is_composite = lsm_is_composite(lsm->lsm_magic);
+	if (cl->cl_is_composite && lsm->lsm_entry_count > 0 &&
+	    lsme_is_dom(lsm->lsm_entries[0]))
+		cl->cl_dom_comp_size =
+			lsm->lsm_entries[0]->lsme_extent.e_end;
+	else
+		cl->cl_dom_comp_size = 0;
 
 	rc = lov_lsm_pack(lsm, buf->lb_buf, buf->lb_len);
 	lov_lsm_put(lsm);
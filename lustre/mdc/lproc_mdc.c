@@ -289,6 +289,36 @@ static ssize_t checksums_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(checksums);
 
+static ssize_t readdir_prefetch_show(struct kobject *kobj,
+				     struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n",
+			 !!obd->u.cli.cl_readdir_prefetch);
+}
+
+static ssize_t readdir_prefetch_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer,
+				      size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	obd->u.cli.cl_readdir_prefetch = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(readdir_prefetch);
+
 static ssize_t checksum_dump_show(struct kobject *kobj,
 				  struct attribute *attr, char *buf)
 {
@@ -399,6 +429,33 @@ static int mdc_unstable_stats_seq_show(struct seq_file *m, void *v)
 }
 LPROC_SEQ_FOPS_RO(mdc_unstable_stats);
 
+static int mdc_readdir_prefetch_stats_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+	struct client_obd *cli = &obd->u.cli;
+
+	seq_printf(m, "prefetch_pages: %d\n"
+		   "prefetch_hits: %d\n",
+		   atomic_read(&cli->cl_readdir_prefetch_pages),
+		   atomic_read(&cli->cl_readdir_prefetch_hits));
+	return 0;
+}
+
+static ssize_t mdc_readdir_prefetch_stats_seq_write(struct file *file,
+						    const char __user *buf,
+						    size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+	struct obd_device *obd = seq->private;
+	struct client_obd *cli = &obd->u.cli;
+
+	atomic_set(&cli->cl_readdir_prefetch_pages, 0);
+	atomic_set(&cli->cl_readdir_prefetch_hits, 0);
+
+	return len;
+}
+LPROC_SEQ_FOPS(mdc_readdir_prefetch_stats);
+
 static ssize_t mdc_rpc_stats_seq_write(struct file *file,
 				       const char __user *buf,
 				       size_t len, loff_t *off)
@@ -634,6 +691,8 @@ struct lprocfs_vars lprocfs_mdc_obd_vars[] = {
 	  .fops	=	&mdc_rpc_stats_fops		},
 	{ .name	=	"unstable_stats",
 	  .fops	=	&mdc_unstable_stats_fops	},
+	{ .name	=	"readdir_prefetch_stats",
+	  .fops	=	&mdc_readdir_prefetch_stats_fops },
 	{ .name	=	"mdc_stats",
 	  .fops	=	&mdc_stats_fops			},
 	{ .name	=	"mdc_dom_min_repsize",
@@ -756,6 +815,7 @@ static struct attribute *mdc_attrs[] = {
 	&lustre_attr_ping.attr,
 	&lustre_attr_grant_shrink.attr,
 	&lustre_attr_grant_shrink_interval.attr,
+	&lustre_attr_readdir_prefetch.attr,
 	&lustre_attr_cur_lost_grant_bytes.attr,
 	&lustre_attr_cur_dirty_grant_bytes.attr,
 	NULL,
@@ -265,7 +265,7 @@ mdc_intent_open_pack(struct obd_export *exp, struct lookup_intent *it,
 	LIST_HEAD(cancels);
 	int count = 0;
 	enum ldlm_mode mode;
-	int repsize, repsize_estimate;
+	int repsize, repsize_estimate, inline_size;
 	int rc;
 
 	ENTRY;
@@ -416,9 +416,18 @@ mdc_intent_open_pack(struct obd_export *exp, struct lookup_intent *it,
 			   sizeof(struct lov_comp_md_entry_v1) +
 			   lov_mds_md_size(0, LOV_MAGIC_V3));
 
-	if (repsize_estimate < obd->u.cli.cl_dom_min_inline_repsize) {
-		repsize = obd->u.cli.cl_dom_min_inline_repsize -
-			  repsize_estimate + sizeof(struct niobuf_remote);
+	/* Make room for the whole file if the caller knows it is small
+	 * enough, so that it can be read without any READ RPC. Setting
+	 * dom_min_inline_repsize to 0 disables this as well.
+	 */
+	inline_size = obd->u.cli.cl_dom_min_inline_repsize;
+	if (inline_size > 0 &&
+	    op_data->op_inline_size <= MDC_DOM_MAX_INLINE_REPSIZE)
+		inline_size = max_t(int, inline_size, op_data->op_inline_size);
+
+	if (repsize_estimate < inline_size) {
+		repsize = inline_size - repsize_estimate +
+			  sizeof(struct niobuf_remote);
 		req_capsule_set_size(&req->rq_pill, &RMF_NIOBUF_INLINE,
 				     RCL_SERVER,
 				     sizeof(struct niobuf_remote) + repsize);
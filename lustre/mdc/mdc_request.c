@@ -1449,6 +1449,127 @@ static inline int mdc_read_folio_remote(struct file *file, struct folio *folio)
 #define mdc_read_folio_remote	ll_mdc_read_page_remote
 #endif
 
+/*
+ * Directory pages are prefetched one READPAGE RPC ahead of readdir, so that
+ * a large directory walk does not wait for every RPC in turn. The first page
+ * of each prefetched batch is marked PG_readahead; when readdir gets there,
+ * the next batch is prefetched.
+ */
+static struct workqueue_struct *mdc_readdir_wq;
+
+struct mdc_readdir_work {
+	struct work_struct	 mrw_work;
+	struct obd_export	*mrw_exp;
+	struct md_op_data	 mrw_op_data;
+	struct lustre_handle	 mrw_lockh;
+	enum ldlm_mode		 mrw_lock_mode;
+	__u64			 mrw_hash;
+};
+
+static void mdc_readdir_prefetch_work(struct work_struct *work)
+{
+	struct mdc_readdir_work *mrw = container_of(work,
+						    struct mdc_readdir_work,
+						    mrw_work);
+	struct md_op_data *op_data = &mrw->mrw_op_data;
+	struct client_obd *cli = &mrw->mrw_exp->exp_obd->u.cli;
+	struct inode *dir = op_data->op_data;
+	struct readpage_param rp_param;
+	struct page *page;
+	__u64 start;
+	__u64 end;
+	int i;
+
+	rp_param.rp_off = mrw->mrw_hash;
+	rp_param.rp_hash64 = op_data->op_cli_flags & CLI_HASH64;
+	rp_param.rp_exp = mrw->mrw_exp;
+	rp_param.rp_mod = op_data;
+
+	/* step over the pages readdir has not got to yet */
+	for (i = 0; ; i++) {
+		/* already a whole batch ahead */
+		if (i >= cli->cl_max_pages_per_rpc)
+			GOTO(out, 0);
+
+		page = mdc_page_locate(dir->i_mapping, &rp_param.rp_off,
+				       &start, &end, rp_param.rp_hash64);
+		if (IS_ERR(page))
+			GOTO(out, 0);
+		if (page == NULL)
+			break;
+
+		kunmap(page);
+		mdc_release_page(page, 0);
+		if (end == MDS_DIR_END_OFF)
+			GOTO(out, 0);
+		rp_param.rp_off = end;
+	}
+
+	page = ll_read_cache_page(dir->i_mapping,
+				  hash_x_index(rp_param.rp_off,
+					       rp_param.rp_hash64),
+				  mdc_read_folio_remote, &rp_param);
+	if (IS_ERR(page)) {
+		CDEBUG(D_INFO, "%s: prefetch dir page "DFID" at %llu: %ld\n",
+		       mrw->mrw_exp->exp_obd->obd_name,
+		       PFID(&op_data->op_fid1), rp_param.rp_off,
+		       PTR_ERR(page));
+		GOTO(out, 0);
+	}
+
+	wait_on_page_locked(page);
+	if (PageUptodate(page)) {
+		SetPageReadahead(page);
+		atomic_inc(&cli->cl_readdir_prefetch_pages);
+	}
+	put_page(page);
+out:
+	ldlm_lock_decref(&mrw->mrw_lockh, mrw->mrw_lock_mode);
+	iput(dir);
+	class_export_put(mrw->mrw_exp);
+	OBD_FREE_PTR(mrw);
+}
+
+/*
+ * Prefetch the directory pages after \a hash. A reference on the directory
+ * lock is kept until the pages are in the cache, so that they are dropped by
+ * the lock cancellation if they are stale.
+ */
+static void mdc_readdir_prefetch(struct obd_export *exp,
+				 struct md_op_data *op_data,
+				 struct lustre_handle *lockh,
+				 enum ldlm_mode mode, __u64 hash)
+{
+	struct mdc_readdir_work *mrw;
+	struct inode *dir;
+
+	if (!exp->exp_obd->u.cli.cl_readdir_prefetch ||
+	    hash == MDS_DIR_END_OFF)
+		return;
+
+	OBD_ALLOC_PTR(mrw);
+	if (mrw == NULL)
+		return;
+
+	dir = igrab(op_data->op_data);
+	if (dir == NULL) {
+		OBD_FREE_PTR(mrw);
+		return;
+	}
+
+	INIT_WORK(&mrw->mrw_work, mdc_readdir_prefetch_work);
+	mrw->mrw_exp = class_export_get(exp);
+	mrw->mrw_op_data.op_data = dir;
+	mrw->mrw_op_data.op_fid1 = op_data->op_fid1;
+	mrw->mrw_op_data.op_cli_flags = op_data->op_cli_flags;
+	ldlm_lock_addref(lockh, mode);
+	mrw->mrw_lockh = *lockh;
+	mrw->mrw_lock_mode = mode;
+	mrw->mrw_hash = hash;
+
+	queue_work(mdc_readdir_wq, &mrw->mrw_work);
+}
+
 /**
  * Read dir page from cache first, if it can not find it, read it from
  * server and add into the cache.
@@ -1469,6 +1590,7 @@ static int mdc_read_page(struct obd_export *exp, struct md_op_data *op_data,
 			 struct page **ppage)
 {
 	struct lookup_intent	it = { .it_op = IT_READDIR };
+	struct client_obd	*cli = &exp->exp_obd->u.cli;
 	struct page		*page;
 	struct inode		*dir = op_data->op_data;
 	struct address_space	*mapping;
@@ -1478,6 +1600,7 @@ static int mdc_read_page(struct obd_export *exp, struct md_op_data *op_data,
 	struct lustre_handle	lockh;
 	struct ptlrpc_request	*enq_req = NULL;
 	struct readpage_param	rp_param;
+	bool			prefetch = true;
 	int rc;
 
 	ENTRY;
@@ -1526,6 +1649,9 @@ static int mdc_read_page(struct obd_export *exp, struct md_op_data *op_data,
 		 * it as an "overflow" page. 1. invalidate all pages at
 		 * once. 2. use HASH|1 as an index for P1.
 		 */
+		prefetch = TestClearPageReadahead(page);
+		if (prefetch)
+			atomic_inc(&cli->cl_readdir_prefetch_hits);
 		GOTO(hash_collision, page);
 	}
 
@@ -1587,6 +1713,9 @@ hash_collision:
 		goto fail;
 	}
 	*ppage = page;
+	if (prefetch)
+		mdc_readdir_prefetch(exp, op_data, &lockh, it.it_lock_mode,
+				     le64_to_cpu(dp->ldp_hash_end));
 out_unlock:
 	ldlm_lock_decref(&lockh, it.it_lock_mode);
 	return rc;
@@ -2952,6 +3081,7 @@ int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg)
 
 	obd->u.cli.cl_dom_min_inline_repsize = MDC_DOM_DEF_INLINE_REPSIZE;
 	obd->u.cli.cl_lsom_update = true;
+	obd->u.cli.cl_readdir_prefetch = 1;
 
 	ns_register_cancel(obd->obd_namespace, mdc_cancel_weight);
 
@@ -3013,6 +3143,8 @@ static int mdc_precleanup(struct obd_device *obd)
 
 	osc_precleanup_common(obd);
 	mdc_changelog_cdev_finish(obd);
+	/* prefetch works hold directory inodes */
+	flush_workqueue(mdc_readdir_wq);
 
 	obd_cleanup_client_import(obd);
 	ptlrpc_lprocfs_unregister_obd(obd);
@@ -3099,13 +3231,23 @@ static int __init mdc_init(void)
 		goto out_dev;
 	}
 
+	mdc_readdir_wq = cfs_cpt_bind_workqueue("mdc_readdir", cfs_cpt_tab,
+						0, CFS_CPT_ANY,
+						cfs_cpt_number(cfs_cpt_tab));
+	if (IS_ERR(mdc_readdir_wq)) {
+		rc = PTR_ERR(mdc_readdir_wq);
+		goto out_class;
+	}
+
 	rc = class_register_type(&mdc_obd_ops, &mdc_md_ops, true,
 				 LUSTRE_MDC_NAME, &mdc_device_type);
 	if (rc)
-		goto out_class;
+		goto out_wq;
 
 	return 0;
 
+out_wq:
+	destroy_workqueue(mdc_readdir_wq);
 out_class:
 	class_destroy(mdc_changelog_class);
 out_dev:
@@ -3116,6 +3258,7 @@ out_dev:
 static void __exit mdc_exit(void)
 {
 	class_unregister_type(LUSTRE_MDC_NAME);
+	destroy_workqueue(mdc_readdir_wq);
 	class_destroy(mdc_changelog_class);
 	unregister_chrdev_region(mdc_changelog_dev, MDC_CHANGELOG_DEV_COUNT);
 	idr_destroy(&mdc_changelog_minor_idr);
@@ -35,6 +35,8 @@
 #ifndef _CL_INTERNAL_H
 #define _CL_INTERNAL_H
 
+#define CL_PAGE_POOL_SIZE	32
+
 /**
  * Thread local state internal for generic cl-code.
  */
@@ -43,6 +45,16 @@ struct cl_thread_info {
 	 * Used for submitting a sync I/O.
 	 */
 	struct cl_sync_io clt_anchor;
+	/**
+	 * cl_page buffers allocated in bulk, see cl_page_prealloc_begin()
+	 */
+	void		 *clt_page_pool[CL_PAGE_POOL_SIZE];
+	/** # of buffers left in clt_page_pool */
+	int		  clt_page_pool_nr;
+	/** # of cl_page allocations still expected by the hint */
+	int		  clt_page_pool_want;
+	/** cl_page_kmem_array index the pool is allocated from */
+	int		  clt_page_pool_index;
 };
 
 extern struct kmem_cache *cl_dio_aio_kmem;
@@ -210,7 +210,104 @@ static void cl_page_free(const struct lu_env *env, struct cl_page *cl_page,
 	EXIT;
 }
 
-static struct cl_page *__cl_page_alloc(struct cl_object *o)
+/**
+ * Hint that this thread is about to allocate about \a nr cl_pages of \a o,
+ * e.g. for a readahead window or a DIO chunk, so that their buffers are taken
+ * from the slab in bulk rather than one at a time.
+ *
+ * \retval true if cl_page_prealloc_end() has to be called when done
+ */
+bool cl_page_prealloc_begin(const struct lu_env *env, struct cl_object *o,
+			    int nr)
+{
+#ifdef HAVE_KMEM_CACHE_ALLOC_BULK
+	struct cl_thread_info *info = cl_env_info(env);
+	unsigned short bufsize = cl_object_header(o)->coh_page_bufsize;
+	int i;
+
+	/* already in use further up the stack */
+	if (nr < 2 || info->clt_page_pool_want > 0 ||
+	    info->clt_page_pool_nr > 0)
+		return false;
+
+	for (i = 0; i < ARRAY_SIZE(cl_page_kmem_array); i++) {
+		if (smp_load_acquire(&cl_page_kmem_size_array[i]) ==
+		    bufsize) {
+			info->clt_page_pool_index = i;
+			info->clt_page_pool_want = nr;
+			return true;
+		}
+		/* the slab is created by the first cl_page allocation */
+		if (cl_page_kmem_size_array[i] == 0)
+			break;
+	}
+#endif
+	return false;
+}
+EXPORT_SYMBOL(cl_page_prealloc_begin);
+
+/**
+ * Return the buffers preallocated but not used to the slab.
+ */
+void cl_page_prealloc_end(const struct lu_env *env)
+{
+#ifdef HAVE_KMEM_CACHE_ALLOC_BULK
+	struct cl_thread_info *info = cl_env_info(env);
+
+	if (info->clt_page_pool_nr > 0)
+		kmem_cache_free_bulk(
+			cl_page_kmem_array[info->clt_page_pool_index],
+			info->clt_page_pool_nr, info->clt_page_pool);
+	info->clt_page_pool_nr = 0;
+	info->clt_page_pool_want = 0;
+#endif
+}
+EXPORT_SYMBOL(cl_page_prealloc_end);
+
+static struct cl_page *cl_page_pool_get(const struct lu_env *env,
+					unsigned short bufsize)
+{
+#ifdef HAVE_KMEM_CACHE_ALLOC_BULK
+	struct cl_thread_info *info = cl_env_info(env);
+	int index = info->clt_page_pool_index;
+	struct cl_page *cl_page;
+
+	if (info->clt_page_pool_want <= 0 ||
+	    cl_page_kmem_size_array[index] != bufsize)
+		return NULL;
+
+	if (info->clt_page_pool_nr == 0) {
+		int nr = min_t(int, info->clt_page_pool_want,
+			       CL_PAGE_POOL_SIZE);
+
+		if (OBD_FAIL_CHECK(OBD_FAIL_LLITE_PAGE_BULK_ALLOC))
+			nr = 0;
+		else
+			nr = kmem_cache_alloc_bulk(cl_page_kmem_array[index],
+						   GFP_NOFS, nr,
+						   info->clt_page_pool);
+		/* fall back to allocating one at a time */
+		if (nr <= 0) {
+			info->clt_page_pool_want = 0;
+			return NULL;
+		}
+		info->clt_page_pool_nr = nr;
+	}
+
+	info->clt_page_pool_want--;
+	cl_page = info->clt_page_pool[--info->clt_page_pool_nr];
+	memset(cl_page, 0, bufsize);
+	OBD_ALLOC_POST(cl_page, bufsize, "slab-alloced");
+	cl_page->cp_kmem_index = index;
+
+	return cl_page;
+#else
+	return NULL;
+#endif
+}
+
+static struct cl_page *__cl_page_alloc(const struct lu_env *env,
+				       struct cl_object *o)
 {
 	int i = 0;
 	struct cl_page *cl_page = NULL;
@@ -219,6 +316,10 @@ static struct cl_page *__cl_page_alloc(struct cl_object *o)
 	if (OBD_FAIL_CHECK(OBD_FAIL_LLITE_PAGE_ALLOC))
 		return NULL;
 
+	cl_page = cl_page_pool_get(env, bufsize);
+	if (cl_page)
+		return cl_page;
+
 check:
 	/* the number of entries in cl_page_kmem_array is expected to
 	 * only be 2-3 entries, so the lookup overhead should be low.
@@ -275,7 +376,7 @@ struct cl_page *cl_page_alloc(const struct lu_env *env, struct cl_object *o,
 
 	ENTRY;
 
-	cl_page = __cl_page_alloc(o);
+	cl_page = __cl_page_alloc(env, o);
 	if (cl_page != NULL) {
 		int result = 0;
 
@@ -1286,10 +1387,17 @@ struct cl_client_cache *cl_cache_init(unsigned long lru_page_max)
 	if (cache == NULL)
 		RETURN(NULL);
 
+	cache->ccc_lru_left_pcp = alloc_percpu(atomic_long_t);
+	if (cache->ccc_lru_left_pcp == NULL) {
+		OBD_FREE(cache, sizeof(*cache));
+		RETURN(NULL);
+	}
+
 	/* Initialize cache data */
 	atomic_set(&cache->ccc_users, 1);
 	cache->ccc_lru_max = lru_page_max;
 	atomic_long_set(&cache->ccc_lru_left, lru_page_max);
+	atomic_long_set(&cache->ccc_lru_pcp_refill, 0);
 	spin_lock_init(&cache->ccc_lru_lock);
 	INIT_LIST_HEAD(&cache->ccc_lru);
 
@@ -1317,7 +1425,113 @@ EXPORT_SYMBOL(cl_cache_incref);
  */
 void cl_cache_decref(struct cl_client_cache *cache)
 {
-	if (atomic_dec_and_test(&cache->ccc_users))
+	if (atomic_dec_and_test(&cache->ccc_users)) {
+		free_percpu(cache->ccc_lru_left_pcp);
 		OBD_FREE(cache, sizeof(*cache));
+	}
 }
 EXPORT_SYMBOL(cl_cache_decref);
+
+/* # of LRU slots moved between ccc_lru_left and a CPU stash at once */
+#define CCC_LRU_PCP_BATCH	64
+
+/* the stash is only refilled while this many slots are left globally */
+static inline long cl_cache_lru_plenty(struct cl_client_cache *cache)
+{
+	return (cache->ccc_lru_max >> 1) + CCC_LRU_PCP_BATCH;
+}
+
+/**
+ * Take one LRU slot, from the local CPU stash if possible.
+ *
+ * \retval true if a slot was taken, false if no slot is left
+ */
+bool cl_cache_lru_get(struct cl_client_cache *cache)
+{
+	atomic_long_t *pcp;
+	long left;
+	bool rc = true;
+
+	pcp = get_cpu_ptr(cache->ccc_lru_left_pcp);
+	if (atomic_long_add_unless(pcp, -1, 0))
+		goto out;
+
+	left = atomic_long_read(&cache->ccc_lru_left);
+	while (left >= cl_cache_lru_plenty(cache)) {
+		if (atomic_long_cmpxchg(&cache->ccc_lru_left, left,
+					left - CCC_LRU_PCP_BATCH) == left) {
+			atomic_long_add(CCC_LRU_PCP_BATCH - 1, pcp);
+			atomic_long_inc(&cache->ccc_lru_pcp_refill);
+			goto out;
+		}
+		left = atomic_long_read(&cache->ccc_lru_left);
+	}
+
+	rc = atomic_long_add_unless(&cache->ccc_lru_left, -1, 0);
+out:
+	put_cpu_ptr(cache->ccc_lru_left_pcp);
+
+	return rc;
+}
+EXPORT_SYMBOL(cl_cache_lru_get);
+
+/**
+ * Return one LRU slot. It stays in the local CPU stash unless the stash is
+ * full or slots run short, in which case waiters must see it in
+ * ccc_lru_left.
+ */
+void cl_cache_lru_put(struct cl_client_cache *cache)
+{
+	atomic_long_t *pcp;
+	long stash;
+
+	if (atomic_long_read(&cache->ccc_lru_left) <
+	    cl_cache_lru_plenty(cache)) {
+		atomic_long_inc(&cache->ccc_lru_left);
+		return;
+	}
+
+	pcp = get_cpu_ptr(cache->ccc_lru_left_pcp);
+	stash = atomic_long_inc_return(pcp);
+	/* cl_cache_lru_drain() may empty the stash under us */
+	if (stash > 2 * CCC_LRU_PCP_BATCH &&
+	    atomic_long_cmpxchg(pcp, stash,
+				stash - CCC_LRU_PCP_BATCH) == stash)
+		atomic_long_add(CCC_LRU_PCP_BATCH, &cache->ccc_lru_left);
+	put_cpu_ptr(cache->ccc_lru_left_pcp);
+}
+EXPORT_SYMBOL(cl_cache_lru_put);
+
+/**
+ * # of free LRU slots, including the ones stashed by CPUs.
+ */
+long cl_cache_lru_left(struct cl_client_cache *cache)
+{
+	long left = atomic_long_read(&cache->ccc_lru_left);
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		left += atomic_long_read(per_cpu_ptr(cache->ccc_lru_left_pcp,
+						     cpu));
+
+	return left;
+}
+EXPORT_SYMBOL(cl_cache_lru_left);
+
+/**
+ * Move all stashed LRU slots back to ccc_lru_left, before waiting for free
+ * slots or shrinking the cache.
+ */
+void cl_cache_lru_drain(struct cl_client_cache *cache)
+{
+	long stash;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		stash = atomic_long_xchg(per_cpu_ptr(cache->ccc_lru_left_pcp,
+						     cpu), 0);
+		if (stash > 0)
+			atomic_long_add(stash, &cache->ccc_lru_left);
+	}
+}
+EXPORT_SYMBOL(cl_cache_lru_drain);
@@ -1405,6 +1405,7 @@ struct obd_import *class_new_import(struct obd_device *obd)
 	spin_lock_init(&imp->imp_lock);
 	imp->imp_last_success_conn = 0;
 	imp->imp_state = LUSTRE_IMP_NEW;
+	imp->imp_cpt = -1;
 	imp->imp_obd = class_incref(obd, "import", imp);
 	rwlock_init(&imp->imp_sec_lock);
 	init_waitqueue_head(&imp->imp_recovery_waitq);
@@ -649,6 +649,12 @@ static const char *const obd_connect_names[] = {
 	"lock_contend",		/* 0x2000000 */
 	"atomic_open_lock",	/* 0x4000000 */
 	"name_encryption",	/* 0x8000000 */
+	"encryption_fid2path",	/* 0x10000000 */
+	"dmv_imp_inherit",	/* 0x20000000 */
+	"unaligned_dio",	/* 0x40000000 */
+	"large_nid",		/* 0x80000000 */
+	"compress",		/* 0x100000000 */
+	"multiobj_brw",		/* 0x200000000 */
 	NULL
 };
 
@@ -834,12 +840,14 @@ static void lprocfs_import_seq_show_locked(struct seq_file *m,
 		   "       connection_attempts: %u\n"
 		   "       generation: %u\n"
 		   "       in-progress_invalidations: %u\n"
-		   "       idle: %lld sec\n",
+		   "       idle: %lld sec\n"
+		   "       cpt: %d\n",
 		   nidstr,
 		   imp->imp_conn_cnt,
 		   imp->imp_generation,
 		   atomic_read(&imp->imp_inval_count),
-		   ktime_get_real_seconds() - imp->imp_last_reply_time);
+		   ktime_get_real_seconds() - imp->imp_last_reply_time,
+		   READ_ONCE(imp->imp_cpt));
 	spin_unlock(&imp->imp_lock);
 
 	if (!obd->obd_svc_stats)
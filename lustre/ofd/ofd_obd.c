@@ -161,6 +161,9 @@ static int ofd_parse_connect_data(const struct lu_env *env,
 
 	if (data->ocd_connect_flags & OBD_CONNECT_FLAGS2)
 		data->ocd_connect_flags2 &= OST_CONNECT_SUPPORTED2;
+#if !IS_ENABLED(CONFIG_LZ4_DECOMPRESS)
+	data->ocd_connect_flags2 &= ~OBD_CONNECT2_COMPRESS;
+#endif
 
 	/* Kindly make sure the SKIP_ORPHAN flag is from MDS. */
 	if (data->ocd_connect_flags & OBD_CONNECT_MDS)
@@ -191,11 +191,13 @@ static int osc_cached_mb_seq_show(struct seq_file *m, void *v)
 
 	seq_printf(m, "used_mb: %ld\n"
 		   "busy_cnt: %ld\n"
-		   "reclaim: %llu\n",
+		   "reclaim: %llu\n"
+		   "lock_contended: %ld\n",
 		   (atomic_long_read(&cli->cl_lru_in_list) +
 		    atomic_long_read(&cli->cl_lru_busy)) >> shift,
 		    atomic_long_read(&cli->cl_lru_busy),
-		   cli->cl_lru_reclaim);
+		   cli->cl_lru_reclaim,
+		   atomic_long_read(&cli->cl_lru_lock_contended));
 
 	return 0;
 }
@@ -393,6 +395,71 @@ static ssize_t checksums_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(checksums);
 
+static ssize_t brw_compress_show(struct kobject *kobj,
+				 struct attribute *attr,
+				 char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", !!obd->u.cli.cl_brw_compress);
+}
+
+static ssize_t brw_compress_store(struct kobject *kobj,
+				  struct attribute *attr,
+				  const char *buffer,
+				  size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	if (val && !IS_ENABLED(CONFIG_LZ4_COMPRESS))
+		return -EOPNOTSUPP;
+
+	obd->u.cli.cl_brw_compress = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(brw_compress);
+
+static ssize_t job_fair_show(struct kobject *kobj, struct attribute *attr,
+			     char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", !!obd->u.cli.cl_job_fair);
+}
+
+static ssize_t job_fair_store(struct kobject *kobj, struct attribute *attr,
+			      const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct client_obd *cli = &obd->u.cli;
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	cli->cl_job_fair = val;
+	/* jobs held back by their share may go on now */
+	wake_up_all(&cli->cl_cache_waiters);
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(job_fair);
+
 DECLARE_CKSUM_NAME;
 
 static int osc_checksum_type_seq_show(struct seq_file *m, void *v)
@@ -549,6 +616,74 @@ static int osc_unstable_stats_seq_show(struct seq_file *m, void *v)
 }
 LPROC_SEQ_FOPS_RO(osc_unstable_stats);
 
+static int osc_job_grant_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct obd_device *obd = seq->private;
+	struct client_obd *cli = &obd->u.cli;
+	struct osc_job_slot *slot;
+	int i;
+
+	if (cli->cl_job_slots == NULL)
+		return 0;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	lprocfs_stats_header(seq, ktime_get_real(), cli->cl_job_stats_init,
+			     25, ":", true, "");
+	seq_printf(seq, "%-25s %d\n", "jobs_waiting:", cli->cl_job_waiting);
+	seq_puts(seq, "job_stats:\n");
+	for (i = 0; i < OSC_JOB_SLOTS; i++) {
+		slot = &cli->cl_job_slots[i];
+		if (slot->ojs_jobid[0] == '\0')
+			continue;
+
+		seq_printf(seq, "- %-16s %s\n", "job_id:", slot->ojs_jobid);
+		seq_printf(seq, "  %-16s %ld\n", "dirty_pages:",
+			   atomic_long_read(&slot->ojs_dirty));
+		seq_printf(seq, "  %-16s %u\n", "waiters:", slot->ojs_waiters);
+		seq_printf(seq, "  %-16s %llu\n", "waits:", slot->ojs_waits);
+		seq_printf(seq, "  %-16s %llu\n", "wait_us:",
+			   slot->ojs_wait_us);
+		seq_printf(seq, "  %-16s %llu\n", "wait_max_us:",
+			   slot->ojs_wait_max_us);
+		seq_printf(seq, "  %-16s %llu\n", "throttled:",
+			   slot->ojs_throttled);
+		seq_printf(seq, "  %-16s %llu\n", "sync_fallback:",
+			   slot->ojs_sync);
+	}
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return 0;
+}
+
+static ssize_t osc_job_grant_stats_seq_write(struct file *file,
+					     const char __user *buf,
+					     size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+	struct obd_device *obd = seq->private;
+	struct client_obd *cli = &obd->u.cli;
+	struct osc_job_slot *slot;
+	int i;
+
+	if (cli->cl_job_slots == NULL)
+		return len;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	for (i = 0; i < OSC_JOB_SLOTS; i++) {
+		slot = &cli->cl_job_slots[i];
+		slot->ojs_waits = 0;
+		slot->ojs_wait_us = 0;
+		slot->ojs_wait_max_us = 0;
+		slot->ojs_throttled = 0;
+		slot->ojs_sync = 0;
+	}
+	cli->cl_job_stats_init = ktime_get_real();
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return len;
+}
+LPROC_SEQ_FOPS(osc_job_grant_stats);
+
 static ssize_t idle_timeout_show(struct kobject *kobj, struct attribute *attr,
 				 char *buf)
 {
@@ -701,6 +836,8 @@ struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 	  .fops	=	&osc_pinger_recov_fops		},
 	{ .name	=	"unstable_stats",
 	  .fops	=	&osc_unstable_stats_fops	},
+	{ .name	=	"job_grant_stats",
+	  .fops	=	&osc_job_grant_stats_fops	},
 	{ NULL }
 };
 
@@ -829,6 +966,10 @@ static int osc_stats_seq_show(struct seq_file *seq, void *v)
 		   stats->os_lockless_writes);
 	seq_printf(seq, "lockless_read_bytes\t\t%llu\n",
 		   stats->os_lockless_reads);
+	seq_printf(seq, "compressed_raw_bytes\t\t%llu\n",
+		   stats->os_compr_raw);
+	seq_printf(seq, "compressed_sent_bytes\t\t%llu\n",
+		   stats->os_compr_sent);
 	return 0;
 }
 
@@ -865,6 +1006,8 @@ static int lprocfs_osc_attach_seqstat(struct obd_device *obd)
 static struct attribute *osc_attrs[] = {
 	&lustre_attr_active.attr,
 	&lustre_attr_checksums.attr,
+	&lustre_attr_brw_compress.attr,
+	&lustre_attr_job_fair.attr,
 	&lustre_attr_checksum_dump.attr,
 	&lustre_attr_cur_dirty_bytes.attr,
 	&lustre_attr_cur_lost_grant_bytes.attr,
@@ -66,6 +66,13 @@ static void osc_extent_tree_dump0(int mask, struct osc_object *obj,
 static void osc_unreserve_grant(struct client_obd *cli, unsigned int reserved,
 				unsigned int unused);
 
+/* account @nr dirty pages to (or from, if negative) job slot @job */
+static inline void osc_job_dirty_add(struct client_obd *cli, int job, long nr)
+{
+	if (job >= 0)
+		atomic_long_add(nr, &cli->cl_job_slots[job].ojs_dirty);
+}
+
 /** \addtogroup osc
  *  @{
  */
@@ -337,6 +344,7 @@ static struct osc_extent *osc_extent_alloc(struct osc_object *obj)
 	INIT_LIST_HEAD(&ext->oe_pages);
 	init_waitqueue_head(&ext->oe_waitq);
 	ext->oe_dlmlock = NULL;
+	ext->oe_job = -1;
 
 	return ext;
 }
@@ -566,6 +574,16 @@ static int osc_extent_merge(const struct lu_env *env, struct osc_extent *cur,
 	cur->oe_end       = max(cur->oe_end,   victim->oe_end);
 	/* per-extent tax should be accounted only once for the whole extent */
 	cur->oe_grants   += victim->oe_grants - cli->cl_grant_extent_tax;
+	if (victim->oe_job != cur->oe_job && victim->oe_nr_pages > 0) {
+		if (cur->oe_nr_pages == 0) {
+			cur->oe_job = victim->oe_job;
+		} else {
+			osc_job_dirty_add(cli, victim->oe_job,
+					  -(long)victim->oe_nr_pages);
+			osc_job_dirty_add(cli, cur->oe_job,
+					  victim->oe_nr_pages);
+		}
+	}
 	cur->oe_nr_pages += victim->oe_nr_pages;
 	/* only the following bits are needed to merge */
 	cur->oe_urgent   |= victim->oe_urgent;
@@ -879,6 +897,7 @@ int osc_extent_finish(const struct lu_env *env, struct osc_extent *ext,
 
 		lost_grant = PAGE_SIZE - count;
 	}
+	osc_job_dirty_add(cli, ext->oe_job, -nr_pages);
 	if (ext->oe_grants > 0)
 		osc_free_grant(cli, nr_pages, lost_grant, ext->oe_grants);
 
@@ -1053,6 +1072,7 @@ static int osc_extent_truncate(struct osc_extent *ext, pgoff_t trunc_index,
 	}
 	osc_object_unlock(obj);
 
+	osc_job_dirty_add(cli, ext->oe_job, -nr_pages);
 	if (grants > 0 || nr_pages > 0)
 		osc_free_grant(cli, nr_pages, grants, grants);
 
@@ -1510,18 +1530,124 @@ static void osc_exit_cache(struct client_obd *cli, struct osc_async_page *oap)
 	spin_unlock(&cli->cl_loi_list_lock);
 }
 
+/**
+ * Find the job slot for @jobid and take a reference on it, recycling the
+ * least recently used idle slot if this job is not tracked yet. A slot is
+ * idle when it has no dirty pages, waiters nor references, so it cannot be
+ * handed to another job while an IO of its job is going on.
+ *
+ * Called once per IO iteration, the slot is released by osc_job_slot_put().
+ *
+ * \retval the slot, or NULL if all slots are busy and the dirty pages of
+ *	   this job will not be accounted
+ */
+struct osc_job_slot *osc_job_slot_get(struct client_obd *cli,
+				      const char *jobid)
+{
+	struct osc_job_slot *slots = cli->cl_job_slots;
+	struct osc_job_slot *slot;
+	int victim = -1;
+	int i;
+
+	if (slots == NULL)
+		return NULL;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	for (i = 0; i < OSC_JOB_SLOTS; i++) {
+		slot = &slots[i];
+		if (strncmp(slot->ojs_jobid, jobid,
+			    sizeof(slot->ojs_jobid)) == 0) {
+			victim = i;
+			goto out;
+		}
+		if (atomic_long_read(&slot->ojs_dirty) == 0 &&
+		    slot->ojs_waiters == 0 && slot->ojs_refs == 0 &&
+		    (victim < 0 ||
+		     slot->ojs_last_used < slots[victim].ojs_last_used))
+			victim = i;
+	}
+	if (victim >= 0) {
+		slot = &slots[victim];
+		memset(slot, 0, sizeof(*slot));
+		strscpy(slot->ojs_jobid, jobid, sizeof(slot->ojs_jobid));
+	}
+out:
+	slot = NULL;
+	if (victim >= 0) {
+		slot = &slots[victim];
+		slot->ojs_refs++;
+		slot->ojs_last_used = ktime_get_real_seconds();
+	}
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return slot;
+}
+
+void osc_job_slot_put(struct client_obd *cli, struct osc_job_slot *slot)
+{
+	spin_lock(&cli->cl_loi_list_lock);
+	LASSERT(slot->ojs_refs > 0);
+	slot->ojs_refs--;
+	spin_unlock(&cli->cl_loi_list_lock);
+}
+
+/* index of the job slot of @oio, -1 if its dirty pages are not accounted */
+static inline int osc_io_job(struct client_obd *cli, struct osc_io *oio)
+{
+	return oio->oi_job_slot ? oio->oi_job_slot - cli->cl_job_slots : -1;
+}
+
+/**
+ * Check whether job @job has to leave the write cache to the other jobs
+ * waiting for it: the cache is shared evenly by the jobs having dirty pages
+ * or waiting for grant, but never less than one RPC per job.
+ *
+ * client_obd_list_lock held by caller
+ */
+static bool osc_job_over_share(struct client_obd *cli, int job)
+{
+	struct osc_job_slot *slot;
+	unsigned long share;
+	int active = 0;
+	int i;
+
+	if (job < 0 || !cli->cl_job_fair)
+		return false;
+
+	slot = &cli->cl_job_slots[job];
+	if (cli->cl_job_waiting <= !!slot->ojs_waiters)
+		return false;
+
+	for (i = 0; i < OSC_JOB_SLOTS; i++) {
+		if (atomic_long_read(&cli->cl_job_slots[i].ojs_dirty) > 0 ||
+		    cli->cl_job_slots[i].ojs_waiters > 0)
+			active++;
+	}
+	share = max_t(unsigned long, cli->cl_dirty_max_pages / max(active, 1),
+		      cli->cl_max_pages_per_rpc);
+
+	if (atomic_long_read(&slot->ojs_dirty) < share)
+		return false;
+
+	slot->ojs_throttled++;
+	return true;
+}
+
 /**
  * Non-blocking version of osc_enter_cache() that consumes grant only when it
- * is available.
+ * is available and job @job is within its share of the cache.
  */
 static int osc_enter_cache_try(struct client_obd *cli,
 			       struct osc_async_page *oap,
-			       int bytes)
+			       int bytes, int job)
 {
 	int rc;
 
 	OSC_DUMP_GRANT(D_CACHE, cli, "need:%d\n", bytes);
 
+	if (osc_job_over_share(cli, job))
+		return 0;
+
 	rc = osc_reserve_grant(cli, bytes);
 	if (rc < 0)
 		return 0;
@@ -1569,10 +1695,12 @@ static inline void cli_lock_after_unplug(struct client_obd *cli)
  * The process will be put into sleep if it's already run out of grant.
  */
 static int osc_enter_cache(const struct lu_env *env, struct client_obd *cli,
-			   struct osc_async_page *oap, int bytes)
+			   struct osc_async_page *oap, int bytes, int job)
 {
 	struct osc_object *osc = oap->oap_obj;
 	struct lov_oinfo *loi = osc->oo_oinfo;
+	struct osc_job_slot *slot = NULL;
+	ktime_t start = ktime_get();
 	int rc = -EDQUOT;
 	int remain;
 	bool entered = false;
@@ -1611,13 +1739,32 @@ static int osc_enter_cache(const struct lu_env *env, struct client_obd *cli,
 	 * and no dirty pages caching, that really means there is no space
 	 * on the OST.
 	 */
+	if (job >= 0) {
+		slot = &cli->cl_job_slots[job];
+		if (slot->ojs_waiters++ == 0)
+			cli->cl_job_waiting++;
+	}
 	remain = wait_event_idle_exclusive_timeout_cmd(
 		cli->cl_cache_waiters,
-		(entered = osc_enter_cache_try(cli, oap, bytes)) ||
+		(entered = osc_enter_cache_try(cli, oap, bytes, job)) ||
 		(cli->cl_dirty_pages == 0 && cli->cl_w_in_flight == 0),
 		timeout,
 		cli_unlock_and_unplug(env, cli, oap),
 		cli_lock_after_unplug(cli));
+	if (slot != NULL) {
+		if (--slot->ojs_waiters == 0)
+			cli->cl_job_waiting--;
+		if (!entered || remain != timeout) {
+			u64 us = ktime_us_delta(ktime_get(), start);
+
+			slot->ojs_waits++;
+			slot->ojs_wait_us += us;
+			if (us > slot->ojs_wait_max_us)
+				slot->ojs_wait_max_us = us;
+		}
+		if (!entered)
+			slot->ojs_sync++;
+	}
 
 	if (entered) {
 		if (remain == timeout)
@@ -1625,7 +1772,7 @@ static int osc_enter_cache(const struct lu_env *env, struct client_obd *cli,
 		else
 			OSC_DUMP_GRANT(D_CACHE, cli,
 				       "finally got grant space\n");
-		wake_up(&cli->cl_cache_waiters);
+		osc_wake_cache_waiters(cli);
 		rc = 0;
 	} else if (remain == 0) {
 		OSC_DUMP_GRANT(D_CACHE, cli,
@@ -2001,9 +2148,135 @@ static unsigned int get_write_extents(struct osc_object *obj,
 	return data.erd_page_count;
 }
 
+/*
+ * Small writes of several objects, batched by osc_check_rpcs() into a single
+ * short io RPC to the OST. The objects of a batch have the same owner and
+ * jobid, as the OST returns the overquota flags and accounts the job stats
+ * once per RPC.
+ */
+struct osc_write_batch {
+	struct list_head	owb_exts;
+	unsigned int		owb_objs;
+	unsigned int		owb_pages;
+	unsigned int		owb_bytes;
+	u32			owb_uid;
+	u32			owb_gid;
+	u32			owb_projid;
+	char			owb_jobid[LUSTRE_JOBID_SIZE];
+};
+
+/* request space taken by the data and descriptors of a batch */
+static inline unsigned long osc_write_batch_size(unsigned int objs,
+						 unsigned int pages,
+						 unsigned int bytes)
+{
+	return bytes + objs * (sizeof(struct obdo) + sizeof(struct obd_ioobj)) +
+	       pages * sizeof(struct niobuf_remote);
+}
+
+static int osc_write_batch_flush(const struct lu_env *env,
+				 struct client_obd *cli,
+				 struct osc_write_batch *batch)
+{
+	int rc;
+
+	if (batch->owb_objs == 0)
+		return 0;
+
+	rc = osc_build_rpc(env, cli, &batch->owb_exts, OBD_BRW_WRITE);
+	LASSERT(list_empty(&batch->owb_exts));
+	if (rc < 0)
+		CERROR("%s: batched write request failed: rc = %d\n",
+		       cli_name(cli), rc);
+
+	batch->owb_objs = 0;
+	batch->owb_pages = 0;
+	batch->owb_bytes = 0;
+	return rc;
+}
+
+/*
+ * Move the extents of one object, ready to be sent, from @rpclist to @batch
+ * if they are small enough to share a short io RPC with other objects. The
+ * batch is sent first if this object does not fit in it.
+ *
+ * \retval true if the extents were added to the batch
+ */
+static bool osc_write_batch_add(const struct lu_env *env,
+				struct client_obd *cli,
+				struct osc_write_batch *batch,
+				struct list_head *rpclist)
+{
+	struct osc_thread_info *oti = osc_env_info(env);
+	struct cl_req_attr *crattr = &oti->oti_req_attr;
+	struct obdo *oa = &oti->oti_oa;
+	struct osc_extent *ext;
+	struct osc_async_page *oap;
+	struct cl_page *page;
+	unsigned int pages = 0;
+	unsigned int bytes = 0;
+
+	if (!imp_connect_multiobj_brw(cli->cl_import) ||
+	    !imp_connect_shortio(cli->cl_import))
+		return false;
+
+	list_for_each_entry(ext, rpclist, oe_link) {
+		if (ext->oe_srvlock || ext->oe_hp || ext->oe_ndelay ||
+		    ext->oe_dio || ext->oe_memalloc || ext->oe_is_rdma_only)
+			return false;
+		pages += ext->oe_nr_pages;
+		list_for_each_entry(oap, &ext->oe_pages, oap_pending_item)
+			bytes += oap->oap_count;
+	}
+	if (bytes > cli->cl_max_short_io_bytes ||
+	    osc_write_batch_size(1, pages, bytes) > OST_MAX_SHORT_IO_BYTES)
+		return false;
+
+	ext = list_first_entry(rpclist, struct osc_extent, oe_link);
+	oap = list_first_entry(&ext->oe_pages, struct osc_async_page,
+			       oap_pending_item);
+	page = oap2cl_page(oap);
+	/* encrypted data is sent as whole encryption units */
+	if (page->cp_inode != NULL && IS_ENCRYPTED(page->cp_inode))
+		return false;
+
+	memset(crattr, 0, sizeof(*crattr));
+	memset(oa, 0, sizeof(*oa));
+	crattr->cra_type = CRT_WRITE;
+	crattr->cra_flags = OBD_MD_FLUID | OBD_MD_FLGID | OBD_MD_FLPROJID;
+	crattr->cra_page = page;
+	crattr->cra_oa = oa;
+	cl_req_attr_set(env, osc2cl(ext->oe_obj), crattr);
+
+	if (batch->owb_objs > 0 &&
+	    (batch->owb_pages + pages > cli->cl_max_pages_per_rpc ||
+	     batch->owb_bytes + bytes > cli->cl_max_short_io_bytes ||
+	     osc_write_batch_size(batch->owb_objs + 1, batch->owb_pages + pages,
+				  batch->owb_bytes + bytes) >
+	     OST_MAX_SHORT_IO_BYTES ||
+	     oa->o_uid != batch->owb_uid || oa->o_gid != batch->owb_gid ||
+	     oa->o_projid != batch->owb_projid ||
+	     strncmp(crattr->cra_jobid, batch->owb_jobid,
+		     sizeof(batch->owb_jobid)) != 0))
+		osc_write_batch_flush(env, cli, batch);
+
+	if (batch->owb_objs == 0) {
+		batch->owb_uid = oa->o_uid;
+		batch->owb_gid = oa->o_gid;
+		batch->owb_projid = oa->o_projid;
+		memcpy(batch->owb_jobid, crattr->cra_jobid,
+		       sizeof(batch->owb_jobid));
+	}
+	list_splice_tail_init(rpclist, &batch->owb_exts);
+	batch->owb_objs++;
+	batch->owb_pages += pages;
+	batch->owb_bytes += bytes;
+	return true;
+}
+
 static int
 osc_send_write_rpc(const struct lu_env *env, struct client_obd *cli,
-		   struct osc_object *osc)
+		   struct osc_object *osc, struct osc_write_batch *batch)
 __must_hold(osc)
 {
 	LIST_HEAD(rpclist);
@@ -2055,7 +2328,8 @@ __must_hold(osc)
 		}
 	}
 
-	if (!list_empty(&rpclist)) {
+	if (!list_empty(&rpclist) &&
+	    !osc_write_batch_add(env, cli, batch, &rpclist)) {
 		LASSERT(page_count > 0);
 		rc = osc_build_rpc(env, cli, &rpclist, OBD_BRW_WRITE);
 		LASSERT(list_empty(&rpclist));
@@ -2163,6 +2437,9 @@ static void osc_check_rpcs(const struct lu_env *env, struct client_obd *cli)
 __must_hold(&cli->cl_loi_list_lock)
 {
 	struct osc_object *osc;
+	struct osc_write_batch batch = {
+		.owb_exts = LIST_HEAD_INIT(batch.owb_exts),
+	};
 	int rc = 0;
 	ENTRY;
 
@@ -2194,7 +2471,7 @@ __must_hold(&cli->cl_loi_list_lock)
 		 * do io on writes while there are cache waiters */
 		osc_object_lock(osc);
 		if (osc_makes_rpc(cli, osc, OBD_BRW_WRITE)) {
-			rc = osc_send_write_rpc(env, cli, osc);
+			rc = osc_send_write_rpc(env, cli, osc, &batch);
 			if (rc < 0) {
 				CERROR("Write request failed with %d\n", rc);
 
@@ -2230,6 +2507,12 @@ __must_hold(&cli->cl_loi_list_lock)
 
 		spin_lock(&cli->cl_loi_list_lock);
 	}
+
+	if (batch.owb_objs > 0) {
+		spin_unlock(&cli->cl_loi_list_lock);
+		osc_write_batch_flush(env, cli, &batch);
+		spin_lock(&cli->cl_loi_list_lock);
+	}
 	EXIT;
 }
 
@@ -2388,7 +2671,8 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 
 		/* it doesn't need any grant to dirty this page */
 		spin_lock(&cli->cl_loi_list_lock);
-		rc = osc_enter_cache_try(cli, oap, grants);
+		rc = osc_enter_cache_try(cli, oap, grants,
+					 osc_io_job(cli, oio));
 		if (rc == 0) { /* try failed */
 			grants = 0;
 			need_release = 1;
@@ -2437,7 +2721,8 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 				cb(env, io, fbatch);
 				folio_batch_reinit(fbatch);
 			}
-			rc = osc_enter_cache(env, cli, oap, tmp);
+			rc = osc_enter_cache(env, cli, oap, tmp,
+					     osc_io_job(cli, oio));
 			if (rc == 0)
 				grants = tmp;
 		}
@@ -2465,10 +2750,13 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 		LASSERT((oap->oap_brw_flags & OBD_BRW_FROM_GRANT) != 0);
 
 		osc_object_lock(osc);
-		if (ext->oe_nr_pages == 0)
+		if (ext->oe_nr_pages == 0) {
 			ext->oe_srvlock = ops->ops_srvlock;
-		else
+			ext->oe_job = osc_io_job(cli, oio);
+		} else {
 			LASSERT(ext->oe_srvlock == ops->ops_srvlock);
+		}
+		osc_job_dirty_add(cli, ext->oe_job, 1);
 		++ext->oe_nr_pages;
 		list_add_tail(&oap->oap_pending_item, &ext->oe_pages);
 		osc_object_unlock(osc);
@@ -36,6 +36,7 @@
 
 #define DEBUG_SUBSYSTEM S_OSC
 
+#include <obd_class.h>
 #include <lustre_obdo.h>
 #include <lustre_osc.h>
 #include <linux/pagevec.h>
@@ -435,6 +436,20 @@ int osc_io_iter_init(const struct lu_env *env, const struct cl_io_slice *ios)
 	if (capable(CAP_SYS_RESOURCE))
 		oio->oi_cap_sys_resource = 1;
 
+	/* account the dirty pages to the writing job, or to its user if
+	 * jobstats are disabled */
+	if (rc == 0 && osc_cli(osc)->cl_job_fair &&
+	    (ios->cis_io->ci_type == CIT_WRITE ||
+	     ios->cis_io->ci_type == CIT_FAULT)) {
+		char jobid[LUSTRE_JOBID_SIZE];
+
+		if (lustre_get_jobid(jobid, sizeof(jobid)) != 0 ||
+		    jobid[0] == '\0')
+			snprintf(jobid, sizeof(jobid), "uid.%u",
+				 from_kuid(&init_user_ns, current_uid()));
+		oio->oi_job_slot = osc_job_slot_get(osc_cli(osc), jobid);
+	}
+
 	RETURN(rc);
 }
 EXPORT_SYMBOL(osc_io_iter_init);
@@ -444,6 +459,12 @@ void osc_io_iter_fini(const struct lu_env *env,
 {
 	struct osc_io *oio = osc_env_io(env);
 
+	if (oio->oi_job_slot != NULL) {
+		osc_job_slot_put(osc_cli(cl2osc(ios->cis_obj)),
+				 oio->oi_job_slot);
+		oio->oi_job_slot = NULL;
+	}
+
 	if (oio->oi_is_active) {
 		struct osc_object *osc = cl2osc(ios->cis_obj);
 
@@ -338,6 +338,14 @@ void osc_page_submit(const struct lu_env *env, struct osc_page *opg,
 
 static DECLARE_WAIT_QUEUE_HEAD(osc_lru_waitq);
 
+static inline void osc_lru_lock(struct client_obd *cli)
+{
+	if (unlikely(!spin_trylock(&cli->cl_lru_list_lock))) {
+		atomic_long_inc(&cli->cl_lru_lock_contended);
+		spin_lock(&cli->cl_lru_list_lock);
+	}
+}
+
 /**
  * LRU pages are freed in batch mode. OSC should at least free this
  * number of pages to avoid running out of LRU slots.
@@ -372,8 +380,11 @@ static int osc_cache_too_much(struct client_obd *cli)
 	budget = cache->ccc_lru_max / (atomic_read(&cache->ccc_users) - 2);
 
 	/* if it's going to run out LRU slots, we should free some, but not
-	 * too much to maintain faireness among OSCs. */
-	if (atomic_long_read(cli->cl_lru_left) < cache->ccc_lru_max >> 2) {
+	 * too much to maintain faireness among OSCs. The slots stashed by
+	 * the CPUs are free too, only count them when the global pool is low.
+	 */
+	if (atomic_long_read(cli->cl_lru_left) < cache->ccc_lru_max >> 2 &&
+	    cl_cache_lru_left(cache) < cache->ccc_lru_max >> 2) {
 		if (pages >= budget)
 			return lru_shrink_max(cli);
 		else if (pages >= budget / 2)
@@ -435,7 +446,7 @@ void osc_lru_add_batch(struct client_obd *cli, struct list_head *plist)
 	}
 
 	if (npages > 0) {
-		spin_lock(&cli->cl_lru_list_lock);
+		osc_lru_lock(cli);
 		list_splice_tail(&lru, &cli->cl_lru_list);
 		atomic_long_sub(npages, &cli->cl_lru_busy);
 		atomic_long_add(npages, &cli->cl_lru_in_list);
@@ -461,7 +472,7 @@ static void __osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 static void osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 {
 	if (opg->ops_in_lru) {
-		spin_lock(&cli->cl_lru_list_lock);
+		osc_lru_lock(cli);
 		if (!list_empty(&opg->ops_lru)) {
 			__osc_lru_del(cli, opg);
 		} else {
@@ -470,7 +481,7 @@ static void osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 		}
 		spin_unlock(&cli->cl_lru_list_lock);
 
-		atomic_long_inc(cli->cl_lru_left);
+		cl_cache_lru_put(cli->cl_cache);
 		/* this is a great place to release more LRU pages if
 		 * this osc occupies too many LRU pages and kernel is
 		 * stealing one of them. */
@@ -494,7 +505,7 @@ static void osc_lru_use(struct client_obd *cli, struct osc_page *opg)
 	if (opg->ops_in_lru) {
 		if (list_empty(&opg->ops_lru))
 			return;
-		spin_lock(&cli->cl_lru_list_lock);
+		osc_lru_lock(cli);
 		if (!list_empty(&opg->ops_lru)) {
 			__osc_lru_del(cli, opg);
 			atomic_long_inc(&cli->cl_lru_busy);
@@ -790,7 +801,12 @@ static int osc_lru_alloc(const struct lu_env *env, struct client_obd *cli,
 	}
 
 	LASSERT(atomic_long_read(cli->cl_lru_left) >= 0);
-	while (!atomic_long_add_unless(cli->cl_lru_left, -1, 0)) {
+	while (!cl_cache_lru_get(cli->cl_cache)) {
+		/* free slots may be stashed by other CPUs */
+		cl_cache_lru_drain(cli->cl_cache);
+		if (atomic_long_read(cli->cl_lru_left) > 0)
+			continue;
+
 		/* run out of LRU spaces, try to drop some by itself */
 		rc = osc_lru_reclaim(cli, 1);
 		if (rc < 0)
@@ -840,6 +856,11 @@ unsigned long osc_lru_reserve(struct client_obd *cli, unsigned long npages)
 
 again:
 	c = atomic_long_read(cli->cl_lru_left);
+	if (c < npages) {
+		/* free slots may be stashed by other CPUs */
+		cl_cache_lru_drain(cli->cl_cache);
+		c = atomic_long_read(cli->cl_lru_left);
+	}
 	if (c < npages && osc_lru_reclaim(cli, npages) > 0)
 		c = atomic_long_read(cli->cl_lru_left);
 
@@ -34,6 +34,9 @@
 #include <linux/workqueue.h>
 #include <libcfs/libcfs.h>
 #include <linux/falloc.h>
+#include <linux/vmalloc.h>
+#include <linux/lz4.h>
+#include <asm/unaligned.h>
 #include <lprocfs_status.h>
 #include <lustre_dlm.h>
 #include <lustre_fid.h>
@@ -1176,6 +1179,13 @@ static inline int can_merge_pages(struct brw_page *p1, struct brw_page *p2)
         return (p1->off + p1->count == p2->off);
 }
 
+/* pages of a multi-object write are grouped by object, see osc_build_rpc() */
+static inline bool brw_pages_same_obj(struct brw_page *p1,
+				      struct brw_page *p2)
+{
+	return brw_page2oap(p1)->oap_obj == brw_page2oap(p2)->oap_obj;
+}
+
 #if IS_ENABLED(CONFIG_CRC_T10DIF)
 static int osc_checksum_bulk_t10pi(const char *obd_name, int nob,
 				   size_t pg_count, struct brw_page **pga,
@@ -1493,8 +1503,121 @@ static inline void osc_release_bounce_pages(struct brw_page **pga,
 #endif
 }
 
+#if IS_ENABLED(CONFIG_LZ4_COMPRESS)
+/*
+ * Compress the @nob bytes of @pga in chunks of BRW_COMPR_CHUNK_SIZE into
+ * pages attached to @desc, see struct brw_compr_chunk for the format.
+ * Returns the compressed size, or 0 if the data should be sent as is
+ * because it does not save at least one page or memory is short.
+ */
+static int osc_brw_compress(struct ptlrpc_bulk_desc *desc, u32 page_count,
+			    struct brw_page **pga, int nob)
+{
+	int npages = DIV_ROUND_UP(nob, PAGE_SIZE);
+	struct page **pages;
+	char *dst, *src = NULL, *wrkmem = NULL, *ptr;
+	int len = 0, raw_len, clen, room, i = 0, j, off = 0, count;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(pages, npages);
+	if (pages == NULL)
+		return 0;
+
+	for (j = 0; j < npages; j++) {
+		pages[j] = alloc_page(GFP_NOFS);
+		if (pages[j] == NULL)
+			goto out_pages;
+	}
+
+	dst = vmap(pages, npages, VM_MAP, PAGE_KERNEL);
+	if (dst == NULL)
+		goto out_pages;
+
+	OBD_ALLOC_LARGE(src, BRW_COMPR_CHUNK_SIZE);
+	OBD_ALLOC_LARGE(wrkmem, LZ4_MEM_COMPRESS);
+	if (src == NULL || wrkmem == NULL)
+		goto out_free;
+
+	while (i < page_count) {
+		/* gather the next chunk of raw data */
+		for (raw_len = 0; raw_len < BRW_COMPR_CHUNK_SIZE &&
+		     i < page_count; raw_len += count) {
+			struct brw_page *pg = pga[i];
+
+			count = min_t(int, pg->count - off,
+				      BRW_COMPR_CHUNK_SIZE - raw_len);
+			ptr = kmap_atomic(pg->pg);
+			memcpy(src + raw_len,
+			       ptr + (pg->off & ~PAGE_MASK) + off, count);
+			kunmap_atomic(ptr);
+			off += count;
+			if (off == pg->count) {
+				i++;
+				off = 0;
+			}
+		}
+
+		room = nob - len - (int)sizeof(struct brw_compr_chunk);
+		if (room <= 0) {
+			len = 0;
+			goto out_free;
+		}
+		ptr = dst + len + sizeof(struct brw_compr_chunk);
+		clen = LZ4_compress_default(src, ptr, raw_len,
+					    min(raw_len - 1, room), wrkmem);
+		if (clen == 0) {
+			/* incompressible, store it raw if there is room */
+			if (raw_len > room) {
+				len = 0;
+				goto out_free;
+			}
+			memcpy(ptr, src, raw_len);
+			clen = raw_len;
+		}
+		put_unaligned_le32(raw_len, dst + len);
+		put_unaligned_le32(clen, dst + len + sizeof(__u32));
+		len += sizeof(struct brw_compr_chunk) + clen;
+	}
+
+	/* not worth it unless the bulk gets at least one page shorter */
+	if (DIV_ROUND_UP(len, PAGE_SIZE) >= npages) {
+		len = 0;
+		goto out_free;
+	}
+
+	for (j = 0, off = 0; off < len; j++, off += count) {
+		count = min_t(int, len - off, PAGE_SIZE);
+		desc->bd_frag_ops->add_kiov_frag(desc, pages[j], 0, count);
+	}
+out_free:
+	if (wrkmem != NULL)
+		OBD_FREE_LARGE(wrkmem, LZ4_MEM_COMPRESS);
+	if (src != NULL)
+		OBD_FREE_LARGE(src, BRW_COMPR_CHUNK_SIZE);
+	vunmap(dst);
+out_pages:
+	/* the desc holds its own reference on the pages in use */
+	for (j = 0; j < npages && pages[j] != NULL; j++)
+		put_page(pages[j]);
+	OBD_FREE_PTR_ARRAY_LARGE(pages, npages);
+	return len;
+}
+#else
+static inline int osc_brw_compress(struct ptlrpc_bulk_desc *desc,
+				   u32 page_count, struct brw_page **pga,
+				   int nob)
+{
+	return 0;
+}
+#endif
+
+/*
+ * A write of several objects carries the obdos of the second and following
+ * ones in \a obj_oa, \a obj_count objects in all, with their pages in \a pga
+ * grouped by object. It is only sent as short io.
+ */
 static int
 osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
+		     struct obdo *obj_oa, u32 obj_count,
 		     u32 page_count, struct brw_page **pga,
 		     struct ptlrpc_request **reqp, int resend)
 {
@@ -1502,8 +1625,11 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 	struct ptlrpc_bulk_desc *desc;
 	struct ost_body *body;
 	struct obd_ioobj *ioobj;
+	struct obdo *wire_oa;
 	struct niobuf_remote *niobuf;
 	int niocount, i, requested_nob, opc, rc, short_io_size = 0;
+	int nio_obj;
+	u32 obj;
 	struct osc_brw_async_args *aa;
 	struct req_capsule *pill;
 	struct brw_page *pg_prev;
@@ -1512,6 +1638,7 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 	struct inode *inode = NULL;
 	bool directio = false;
 	bool gpu = 0;
+	bool compress;
 	bool enable_checksum = true;
 	struct cl_page *clpage;
 
@@ -1526,6 +1653,10 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 		RETURN(-ENOMEM); /* Recoverable */
 	if (OBD_FAIL_CHECK(OBD_FAIL_OSC_BRW_PREP_REQ2))
 		RETURN(-EINVAL); /* Fatal */
+	if (obj_count > 1 && (!(cmd & OBD_BRW_WRITE) ||
+			      !imp_connect_shortio(cli->cl_import) ||
+			      !imp_connect_multiobj_brw(cli->cl_import)))
+		RETURN(-EINVAL);
 
 	if ((cmd & OBD_BRW_WRITE) != 0) {
 		opc = OST_WRITE;
@@ -1682,16 +1813,20 @@ retry_encrypt:
 		}
 	}
 
-        for (niocount = i = 1; i < page_count; i++) {
-                if (!can_merge_pages(pga[i - 1], pga[i]))
-                        niocount++;
-        }
+	for (niocount = i = 1; i < page_count; i++) {
+		if ((obj_count > 1 &&
+		     !brw_pages_same_obj(pga[i - 1], pga[i])) ||
+		    !can_merge_pages(pga[i - 1], pga[i]))
+			niocount++;
+	}
 
-        pill = &req->rq_pill;
-        req_capsule_set_size(pill, &RMF_OBD_IOOBJ, RCL_CLIENT,
-                             sizeof(*ioobj));
-        req_capsule_set_size(pill, &RMF_NIOBUF_REMOTE, RCL_CLIENT,
-                             niocount * sizeof(*niobuf));
+	pill = &req->rq_pill;
+	req_capsule_set_size(pill, &RMF_OBD_IOOBJ, RCL_CLIENT,
+			     obj_count * sizeof(*ioobj));
+	req_capsule_set_size(pill, &RMF_NIOBUF_REMOTE, RCL_CLIENT,
+			     niocount * sizeof(*niobuf));
+	req_capsule_set_size(pill, &RMF_OBD_IOOBJ_OA, RCL_CLIENT,
+			     (obj_count - 1) * sizeof(*wire_oa));
 
 	for (i = 0; i < page_count; i++) {
 		short_io_size += pga[i]->count;
@@ -1708,11 +1843,20 @@ retry_encrypt:
 		gpu = 1;
 	}
 
-	/* Check if read/write is small enough to be a short io. */
-	if (short_io_size > cli->cl_max_short_io_bytes || niocount > 1 ||
-	    !imp_connect_shortio(cli->cl_import))
+	/* Check if read/write is small enough to be a short io. A batch of
+	 * several objects was already sized for it by osc_write_batch_add() */
+	if (obj_count > 1)
+		LASSERT(short_io_size <= OST_MAX_SHORT_IO_BYTES);
+	else if (short_io_size > cli->cl_max_short_io_bytes ||
+		 niocount > 1 || !imp_connect_shortio(cli->cl_import))
 		short_io_size = 0;
 
+	/* Encrypted pages are not worth compressing */
+	compress = opc == OST_WRITE && short_io_size == 0 && !gpu &&
+		   cli->cl_brw_compress &&
+		   imp_connect_compress(cli->cl_import) &&
+		   !(inode && IS_ENCRYPTED(inode));
+
 	/* If this is an empty RPC to old server, just ignore it */
 	if (!short_io_size && !pga[0]->pg) {
 		ptlrpc_request_free(req);
@@ -1773,6 +1917,25 @@ no_bulk:
 
 	obdo_to_ioobj(oa, ioobj);
 	ioobj->ioo_bufcnt = niocount;
+	if (obj_count > 1) {
+		wire_oa = req_capsule_client_get(pill, &RMF_OBD_IOOBJ_OA);
+		LASSERT(wire_oa != NULL);
+		for (i = 0; i < obj_count - 1; i++) {
+			lustre_set_wire_obdo(&req->rq_import->imp_connect_data,
+					     &wire_oa[i], &obj_oa[i]);
+			wire_oa[i].o_uid = obj_oa[i].o_uid;
+			wire_oa[i].o_gid = obj_oa[i].o_gid;
+			obdo_to_ioobj(&obj_oa[i], &ioobj[i + 1]);
+			ioobj_max_brw_set(&ioobj[i + 1], 0);
+			if (resend) {
+				if (!(wire_oa[i].o_valid & OBD_MD_FLFLAGS)) {
+					wire_oa[i].o_valid |= OBD_MD_FLFLAGS;
+					wire_oa[i].o_flags = 0;
+				}
+				wire_oa[i].o_flags |= OBD_FL_RECOV_RESEND;
+			}
+		}
+	}
 	/* The high bits of ioo_max_brw tells server _maximum_ number of bulks
 	 * that might be send for this request.  The actual number is decided
 	 * when the RPC is finally sent in ptlrpc_register_bulk(). It sends
@@ -1810,20 +1973,25 @@ no_bulk:
 
 	LASSERT(page_count > 0);
 	pg_prev = pga[0];
+	obj = 0;
+	nio_obj = 0;
 	for (requested_nob = i = 0; i < page_count; i++, niobuf++) {
 		struct brw_page *pg = pga[i];
 		int poff = pg->off & ~PAGE_MASK;
+		bool new_obj = i > 0 && obj_count > 1 &&
+			       !brw_pages_same_obj(pg_prev, pg);
 
 		LASSERT(pg->count > 0);
-		/* make sure there is no gap in the middle of page array */
-		LASSERTF(page_count == 1 ||
+		/* make sure there is no gap in the middle of page array,
+		 * the objects of a short io write need no such care */
+		LASSERTF(page_count == 1 || obj_count > 1 ||
 			 (ergo(i == 0, poff + pg->count == PAGE_SIZE) &&
 			  ergo(i > 0 && i < page_count - 1,
 			       poff == 0 && pg->count == PAGE_SIZE)   &&
 			  ergo(i == page_count - 1, poff == 0)),
 			 "i: %d/%d pg: %px off: %llu, count: %u\n",
 			 i, page_count, pg, pg->off, pg->count);
-		LASSERTF(i == 0 || pg->off > pg_prev->off,
+		LASSERTF(i == 0 || new_obj || pg->off > pg_prev->off,
 			 "i %d p_c %u pg %px [pri %lu ind %lu] off %llu prev_pg %px [pri %lu ind %lu] off %llu\n",
 			 i, page_count,
 			 pg->pg, page_private(pg->pg), pg->pg->index, pg->off,
@@ -1839,22 +2007,29 @@ no_bulk:
 			       ptr + poff,
 			       pg->count);
 			kunmap_atomic(ptr);
-		} else if (short_io_size == 0) {
+		} else if (short_io_size == 0 && !compress) {
 			desc->bd_frag_ops->add_kiov_frag(desc, pg->pg, poff,
 							 pg->count);
 		}
 		requested_nob += pg->count;
 
-		if (i > 0 && can_merge_pages(pg_prev, pg)) {
+		if (new_obj) {
+			ioobj[obj++].ioo_bufcnt = nio_obj;
+			nio_obj = 0;
+		}
+		if (i > 0 && !new_obj && can_merge_pages(pg_prev, pg)) {
 			niobuf--;
 			niobuf->rnb_len += pg->count;
 		} else {
 			niobuf->rnb_offset = pg->off;
 			niobuf->rnb_len    = pg->count;
 			niobuf->rnb_flags  = pg->flag;
+			nio_obj++;
 		}
 		pg_prev = pg;
 	}
+	ioobj[obj].ioo_bufcnt = nio_obj;
+	LASSERT(obj == obj_count - 1);
 
 	LASSERTF((void *)(niobuf - niocount) ==
 		 req_capsule_client_get(&req->rq_pill, &RMF_NIOBUF_REMOTE),
@@ -1862,6 +2037,33 @@ no_bulk:
 		 req_capsule_client_get(&req->rq_pill, &RMF_NIOBUF_REMOTE),
 		 (void *)(niobuf - niocount));
 
+	if (compress) {
+		rc = osc_brw_compress(desc, page_count, pga, requested_nob);
+		if (rc > 0) {
+			struct osc_stats *stats;
+
+			CDEBUG(D_CACHE, "Compressed write bulk %d -> %d\n",
+			       requested_nob, rc);
+			stats = &obd2osc_dev(cli->cl_import->imp_obd)->osc_stats;
+			spin_lock(&cli->cl_loi_list_lock);
+			stats->os_compr_raw += requested_nob;
+			stats->os_compr_sent += rc;
+			spin_unlock(&cli->cl_loi_list_lock);
+			if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
+				body->oa.o_valid |= OBD_MD_FLFLAGS;
+				body->oa.o_flags = 0;
+			}
+			body->oa.o_flags |= OBD_FL_COMPRESSED;
+			body->oa.o_compr_len = rc;
+		} else {
+			for (i = 0; i < page_count; i++)
+				desc->bd_frag_ops->add_kiov_frag(desc,
+					pga[i]->pg, pga[i]->off & ~PAGE_MASK,
+					pga[i]->count);
+		}
+		rc = 0;
+	}
+
 	osc_announce_cached(cli, &body->oa, opc == OST_WRITE ? requested_nob:0);
 	if (resend) {
 		if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
@@ -1935,6 +2137,8 @@ no_bulk:
 
 	aa = ptlrpc_req_async_args(aa, req);
 	aa->aa_oa = oa;
+	aa->aa_obj_oa = obj_oa;
+	aa->aa_obj_count = obj_count;
 	aa->aa_requested_nob = requested_nob;
 	aa->aa_nio_count = niocount;
 	aa->aa_page_count = page_count;
@@ -2390,39 +2594,22 @@ out:
 	RETURN(rc);
 }
 
-static int osc_brw_redo_request(struct ptlrpc_request *request,
-				struct osc_brw_async_args *aa, int rc)
+/*
+ * Hand the oaps and extents of \a obj, or all of them if it is NULL, over
+ * from the resent \a request to \a new_req, and send it.
+ */
+static void osc_brw_redo_send(struct ptlrpc_request *request,
+			      struct osc_brw_async_args *aa,
+			      struct ptlrpc_request *new_req,
+			      struct osc_object *obj)
 {
-	struct ptlrpc_request *new_req;
 	struct osc_brw_async_args *new_aa;
 	struct osc_async_page *oap;
-	ENTRY;
-
-	/* The below message is checked in replay-ost-single.sh test_8ae*/
-	DEBUG_REQ(rc == -EINPROGRESS ? D_RPCTRACE : D_ERROR, request,
-		  "redo for recoverable error %d", rc);
-
-	rc = osc_brw_prep_request(lustre_msg_get_opc(request->rq_reqmsg) ==
-				OST_WRITE ? OBD_BRW_WRITE : OBD_BRW_READ,
-				  aa->aa_cli, aa->aa_oa, aa->aa_page_count,
-				  aa->aa_ppga, &new_req, 1);
-        if (rc)
-                RETURN(rc);
+	struct osc_async_page *tmp;
+	struct osc_extent *ext;
+	struct osc_extent *next;
 
-	list_for_each_entry(oap, &aa->aa_oaps, oap_rpc_item) {
-		if (oap->oap_request != NULL) {
-			LASSERTF(request == oap->oap_request,
-				 "request %px != oap_request %px\n",
-				 request, oap->oap_request);
-		}
-	}
-	/*
-	 * New request takes over pga and oaps from old request.
-	 * Note that copying a list_head doesn't work, need to move it...
-	 */
-	aa->aa_resends++;
 	new_req->rq_interpret_reply = request->rq_interpret_reply;
-	new_req->rq_async_args = request->rq_async_args;
 	new_req->rq_commit_cb = request->rq_commit_cb;
 	/* cap resend delay to the current request timeout, this is similar to
 	 * what ptlrpc does (see after_reply()) */
@@ -2430,23 +2617,40 @@ static int osc_brw_redo_request(struct ptlrpc_request *request,
 		new_req->rq_sent = ktime_get_real_seconds() + new_req->rq_timeout;
 	else
 		new_req->rq_sent = ktime_get_real_seconds() + aa->aa_resends;
-        new_req->rq_generation_set = 1;
-        new_req->rq_import_generation = request->rq_import_generation;
+	new_req->rq_generation_set = 1;
+	new_req->rq_import_generation = request->rq_import_generation;
 
+	/*
+	 * New request takes over oaps and extents from old request, its pga
+	 * and obdos were set up by osc_brw_prep_request().
+	 * Note that copying a list_head doesn't work, need to move it...
+	 */
 	new_aa = ptlrpc_req_async_args(new_aa, new_req);
-
+	new_aa->aa_resends = aa->aa_resends;
 	INIT_LIST_HEAD(&new_aa->aa_oaps);
-	list_splice_init(&aa->aa_oaps, &new_aa->aa_oaps);
 	INIT_LIST_HEAD(&new_aa->aa_exts);
-	list_splice_init(&aa->aa_exts, &new_aa->aa_exts);
-	new_aa->aa_resends = aa->aa_resends;
+	if (obj == NULL) {
+		list_splice_init(&aa->aa_oaps, &new_aa->aa_oaps);
+		list_splice_init(&aa->aa_exts, &new_aa->aa_exts);
+	} else {
+		list_for_each_entry_safe(oap, tmp, &aa->aa_oaps, oap_rpc_item) {
+			if (oap->oap_obj == obj)
+				list_move_tail(&oap->oap_rpc_item,
+					       &new_aa->aa_oaps);
+		}
+		list_for_each_entry_safe(ext, next, &aa->aa_exts, oe_link) {
+			if (ext->oe_obj == obj)
+				list_move_tail(&ext->oe_link,
+					       &new_aa->aa_exts);
+		}
+	}
 
 	list_for_each_entry(oap, &new_aa->aa_oaps, oap_rpc_item) {
-                if (oap->oap_request) {
-                        ptlrpc_req_finished(oap->oap_request);
-                        oap->oap_request = ptlrpc_request_addref(new_req);
-                }
-        }
+		if (oap->oap_request) {
+			ptlrpc_req_finished(oap->oap_request);
+			oap->oap_request = ptlrpc_request_addref(new_req);
+		}
+	}
 
 	/* XXX: This code will run into problem if we're going to support
 	 * to add a series of BRW RPCs into a self-defined ptlrpc_request_set
@@ -2455,6 +2659,140 @@ static int osc_brw_redo_request(struct ptlrpc_request *request,
 	ptlrpcd_add_req(new_req);
 
 	DEBUG_REQ(D_INFO, new_req, "new request");
+}
+
+/*
+ * A write of several objects can't be resent as is to a target which does
+ * not support OBD_CONNECT2_MULTIOBJ_BRW anymore, e.g. after failover to an
+ * older OST. Resend each object in an RPC of its own, all of them are
+ * prepared before any is sent, so that an error leaves \a aa untouched.
+ */
+static int osc_brw_redo_split(struct ptlrpc_request *request,
+			      struct osc_brw_async_args *aa)
+{
+	struct client_obd *cli = aa->aa_cli;
+	struct ptlrpc_request **reqs = NULL;
+	struct osc_brw_async_args *new_aa;
+	struct brw_page **pga;
+	struct obdo *oa;
+	u32 start = 0;
+	u32 k = 0;
+	u32 i;
+	int rc = 0;
+
+	ENTRY;
+	DEBUG_REQ(D_HA, request, "split write of %u objects for resend",
+		  aa->aa_obj_count);
+
+	OBD_ALLOC_PTR_ARRAY(reqs, aa->aa_obj_count);
+	if (reqs == NULL)
+		RETURN(-ENOMEM);
+
+	/* the pages are grouped by object, in the order of the obdos */
+	for (i = 1; i <= aa->aa_page_count; i++) {
+		if (i < aa->aa_page_count &&
+		    brw_pages_same_obj(aa->aa_ppga[i - 1], aa->aa_ppga[i]))
+			continue;
+
+		LASSERT(k < aa->aa_obj_count);
+		OBD_ALLOC_PTR_ARRAY_LARGE(pga, i - start);
+		if (pga == NULL)
+			GOTO(out, rc = -ENOMEM);
+
+		OBD_SLAB_ALLOC_PTR_GFP(oa, osc_obdo_kmem, GFP_NOFS);
+		if (oa == NULL) {
+			OBD_FREE_PTR_ARRAY_LARGE(pga, i - start);
+			GOTO(out, rc = -ENOMEM);
+		}
+
+		memcpy(pga, aa->aa_ppga + start, (i - start) * sizeof(*pga));
+		*oa = k == 0 ? *aa->aa_oa : aa->aa_obj_oa[k - 1];
+		rc = osc_brw_prep_request(OBD_BRW_WRITE, cli, oa, NULL, 1,
+					  i - start, pga, &reqs[k], 1);
+		if (rc) {
+			OBD_SLAB_FREE_PTR(oa, osc_obdo_kmem);
+			OBD_FREE_PTR_ARRAY_LARGE(pga, i - start);
+			GOTO(out, rc);
+		}
+		k++;
+		start = i;
+	}
+	LASSERT(k == aa->aa_obj_count);
+
+	/* the first request takes over the in-flight slot of the old one */
+	spin_lock(&cli->cl_loi_list_lock);
+	cli->cl_w_in_flight += k - 1;
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	for (i = 0; i < k; i++) {
+		new_aa = ptlrpc_req_async_args(new_aa, reqs[i]);
+		osc_brw_redo_send(request, aa, reqs[i],
+				  brw_page2oap(new_aa->aa_ppga[0])->oap_obj);
+	}
+	LASSERT(list_empty(&aa->aa_oaps));
+	LASSERT(list_empty(&aa->aa_exts));
+
+	/* the new requests own copies of the pga and obdos */
+	OBD_SLAB_FREE_PTR(aa->aa_oa, osc_obdo_kmem);
+	aa->aa_oa = NULL;
+	OBD_FREE_PTR_ARRAY(aa->aa_obj_oa, aa->aa_obj_count - 1);
+	aa->aa_obj_oa = NULL;
+	OBD_FREE_PTR_ARRAY_LARGE(aa->aa_ppga, aa->aa_page_count);
+	aa->aa_ppga = NULL;
+	EXIT;
+out:
+	if (rc) {
+		while (k-- > 0) {
+			new_aa = ptlrpc_req_async_args(new_aa, reqs[k]);
+			osc_release_bounce_pages(new_aa->aa_ppga,
+						 new_aa->aa_page_count);
+			OBD_SLAB_FREE_PTR(new_aa->aa_oa, osc_obdo_kmem);
+			OBD_FREE_PTR_ARRAY_LARGE(new_aa->aa_ppga,
+						 new_aa->aa_page_count);
+			ptlrpc_req_finished(reqs[k]);
+		}
+	}
+	OBD_FREE_PTR_ARRAY(reqs, aa->aa_obj_count);
+	return rc;
+}
+
+static int osc_brw_redo_request(struct ptlrpc_request *request,
+				struct osc_brw_async_args *aa, int rc)
+{
+	struct obd_import *imp = aa->aa_cli->cl_import;
+	struct ptlrpc_request *new_req;
+	struct osc_async_page *oap;
+	ENTRY;
+
+	/* The below message is checked in replay-ost-single.sh test_8ae*/
+	DEBUG_REQ(rc == -EINPROGRESS ? D_RPCTRACE : D_ERROR, request,
+		  "redo for recoverable error %d", rc);
+
+	list_for_each_entry(oap, &aa->aa_oaps, oap_rpc_item) {
+		if (oap->oap_request != NULL) {
+			LASSERTF(request == oap->oap_request,
+				 "request %px != oap_request %px\n",
+				 request, oap->oap_request);
+		}
+	}
+
+	aa->aa_resends++;
+	if (aa->aa_obj_count > 1 &&
+	    (OBD_FAIL_CHECK(OBD_FAIL_OSC_NO_MULTIOBJ_BRW) ||
+	     !imp_connect_shortio(imp) || !imp_connect_multiobj_brw(imp))) {
+		rc = osc_brw_redo_split(request, aa);
+		RETURN(rc);
+	}
+
+	rc = osc_brw_prep_request(lustre_msg_get_opc(request->rq_reqmsg) ==
+				OST_WRITE ? OBD_BRW_WRITE : OBD_BRW_READ,
+				  aa->aa_cli, aa->aa_oa, aa->aa_obj_oa,
+				  aa->aa_obj_count, aa->aa_page_count,
+				  aa->aa_ppga, &new_req, 1);
+	if (rc)
+		RETURN(rc);
+
+	osc_brw_redo_send(request, aa, new_req, NULL);
 	RETURN(0);
 }
 
@@ -2495,6 +2833,61 @@ static void osc_release_ppga(struct brw_page **ppga, size_t count)
 	OBD_FREE_PTR_ARRAY_LARGE(ppga, count);
 }
 
+/*
+ * Update the attributes of the object of page \a last, the last one of this
+ * object in the RPC, after a successful I/O. The attributes returned by the
+ * OST in \a oa are only used if not NULL.
+ */
+static void brw_update_attr(const struct lu_env *env,
+			    struct ptlrpc_request *req, struct obdo *oa,
+			    struct osc_async_page *last)
+{
+	struct cl_object *obj = osc2cl(last->oap_obj);
+	struct cl_attr *attr = &osc_env_info(env)->oti_attr;
+	unsigned long valid = 0;
+
+	cl_object_attr_lock(obj);
+	if (oa != NULL && oa->o_valid & OBD_MD_FLBLOCKS) {
+		attr->cat_blocks = oa->o_blocks;
+		valid |= CAT_BLOCKS;
+	}
+	if (oa != NULL && oa->o_valid & OBD_MD_FLMTIME) {
+		attr->cat_mtime = oa->o_mtime;
+		valid |= CAT_MTIME;
+	}
+	if (oa != NULL && oa->o_valid & OBD_MD_FLATIME) {
+		attr->cat_atime = oa->o_atime;
+		valid |= CAT_ATIME;
+	}
+	if (oa != NULL && oa->o_valid & OBD_MD_FLCTIME) {
+		attr->cat_ctime = oa->o_ctime;
+		valid |= CAT_CTIME;
+	}
+
+	if (lustre_msg_get_opc(req->rq_reqmsg) == OST_WRITE) {
+		struct lov_oinfo *loi = cl2osc(obj)->oo_oinfo;
+		loff_t last_off = last->oap_count + last->oap_obj_off +
+			last->oap_page_off;
+
+		/* Change file size if this is an out of quota or
+		 * direct IO write and it extends the file size */
+		if (loi->loi_lvb.lvb_size < last_off) {
+			attr->cat_size = last_off;
+			valid |= CAT_SIZE;
+		}
+		/* Extend KMS if it's not a lockless write */
+		if (loi->loi_kms < last_off &&
+		    oap2osc_page(last)->ops_srvlock == 0) {
+			attr->cat_kms = last_off;
+			valid |= CAT_KMS;
+		}
+	}
+
+	if (valid != 0)
+		cl_object_attr_update(env, obj, attr, valid);
+	cl_object_attr_unlock(obj);
+}
+
 static int brw_interpret(const struct lu_env *env,
 			 struct ptlrpc_request *req, void *args, int rc)
 {
@@ -2503,7 +2896,8 @@ static int brw_interpret(const struct lu_env *env,
 	struct osc_extent *tmp;
 	struct client_obd *cli = aa->aa_cli;
 	unsigned long transferred = 0;
-	struct cl_object *obj = NULL;
+	struct cl_object *obj;
+	int i;
 
 	ENTRY;
 
@@ -2541,57 +2935,25 @@ static int brw_interpret(const struct lu_env *env,
 	}
 
 	if (rc == 0) {
-		struct obdo *oa = aa->aa_oa;
-		struct cl_attr *attr = &osc_env_info(env)->oti_attr;
-		unsigned long valid = 0;
-		struct osc_async_page *last;
-
-		last = brw_page2oap(aa->aa_ppga[aa->aa_page_count - 1]);
-		obj = osc2cl(last->oap_obj);
-
-		cl_object_attr_lock(obj);
-		if (oa->o_valid & OBD_MD_FLBLOCKS) {
-			attr->cat_blocks = oa->o_blocks;
-			valid |= CAT_BLOCKS;
-		}
-		if (oa->o_valid & OBD_MD_FLMTIME) {
-			attr->cat_mtime = oa->o_mtime;
-			valid |= CAT_MTIME;
-		}
-		if (oa->o_valid & OBD_MD_FLATIME) {
-			attr->cat_atime = oa->o_atime;
-			valid |= CAT_ATIME;
-		}
-		if (oa->o_valid & OBD_MD_FLCTIME) {
-			attr->cat_ctime = oa->o_ctime;
-			valid |= CAT_CTIME;
-		}
-
-		if (lustre_msg_get_opc(req->rq_reqmsg) == OST_WRITE) {
-			struct lov_oinfo *loi = cl2osc(obj)->oo_oinfo;
-			loff_t last_off = last->oap_count + last->oap_obj_off +
-				last->oap_page_off;
-
-			/* Change file size if this is an out of quota or
-			 * direct IO write and it extends the file size */
-			if (loi->loi_lvb.lvb_size < last_off) {
-				attr->cat_size = last_off;
-				valid |= CAT_SIZE;
-			}
-			/* Extend KMS if it's not a lockless write */
-			if (loi->loi_kms < last_off &&
-			    oap2osc_page(last)->ops_srvlock == 0) {
-				attr->cat_kms = last_off;
-				valid |= CAT_KMS;
-			}
+		/* the pages are grouped by object, update each object with
+		 * the last of its pages, and with the returned attributes if
+		 * it is the only one */
+		for (i = 0; i < aa->aa_page_count; i++) {
+			if (i < aa->aa_page_count - 1 &&
+			    brw_pages_same_obj(aa->aa_ppga[i],
+					       aa->aa_ppga[i + 1]))
+				continue;
+			brw_update_attr(env, req,
+					aa->aa_obj_count > 1 ? NULL : aa->aa_oa,
+					brw_page2oap(aa->aa_ppga[i]));
 		}
-
-		if (valid != 0)
-			cl_object_attr_update(env, obj, attr, valid);
-		cl_object_attr_unlock(obj);
 	}
 	OBD_SLAB_FREE_PTR(aa->aa_oa, osc_obdo_kmem);
 	aa->aa_oa = NULL;
+	if (aa->aa_obj_oa != NULL) {
+		OBD_FREE_PTR_ARRAY(aa->aa_obj_oa, aa->aa_obj_count - 1);
+		aa->aa_obj_oa = NULL;
+	}
 
 	if (lustre_msg_get_opc(req->rq_reqmsg) == OST_WRITE && rc == 0) {
 		osc_inc_unstable_pages(req);
@@ -2600,8 +2962,14 @@ static int brw_interpret(const struct lu_env *env,
 		 * have already committed into the stable storage on OSTs
 		 * (i.e. Direct I/O).
 		 */
-		if (!req->rq_committed)
+		for (i = 0; !req->rq_committed && i < aa->aa_page_count; i++) {
+			if (i < aa->aa_page_count - 1 &&
+			    brw_pages_same_obj(aa->aa_ppga[i],
+					       aa->aa_ppga[i + 1]))
+				continue;
+			obj = osc2cl(brw_page2oap(aa->aa_ppga[i])->oap_obj);
 			cl_object_dirty_for_sync(env, cl_object_top(obj));
+		}
 	}
 
 	list_for_each_entry_safe(ext, tmp, &aa->aa_exts, oe_link) {
@@ -2652,10 +3020,53 @@ static void brw_commit(struct ptlrpc_request *req)
 	}
 }
 
+/*
+ * Fill @oa for the object of @ext, from @ext and the following extents of the
+ * same object in @ext_list.
+ */
+static void osc_brw_attr_set(const struct lu_env *env, int cmd,
+			     struct list_head *ext_list, struct osc_extent *ext,
+			     struct obdo *oa)
+{
+	struct cl_req_attr *crattr = &osc_env_info(env)->oti_req_attr;
+	struct osc_object *obj = ext->oe_obj;
+	__u32 layout_version = 0;
+	int grant = 0;
+
+	memset(crattr, 0, sizeof(*crattr));
+	crattr->cra_type = (cmd & OBD_BRW_WRITE) ? CRT_WRITE : CRT_READ;
+	crattr->cra_flags = ~0ULL;
+	crattr->cra_page = oap2cl_page(list_first_entry(&ext->oe_pages,
+							struct osc_async_page,
+							oap_pending_item));
+	crattr->cra_oa = oa;
+	cl_req_attr_set(env, osc2cl(obj), crattr);
+
+	if (cmd != OBD_BRW_WRITE)
+		return;
+
+	list_for_each_entry_from(ext, ext_list, oe_link) {
+		if (ext->oe_obj != obj)
+			break;
+		grant += ext->oe_grants;
+		layout_version = max(layout_version, ext->oe_layout_version);
+	}
+
+	oa->o_grant_used = grant;
+	if (layout_version > 0) {
+		CDEBUG(D_LAYOUT, DFID": write with layout version %u\n",
+		       PFID(&oa->o_oi.oi_fid), layout_version);
+
+		oa->o_layout_version = layout_version;
+		oa->o_valid |= OBD_MD_LAYOUT_VERSION;
+	}
+}
+
 /**
  * Build an RPC by the list of extent @ext_list. The caller must ensure
  * that the total pages in this list are NOT over max pages per RPC.
- * Extents in the list must be in OES_RPC state.
+ * Extents in the list must be in OES_RPC state. The extents of a write may
+ * belong to several objects, grouped by object, if they fit in a short io.
  */
 int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		  struct list_head *ext_list, int cmd)
@@ -2665,21 +3076,24 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	struct brw_page			**pga = NULL;
 	struct osc_brw_async_args	*aa = NULL;
 	struct obdo			*oa = NULL;
+	struct obdo			*obj_oa = NULL;
+	struct obdo			*wire_oa;
 	struct osc_async_page		*oap;
 	struct osc_object		*obj = NULL;
 	struct cl_req_attr		*crattr = NULL;
 	loff_t				starting_offset = OBD_OBJECT_EOF;
 	loff_t				ending_offset = 0;
+	loff_t				first_offset = 0;
 	/* '1' for consistency with code that checks !mpflag to restore */
 	int mpflag = 1;
 	int				mem_tight = 0;
 	int				page_count = 0;
 	bool				soft_sync = false;
 	bool				ndelay = false;
-	int				i;
-	int				grant = 0;
+	int				i, j;
 	int				rc;
-	__u32				layout_version = 0;
+	u32				obj_count = 0;
+	u32				k = 0;
 	LIST_HEAD(rpc_list);
 	struct ost_body			*body;
 	ENTRY;
@@ -2689,11 +3103,11 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	list_for_each_entry(ext, ext_list, oe_link) {
 		LASSERT(ext->oe_state == OES_RPC);
 		mem_tight |= ext->oe_memalloc;
-		grant += ext->oe_grants;
 		page_count += ext->oe_nr_pages;
-		layout_version = max(layout_version, ext->oe_layout_version);
-		if (obj == NULL)
+		if (ext->oe_obj != obj) {
 			obj = ext->oe_obj;
+			obj_count++;
+		}
 	}
 
 	soft_sync = osc_over_unstable_soft_limit(cli);
@@ -2708,8 +3122,29 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	if (oa == NULL)
 		GOTO(out, rc = -ENOMEM);
 
-	i = 0;
+	if (obj_count > 1) {
+		OBD_ALLOC_PTR_ARRAY(obj_oa, obj_count - 1);
+		if (obj_oa == NULL)
+			GOTO(out, rc = -ENOMEM);
+	}
+
+	/* fill the attributes and sort the pages of each object, only the
+	 * first one is accounted in the offset histogram */
+	i = j = 0;
+	obj = NULL;
 	list_for_each_entry(ext, ext_list, oe_link) {
+		if (ext->oe_obj != obj) {
+			if (obj != NULL)
+				sort_brw_pages(pga + j, i - j);
+			osc_brw_attr_set(env, cmd, ext_list, ext,
+					 k == 0 ? oa : &obj_oa[k - 1]);
+			obj = ext->oe_obj;
+			if (k++ == 1)
+				first_offset = starting_offset;
+			starting_offset = OBD_OBJECT_EOF;
+			ending_offset = 0;
+			j = i;
+		}
 		list_for_each_entry(oap, &ext->oe_pages, oap_pending_item) {
 			if (mem_tight)
 				oap->oap_brw_flags |= OBD_BRW_MEMALLOC;
@@ -2735,31 +3170,15 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		if (ext->oe_ndelay)
 			ndelay = true;
 	}
+	sort_brw_pages(pga + j, i - j);
+	if (k > 1)
+		starting_offset = first_offset;
 
 	/* first page in the list */
 	oap = list_first_entry(&rpc_list, typeof(*oap), oap_rpc_item);
 
-	crattr = &osc_env_info(env)->oti_req_attr;
-	memset(crattr, 0, sizeof(*crattr));
-	crattr->cra_type = (cmd & OBD_BRW_WRITE) ? CRT_WRITE : CRT_READ;
-	crattr->cra_flags = ~0ULL;
-	crattr->cra_page = oap2cl_page(oap);
-	crattr->cra_oa = oa;
-	cl_req_attr_set(env, osc2cl(obj), crattr);
-
-	if (cmd == OBD_BRW_WRITE) {
-		oa->o_grant_used = grant;
-		if (layout_version > 0) {
-			CDEBUG(D_LAYOUT, DFID": write with layout version %u\n",
-			       PFID(&oa->o_oi.oi_fid), layout_version);
-
-			oa->o_layout_version = layout_version;
-			oa->o_valid |= OBD_MD_LAYOUT_VERSION;
-		}
-	}
-
-	sort_brw_pages(pga, page_count);
-	rc = osc_brw_prep_request(cmd, cli, oa, page_count, pga, &req, 0);
+	rc = osc_brw_prep_request(cmd, cli, oa, obj_oa, obj_count, page_count,
+				  pga, &req, 0);
 	if (rc != 0) {
 		CERROR("prep_req failed: %d\n", rc);
 		GOTO(out, rc);
@@ -2782,10 +3201,25 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	 * the OST will not use BRW timestamps.  Sadly, there is no obvious
 	 * way to do this in a single call.  bug 10150 */
 	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
-	crattr->cra_oa = &body->oa;
-	crattr->cra_flags = OBD_MD_FLMTIME | OBD_MD_FLCTIME | OBD_MD_FLATIME;
-	cl_req_attr_set(env, osc2cl(obj), crattr);
-	lustre_msg_set_jobid(req->rq_reqmsg, crattr->cra_jobid);
+	wire_oa = req_capsule_client_get(&req->rq_pill, &RMF_OBD_IOOBJ_OA);
+	crattr = &osc_env_info(env)->oti_req_attr;
+	k = 0;
+	obj = NULL;
+	list_for_each_entry(ext, ext_list, oe_link) {
+		if (ext->oe_obj == obj)
+			continue;
+		obj = ext->oe_obj;
+		crattr->cra_oa = k == 0 ? &body->oa : &wire_oa[k - 1];
+		crattr->cra_flags = OBD_MD_FLMTIME | OBD_MD_FLCTIME |
+				    OBD_MD_FLATIME;
+		crattr->cra_page = oap2cl_page(list_first_entry(&ext->oe_pages,
+							struct osc_async_page,
+							oap_pending_item));
+		cl_req_attr_set(env, osc2cl(obj), crattr);
+		if (k++ == 0)
+			lustre_msg_set_jobid(req->rq_reqmsg,
+					     crattr->cra_jobid);
+	}
 
 	aa = ptlrpc_req_async_args(aa, req);
 	INIT_LIST_HEAD(&aa->aa_oaps);
@@ -2828,6 +3262,8 @@ out:
 
 		if (oa)
 			OBD_SLAB_FREE_PTR(oa, osc_obdo_kmem);
+		if (obj_oa)
+			OBD_FREE_PTR_ARRAY(obj_oa, obj_count - 1);
 		if (pga) {
 			osc_release_bounce_pages(pga, page_count);
 			osc_release_ppga(pga, page_count);
@@ -2860,8 +3296,8 @@ void osc_send_empty_rpc(struct osc_object *osc, pgoff_t start)
 	/* For updated servers - don't do a read */
 	oa.o_flags = OBD_FL_NORPC;
 
-	rc = osc_brw_prep_request(OBD_BRW_READ, osc_cli(osc), &oa, 1, &pga,
-				  &req, 0);
+	rc = osc_brw_prep_request(OBD_BRW_READ, osc_cli(osc), &oa, NULL, 1, 1,
+				  &pga, &req, 0);
 
 	/* If we succeeded we ship it off, if not there's no point in doing
 	 * anything. Also no resends.
@@ -3687,6 +4123,11 @@ int osc_setup_common(struct obd_device *obd, struct lustre_cfg *lcfg)
 		GOTO(out_ptlrpcd_work, rc = PTR_ERR(handler));
 	cli->cl_lru_work = handler;
 
+	OBD_ALLOC_PTR_ARRAY(cli->cl_job_slots, OSC_JOB_SLOTS);
+	if (cli->cl_job_slots == NULL)
+		GOTO(out_ptlrpcd_work, rc = -ENOMEM);
+	cli->cl_job_stats_init = ktime_get_real();
+
 	rc = osc_quota_setup(obd);
 	if (rc)
 		GOTO(out_ptlrpcd_work, rc);
@@ -3698,6 +4139,10 @@ int osc_setup_common(struct obd_device *obd, struct lustre_cfg *lcfg)
 	RETURN(rc);
 
 out_ptlrpcd_work:
+	if (cli->cl_job_slots != NULL) {
+		OBD_FREE_PTR_ARRAY(cli->cl_job_slots, OSC_JOB_SLOTS);
+		cli->cl_job_slots = NULL;
+	}
 	if (cli->cl_writeback_work != NULL) {
 		ptlrpcd_destroy_work(cli->cl_writeback_work);
 		cli->cl_writeback_work = NULL;
@@ -3822,6 +4267,11 @@ int osc_cleanup_common(struct obd_device *obd)
 	/* free memory of osc quota cache */
 	osc_quota_cleanup(obd);
 
+	if (cli->cl_job_slots != NULL) {
+		OBD_FREE_PTR_ARRAY(cli->cl_job_slots, OSC_JOB_SLOTS);
+		cli->cl_job_slots = NULL;
+	}
+
 	rc = client_obd_cleanup(obd);
 
 	ptlrpcd_decref();
@@ -3693,6 +3693,7 @@ void *ptlrpcd_alloc_work(struct obd_import *imp,
 	req->rq_interpret_reply = work_interpreter;
 	/* don't want reply */
 	req->rq_no_delay = req->rq_no_resend = 1;
+	req->rq_import_affinity = 1;
 	req->rq_pill.rc_fmt = (void *)&worker_format;
 
 	args = ptlrpc_req_async_args(args, req);
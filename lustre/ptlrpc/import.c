@@ -38,6 +38,7 @@
 #include <linux/fs_struct.h>
 #include <linux/kthread.h>
 #include <linux/delay.h>
+#include <lnet/lib-lnet.h>
 #include <obd_support.h>
 #include <lustre_ha.h>
 #include <lustre_net.h>
@@ -566,6 +567,8 @@ static int import_select_connection(struct obd_import *imp)
 	/* switch connection, don't mind if it's same as the current one */
 	ptlrpc_connection_put(imp->imp_connection);
 	imp->imp_connection = ptlrpc_connection_addref(imp_conn->oic_conn);
+	WRITE_ONCE(imp->imp_cpt,
+		   lnet_nid2cpt(&imp_conn->oic_conn->c_peer.nid, NULL));
 
 	dlmexp = class_conn2export(&imp->imp_dlm_handle);
 	if (!dlmexp)
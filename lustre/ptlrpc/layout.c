@@ -642,7 +642,8 @@ static const struct req_msg_field *ost_brw_client[] = {
 	&RMF_OBD_IOOBJ,
 	&RMF_NIOBUF_REMOTE,
 	&RMF_CAPA1,
-	&RMF_SHORT_IO
+	&RMF_SHORT_IO,
+	&RMF_OBD_IOOBJ_OA
 };
 
 static const struct req_msg_field *ost_brw_read_server[] = {
@@ -1194,6 +1195,12 @@ struct req_msg_field RMF_OBD_IOOBJ =
                     sizeof(struct obd_ioobj), lustre_swab_obd_ioobj, dump_ioo);
 EXPORT_SYMBOL(RMF_OBD_IOOBJ);
 
+/* obdos of the second and following objects of a multi-object write */
+struct req_msg_field RMF_OBD_IOOBJ_OA =
+	DEFINE_MSGF("obd_ioobj_oa", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct obdo), lustre_swab_obdo, NULL);
+EXPORT_SYMBOL(RMF_OBD_IOOBJ_OA);
+
 struct req_msg_field RMF_NIOBUF_REMOTE =
         DEFINE_MSGF("niobuf_remote", RMF_F_STRUCT_ARRAY,
                     sizeof(struct niobuf_remote), lustre_swab_niobuf_remote,
@@ -235,6 +235,8 @@ ptlrpc_ldebugfs_register(struct dentry *root, char *dir, char *name,
 			     svc_counter_config, "req_timeout", "sec");
 	lprocfs_counter_init(svc_stats, PTLRPC_REQBUF_AVAIL_CNTR,
 			     svc_counter_config, "reqbuf_avail", "bufs");
+	lprocfs_counter_init(svc_stats, PTLRPC_REPPOOL_CNTR,
+			     LPROCFS_CNTR_AVGMINMAX, "reply_pool_alloc", "reqs");
 	for (i = 0; i < EXTRA_LAST_OPC; i++) {
 		char *units;
 
@@ -477,6 +479,40 @@ static ssize_t threads_max_store(struct kobject *kobj, struct attribute *attr,
 }
 LUSTRE_RW_ATTR(threads_max);
 
+static ssize_t threads_target_wait_us_show(struct kobject *kobj,
+					   struct attribute *attr, char *buf)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+
+	return sprintf(buf, "%d\n", svc->srv_thr_target_wait);
+}
+
+static ssize_t threads_target_wait_us_store(struct kobject *kobj,
+					    struct attribute *attr,
+					    const char *buffer, size_t count)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+	unsigned long val;
+	int rc;
+
+	rc = kstrtoul(buffer, 10, &val);
+	if (rc < 0)
+		return rc;
+
+	/* a request waiting longer than obd_timeout is long expired */
+	if (val > obd_timeout * USEC_PER_SEC)
+		return -ERANGE;
+
+	spin_lock(&svc->srv_lock);
+	svc->srv_thr_target_wait = val;
+	spin_unlock(&svc->srv_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(threads_target_wait_us);
+
 /**
  * Translates \e ptlrpc_nrs_pol_state values to human-readable strings.
  *
@@ -1144,6 +1180,33 @@ static int ptlrpc_lprocfs_timeouts_seq_show(struct seq_file *m, void *n)
 
 LDEBUGFS_SEQ_FOPS_RO(ptlrpc_lprocfs_timeouts);
 
+/*
+ * Shows the decisions of the thread scaling of each service partition, with
+ * the queue wait and thread usage of the last interval they were based on.
+ */
+static int ptlrpc_lprocfs_threads_scaling_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service *svc = m->private;
+	struct ptlrpc_service_part *svcpt;
+	int i;
+
+	seq_printf(m, "target_wait_us: %d\n", svc->srv_thr_target_wait);
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		seq_printf(m, "- cpt: %d\n", svcpt->scp_cpt);
+		seq_printf(m, "  wait_us: %u\n", svcpt->scp_thr_wait_avg);
+		seq_printf(m, "  busy_pct: %u\n", svcpt->scp_thr_busy_avg);
+		seq_printf(m, "  threads_running: %d\n",
+			   svcpt->scp_nthrs_running);
+		seq_printf(m, "  threads_wanted: %d\n", svcpt->scp_nthrs_want);
+		seq_printf(m, "  grown: %llu\n", svcpt->scp_thr_grown);
+		seq_printf(m, "  shrunk: %llu\n", svcpt->scp_thr_shrunk);
+	}
+
+	return 0;
+}
+
+LDEBUGFS_SEQ_FOPS_RO(ptlrpc_lprocfs_threads_scaling);
+
 static ssize_t high_priority_ratio_show(struct kobject *kobj,
 					struct attribute *attr,
 					char *buf)
@@ -1176,11 +1239,73 @@ static ssize_t high_priority_ratio_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(high_priority_ratio);
 
+static ssize_t req_batch_show(struct kobject *kobj, struct attribute *attr,
+			      char *buf)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+
+	return sprintf(buf, "%d\n", svc->srv_req_batch);
+}
+
+static ssize_t req_batch_store(struct kobject *kobj, struct attribute *attr,
+			       const char *buffer, size_t count)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+	unsigned long val;
+	int rc;
+
+	rc = kstrtoul(buffer, 10, &val);
+	if (rc < 0)
+		return rc;
+
+	if (val < 1 || val > PTLRPC_SVC_REQ_BATCH_MAX)
+		return -ERANGE;
+
+	spin_lock(&svc->srv_lock);
+	svc->srv_req_batch = val;
+	spin_unlock(&svc->srv_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(req_batch);
+
+static ssize_t reply_pool_show(struct kobject *kobj, struct attribute *attr,
+			       char *buf)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+
+	return sprintf(buf, "%d\n", svc->srv_rep_pool);
+}
+
+static ssize_t reply_pool_store(struct kobject *kobj, struct attribute *attr,
+				const char *buffer, size_t count)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc < 0)
+		return rc;
+
+	svc->srv_rep_pool = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(reply_pool);
+
 static struct attribute *ptlrpc_svc_attrs[] = {
 	&lustre_attr_threads_min.attr,
 	&lustre_attr_threads_started.attr,
 	&lustre_attr_threads_max.attr,
+	&lustre_attr_threads_target_wait_us.attr,
 	&lustre_attr_high_priority_ratio.attr,
+	&lustre_attr_req_batch.attr,
+	&lustre_attr_reply_pool.attr,
 	NULL,
 };
 
@@ -1237,6 +1362,9 @@ void ptlrpc_ldebugfs_register_service(struct dentry *entry,
 		{ .name = "req_buffers_max",
 		  .fops = &ptlrpc_lprocfs_req_buffers_max_fops,
 		  .data = svc },
+		{ .name = "threads_scaling",
+		  .fops = &ptlrpc_lprocfs_threads_scaling_fops,
+		  .data = svc },
 		{ NULL }
 	};
 	static const struct file_operations req_history_fops = {
@@ -1450,6 +1450,42 @@ void ptlrpc_nrs_req_stop_nolock(struct ptlrpc_request *req)
 		nrs_request_stop(&req->rq_nrq);
 }
 
+/**
+ * Enqueues the requests on list \a reqs, linked through rq_list, on either the
+ * regular or high-priority NRS head of service partition \a svcpt, taking
+ * ptlrpc_service_part::scp_req_lock once for the whole list.
+ *
+ * \param[in] svcpt the service partition
+ * \param[in] reqs  the requests to be enqueued; emptied on return
+ * \param[in] hp    whether to enqueue the requests on the regular or
+ *		    high-priority NRS head.
+ *
+ * \retval the number of requests enqueued
+ */
+int ptlrpc_nrs_req_add_batch(struct ptlrpc_service_part *svcpt,
+			     struct list_head *reqs, bool hp)
+{
+	struct ptlrpc_request *req;
+	int count = 0;
+
+	if (list_empty(reqs))
+		return 0;
+
+	spin_lock(&svcpt->scp_req_lock);
+	while ((req = list_first_entry_or_null(reqs, struct ptlrpc_request,
+					       rq_list)) != NULL) {
+		list_del_init(&req->rq_list);
+		if (hp)
+			ptlrpc_nrs_hpreq_add_nolock(req);
+		else
+			ptlrpc_nrs_req_add_nolock(req);
+		count++;
+	}
+	spin_unlock(&svcpt->scp_req_lock);
+
+	return count;
+}
+
 /**
  * Enqueues request \a req on either the regular or high-priority NRS head
  * of service partition \a svcpt.
@@ -1749,6 +1785,10 @@ int ptlrpc_nrs_init(void)
 	rc = ptlrpc_nrs_policy_register(&nrs_conf_tbf);
 	if (rc != 0)
 		GOTO(fail, rc);
+
+	rc = ptlrpc_nrs_policy_register(&nrs_conf_drr);
+	if (rc != 0)
+		GOTO(fail, rc);
 #endif /* HAVE_SERVER_SUPPORT */
 
 	rc = ptlrpc_nrs_policy_register(&nrs_conf_delay);
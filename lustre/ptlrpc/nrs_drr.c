@@ -0,0 +1,903 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.  A copy is
+ * included in the COPYING file that accompanied this code.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * GPL HEADER END
+ */
+/*
+ * lustre/ptlrpc/nrs_drr.c
+ *
+ * Network Request Scheduler (NRS) DRR policy
+ *
+ * Weighted fair sharing of service thread time between exports, JobIDs,
+ * UIDs or GIDs, using Deficit Round Robin
+ */
+/**
+ * \addtogoup nrs
+ * @{
+ */
+
+#define DEBUG_SUBSYSTEM S_RPC
+#include <obd_support.h>
+#include <obd_class.h>
+#include <lustre_net.h>
+#include <lprocfs_status.h>
+#include "ptlrpc_internal.h"
+
+/**
+ * \name DRR policy
+ *
+ * Deficit Round Robin over classes of requests
+ *
+ * Each class is given a quantum of service thread time per round, in
+ * proportion to its weight. A request is charged the average service time of
+ * its class when it is handed to a service thread, and the difference to the
+ * time it actually took when it is finished, so a class sending expensive
+ * requests, such as large BRWs, is served less often than one sending cheap
+ * ones. Service time includes the bulk transfer, which the service thread
+ * waits for.
+ *
+ * @{
+ */
+
+#define NRS_POL_NAME_DRR	"drr"
+
+static const char *const nrs_drr_type_names[] = {
+	[NRS_DRR_EXPORT]	= "export",
+	[NRS_DRR_JOBID]		= "jobid",
+	[NRS_DRR_UID]		= "uid",
+	[NRS_DRR_GID]		= "gid",
+};
+
+/**
+ * rhashtable operations for nrs_drr_head::dh_cli_hash
+ *
+ * The class id is zero padded to NRS_DRR_ID_LEN, so it can be hashed and
+ * compared as a fixed length key.
+ */
+static const struct rhashtable_params nrs_drr_hash_params = {
+	.key_len	= NRS_DRR_ID_LEN,
+	.key_offset	= offsetof(struct nrs_drr_class, dc_id),
+	.head_offset	= offsetof(struct nrs_drr_class, dc_rhead),
+};
+
+static void nrs_drr_exit(void *vcli, void *data)
+{
+	struct nrs_drr_class *cli = vcli;
+
+	LASSERTF(atomic_read(&cli->dc_ref) == 0,
+		 "Busy DRR class %s, with %d refs\n",
+		 cli->dc_id, atomic_read(&cli->dc_ref));
+
+	OBD_FREE_PTR(cli);
+}
+
+/**
+ * Called when a DRR policy instance is started.
+ *
+ * \param[in] policy the policy
+ * \param[in] arg    what to classify requests by: "export" (default),
+ *		     "jobid", "uid" or "gid"
+ *
+ * \retval -ENOMEM OOM error
+ * \retval -EINVAL unknown classification
+ * \retval 0	   success
+ */
+static int nrs_drr_start(struct ptlrpc_nrs_policy *policy, char *arg)
+{
+	struct nrs_drr_head *head;
+	int type = NRS_DRR_EXPORT;
+	int rc;
+	ENTRY;
+
+	if (arg != NULL && arg[0] != '\0') {
+		type = match_string(nrs_drr_type_names,
+				    ARRAY_SIZE(nrs_drr_type_names), arg);
+		if (type < 0)
+			RETURN(-EINVAL);
+	}
+
+	OBD_CPT_ALLOC_PTR(head, nrs_pol2cptab(policy), nrs_pol2cptid(policy));
+	if (head == NULL)
+		RETURN(-ENOMEM);
+
+	rc = rhashtable_init(&head->dh_cli_hash, &nrs_drr_hash_params);
+	if (rc) {
+		OBD_FREE_PTR(head);
+		RETURN(rc);
+	}
+
+	INIT_LIST_HEAD(&head->dh_classes);
+	INIT_LIST_HEAD(&head->dh_active);
+	spin_lock_init(&head->dh_lock);
+	head->dh_type = type;
+	head->dh_quantum = NRS_DRR_QUANTUM_DEF * NSEC_PER_USEC;
+
+	policy->pol_private = head;
+
+	RETURN(0);
+}
+
+/**
+ * Called when a DRR policy instance is stopped.
+ *
+ * Called when the policy has been instructed to transition to the
+ * ptlrpc_nrs_pol_state::NRS_POL_STATE_STOPPED state and has no more pending
+ * requests to serve.
+ *
+ * \param[in] policy the policy
+ */
+static void nrs_drr_stop(struct ptlrpc_nrs_policy *policy)
+{
+	struct nrs_drr_head *head = policy->pol_private;
+	ENTRY;
+
+	LASSERT(head != NULL);
+	LASSERT(list_empty(&head->dh_active));
+
+	rhashtable_free_and_destroy(&head->dh_cli_hash, nrs_drr_exit, NULL);
+
+	OBD_FREE_PTR(head);
+}
+
+/**
+ * Looks up the weight of class \a id.
+ *
+ * \pre assert_spin_locked(&head->dh_lock)
+ */
+static unsigned int nrs_drr_rule_weight(struct nrs_drr_head *head,
+					const char *id)
+{
+	int i;
+
+	for (i = 0; i < head->dh_nr_rules; i++) {
+		if (strcmp(head->dh_rules[i].dru_id, id) == 0)
+			return head->dh_rules[i].dru_weight;
+	}
+
+	return NRS_DRR_WEIGHT_DEF;
+}
+
+/**
+ * Sets the weight of class \a rule->dru_id, for the class if it exists and
+ * for the classes created later.
+ */
+static int nrs_drr_rule_set(struct nrs_drr_head *head,
+			    const struct nrs_drr_rule *rule)
+{
+	struct nrs_drr_class *cli;
+	int rc = 0;
+	int i;
+
+	spin_lock(&head->dh_lock);
+	for (i = 0; i < head->dh_nr_rules; i++) {
+		if (strcmp(head->dh_rules[i].dru_id, rule->dru_id) == 0)
+			break;
+	}
+
+	if (rule->dru_weight == NRS_DRR_WEIGHT_DEF) {
+		/* the default weight needs no rule */
+		if (i < head->dh_nr_rules)
+			head->dh_rules[i] =
+				head->dh_rules[--head->dh_nr_rules];
+	} else if (i < head->dh_nr_rules) {
+		head->dh_rules[i].dru_weight = rule->dru_weight;
+	} else if (i < NRS_DRR_RULES_MAX) {
+		head->dh_rules[head->dh_nr_rules++] = *rule;
+	} else {
+		GOTO(out, rc = -ENOSPC);
+	}
+
+	cli = rhashtable_lookup_fast(&head->dh_cli_hash, rule->dru_id,
+				     nrs_drr_hash_params);
+	if (cli != NULL)
+		WRITE_ONCE(cli->dc_weight, rule->dru_weight);
+out:
+	spin_unlock(&head->dh_lock);
+
+	return rc;
+}
+
+static int nrs_drr_dump(struct nrs_drr_head *head, struct seq_file *m)
+{
+	struct nrs_drr_class *cli;
+	int i;
+
+	seq_printf(m, "  type: %s\n", nrs_drr_type_names[head->dh_type]);
+	seq_printf(m, "  quantum_us: %llu\n",
+		   div_u64(head->dh_quantum, NSEC_PER_USEC));
+
+	spin_lock(&head->dh_lock);
+	seq_puts(m, "  weights:\n");
+	for (i = 0; i < head->dh_nr_rules; i++)
+		seq_printf(m, "  - { id: %s, weight: %u }\n",
+			   head->dh_rules[i].dru_id,
+			   head->dh_rules[i].dru_weight);
+
+	seq_puts(m, "  classes:\n");
+	list_for_each_entry(cli, &head->dh_classes, dc_link) {
+		seq_printf(m, "  - { id: %s, weight: %u, queued: %u, deficit_us: %lld, served: %llu, cost_us: %llu, avg_cost_us: %llu }\n",
+			   cli->dc_id, cli->dc_weight, cli->dc_queued,
+			   div_s64(cli->dc_deficit, NSEC_PER_USEC),
+			   cli->dc_served,
+			   div_u64(cli->dc_cost_total, NSEC_PER_USEC),
+			   div_u64(cli->dc_cost_avg, NSEC_PER_USEC));
+	}
+	spin_unlock(&head->dh_lock);
+
+	return seq_has_overflowed(m) ? -ENOSPC : 0;
+}
+
+/**
+ * Performs a policy-specific ctl function on DRR policy instances; similar
+ * to ioctl.
+ *
+ * \param[in]	  policy the policy instance
+ * \param[in]	  opc	 the opcode
+ * \param[in,out] arg	 used for passing parameters and information
+ *
+ * \pre assert_spin_locked(&policy->pol_nrs->->nrs_lock)
+ * \post assert_spin_locked(&policy->pol_nrs->->nrs_lock)
+ *
+ * \retval 0   operation carried out successfully
+ * \retval -ve error
+ */
+static int nrs_drr_ctl(struct ptlrpc_nrs_policy *policy,
+		       enum ptlrpc_nrs_ctl opc, void *arg)
+{
+	struct nrs_drr_head *head = policy->pol_private;
+	int rc = 0;
+
+	assert_spin_locked(&policy->pol_nrs->nrs_lock);
+
+	switch (opc) {
+	default:
+		RETURN(-EINVAL);
+
+	/**
+	 * Read the quantum of a policy instance, in usec.
+	 */
+	case NRS_CTL_DRR_RD_QUANTUM:
+		*(u32 *)arg = div_u64(head->dh_quantum, NSEC_PER_USEC);
+		break;
+
+	/**
+	 * Write the quantum of a policy instance, in usec.
+	 */
+	case NRS_CTL_DRR_WR_QUANTUM:
+		LASSERT(*(u32 *)arg != 0);
+		head->dh_quantum = (u64)*(u32 *)arg * NSEC_PER_USEC;
+		break;
+
+	case NRS_CTL_DRR_RD_WEIGHT: {
+		struct seq_file *m = arg;
+
+		seq_printf(m, "CPT %d:\n", policy->pol_nrs->nrs_svcpt->scp_cpt);
+		rc = nrs_drr_dump(head, m);
+		}
+		break;
+
+	case NRS_CTL_DRR_WR_WEIGHT:
+		rc = nrs_drr_rule_set(head, arg);
+		break;
+	}
+
+	RETURN(rc);
+}
+
+/**
+ * Generates the id of the class request \a req belongs to.
+ */
+static void nrs_drr_class_id(struct nrs_drr_head *head,
+			     struct ptlrpc_request *req, char *id)
+{
+	struct tbf_id tid;
+	const char *jobid;
+
+	memset(id, 0, NRS_DRR_ID_LEN);
+
+	switch (head->dh_type) {
+	case NRS_DRR_EXPORT:
+		if (req->rq_export != NULL)
+			strscpy(id, req->rq_export->exp_client_uuid.uuid,
+				NRS_DRR_ID_LEN);
+		else
+			strscpy(id, libcfs_nid2str(req->rq_peer.nid),
+				NRS_DRR_ID_LEN);
+		break;
+	case NRS_DRR_JOBID:
+		jobid = lustre_msg_get_jobid(req->rq_reqmsg);
+		strscpy(id, jobid != NULL && jobid[0] != '\0' ? jobid : "-",
+			NRS_DRR_ID_LEN);
+		break;
+	case NRS_DRR_UID:
+		if (nrs_tbf_id_cli_set(req, &tid, NRS_TBF_FLAG_UID) == 0)
+			snprintf(id, NRS_DRR_ID_LEN, "%u", tid.ti_uid);
+		else
+			strscpy(id, "-", NRS_DRR_ID_LEN);
+		break;
+	case NRS_DRR_GID:
+		if (nrs_tbf_id_cli_set(req, &tid, NRS_TBF_FLAG_GID) == 0)
+			snprintf(id, NRS_DRR_ID_LEN, "%u", tid.ti_gid);
+		else
+			strscpy(id, "-", NRS_DRR_ID_LEN);
+		break;
+	}
+}
+
+/**
+ * Obtains resources from DRR policy instances. The top-level resource lives
+ * inside \e nrs_drr_head and the second-level resource inside
+ * \e nrs_drr_class object instances.
+ *
+ * \param[in]  policy	  the policy for which resources are being taken for
+ *			  request \a nrq
+ * \param[in]  nrq	  the request for which resources are being taken
+ * \param[in]  parent	  parent resource, embedded in nrs_drr_head for the
+ *			  DRR policy
+ * \param[out] resp	  resources references are placed in this array
+ * \param[in]  moving_req signifies limited caller context; used to perform
+ *			  memory allocations in an atomic context in this
+ *			  policy
+ *
+ * \retval 0   we are returning a top-level, parent resource, one that is
+ *	       embedded in an nrs_drr_head object
+ * \retval 1   we are returning a bottom-level resource, one that is embedded
+ *	       in an nrs_drr_class object
+ *
+ * \see nrs_resource_get_safe()
+ */
+static int nrs_drr_res_get(struct ptlrpc_nrs_policy *policy,
+			   struct ptlrpc_nrs_request *nrq,
+			   const struct ptlrpc_nrs_resource *parent,
+			   struct ptlrpc_nrs_resource **resp, bool moving_req)
+{
+	struct nrs_drr_head *head;
+	struct nrs_drr_class *cli;
+	struct nrs_drr_class *tmp;
+	struct ptlrpc_request *req;
+	char id[NRS_DRR_ID_LEN];
+
+	if (parent == NULL) {
+		*resp = &((struct nrs_drr_head *)policy->pol_private)->dh_res;
+		return 0;
+	}
+
+	head = container_of(parent, struct nrs_drr_head, dh_res);
+	req = container_of(nrq, struct ptlrpc_request, rq_nrq);
+
+	nrs_drr_class_id(head, req, id);
+	cli = rhashtable_lookup_fast(&head->dh_cli_hash, id,
+				     nrs_drr_hash_params);
+	if (cli)
+		goto out;
+
+	OBD_CPT_ALLOC_GFP(cli, nrs_pol2cptab(policy), nrs_pol2cptid(policy),
+			  sizeof(*cli), moving_req ? GFP_ATOMIC : GFP_NOFS);
+	if (cli == NULL)
+		return -ENOMEM;
+
+	memcpy(cli->dc_id, id, sizeof(cli->dc_id));
+	atomic_set(&cli->dc_ref, 0);
+	INIT_LIST_HEAD(&cli->dc_active);
+	INIT_LIST_HEAD(&cli->dc_list);
+	cli->dc_weight = NRS_DRR_WEIGHT_DEF;
+	cli->dc_cost_avg = NRS_DRR_COST_INIT;
+
+	tmp = rhashtable_lookup_get_insert_fast(&head->dh_cli_hash,
+						&cli->dc_rhead,
+						nrs_drr_hash_params);
+	if (tmp) {
+		/* insertion failed */
+		OBD_FREE_PTR(cli);
+		if (IS_ERR(tmp))
+			return PTR_ERR(tmp);
+		cli = tmp;
+		goto out;
+	}
+
+	/* set the weight after insertion so that nrs_drr_rule_set() either
+	 * finds this class or has updated the rule by now */
+	spin_lock(&head->dh_lock);
+	WRITE_ONCE(cli->dc_weight, nrs_drr_rule_weight(head, cli->dc_id));
+	list_add_tail(&cli->dc_link, &head->dh_classes);
+	spin_unlock(&head->dh_lock);
+out:
+	atomic_inc(&cli->dc_ref);
+	*resp = &cli->dc_res;
+
+	return 1;
+}
+
+/**
+ * Called when releasing references to the resource hierachy obtained for a
+ * request for scheduling using the DRR policy.
+ *
+ * \param[in] policy   the policy the resource belongs to
+ * \param[in] res      the resource to be released
+ */
+static void nrs_drr_res_put(struct ptlrpc_nrs_policy *policy,
+			    const struct ptlrpc_nrs_resource *res)
+{
+	struct nrs_drr_class *cli;
+
+	/**
+	 * Do nothing for freeing parent, nrs_drr_head resources
+	 */
+	if (res->res_parent == NULL)
+		return;
+
+	cli = container_of(res, struct nrs_drr_class, dc_res);
+
+	atomic_dec(&cli->dc_ref);
+}
+
+static void nrs_drr_class_deactivate(struct nrs_drr_head *head,
+				     struct nrs_drr_class *cli)
+{
+	list_del_init(&cli->dc_active);
+	head->dh_nr_active--;
+	/* an idle class does not keep unused service time for later */
+	if (cli->dc_deficit > 0)
+		cli->dc_deficit = 0;
+}
+
+/**
+ * Gives every active class the number of quanta needed by the class closest
+ * to a positive deficit, so that one of them can be served; this saves going
+ * round many times after expensive requests.
+ */
+static void nrs_drr_fast_forward(struct nrs_drr_head *head)
+{
+	struct nrs_drr_class *cli;
+	u64 rounds = U64_MAX;
+	u64 quantum;
+
+	list_for_each_entry(cli, &head->dh_active, dc_active) {
+		if (cli->dc_deficit > 0)
+			return;
+		quantum = head->dh_quantum * cli->dc_weight;
+		rounds = min(rounds,
+			     div64_u64(-cli->dc_deficit, quantum) + 1);
+	}
+
+	list_for_each_entry(cli, &head->dh_active, dc_active)
+		cli->dc_deficit += rounds * head->dh_quantum * cli->dc_weight;
+}
+
+/**
+ * Finds the class to serve next. The class at the head of
+ * nrs_drr_head::dh_active is served while it has service time left for this
+ * round; otherwise it is given its quantum and, if that is not enough to
+ * pay for what it used in excess, goes to the tail.
+ */
+static struct nrs_drr_class *nrs_drr_class_next(struct nrs_drr_head *head)
+{
+	struct nrs_drr_class *cli;
+	unsigned int visited = 0;
+
+	while (1) {
+		cli = list_first_entry(&head->dh_active, struct nrs_drr_class,
+				       dc_active);
+		if (cli->dc_deficit > 0)
+			return cli;
+
+		cli->dc_deficit += head->dh_quantum * cli->dc_weight;
+		if (cli->dc_deficit > 0)
+			return cli;
+
+		list_move_tail(&cli->dc_active, &head->dh_active);
+		if (++visited >= head->dh_nr_active) {
+			nrs_drr_fast_forward(head);
+			visited = 0;
+		}
+	}
+}
+
+/**
+ * Called when getting a request from the DRR policy for handling, or just
+ * peeking; removes the request from the policy when it is to be handled.
+ *
+ * \param[in] policy the policy being polled
+ * \param[in] peek   when set, signifies that we just want to examine the
+ *		     request, and not handle it, so the request is not removed
+ *		     from the policy.
+ * \param[in] force  force the policy to return a request; unused in this policy
+ *
+ * \retval the request to be handled
+ * \retval NULL no request available
+ *
+ * \see ptlrpc_nrs_req_get_nolock()
+ * \see nrs_request_get()
+ */
+static
+struct ptlrpc_nrs_request *nrs_drr_req_get(struct ptlrpc_nrs_policy *policy,
+					   bool peek, bool force)
+{
+	struct nrs_drr_head *head = policy->pol_private;
+	struct ptlrpc_nrs_request *nrq;
+	struct nrs_drr_class *cli;
+
+	if (unlikely(list_empty(&head->dh_active)))
+		return NULL;
+
+	cli = nrs_drr_class_next(head);
+	nrq = list_first_entry(&cli->dc_list, struct ptlrpc_nrs_request,
+			       nr_u.drr.dr_list);
+
+	if (likely(!peek)) {
+		struct ptlrpc_request *req = container_of(nrq,
+							  struct ptlrpc_request,
+							  rq_nrq);
+
+		list_del_init(&nrq->nr_u.drr.dr_list);
+		cli->dc_queued--;
+
+		/* charge the expected cost now, and correct it when the
+		 * request is finished */
+		nrq->nr_u.drr.dr_start = ktime_get();
+		nrq->nr_u.drr.dr_charged = cli->dc_cost_avg;
+		cli->dc_deficit -= cli->dc_cost_avg;
+
+		if (cli->dc_queued == 0)
+			nrs_drr_class_deactivate(head, cli);
+		else if (cli->dc_deficit <= 0)
+			list_move_tail(&cli->dc_active, &head->dh_active);
+
+		CDEBUG(D_RPCTRACE,
+		       "NRS: starting to handle %s request from %s, class %s, deficit %lld\n",
+		       NRS_POL_NAME_DRR, libcfs_id2str(req->rq_peer),
+		       cli->dc_id, cli->dc_deficit);
+	}
+
+	return nrq;
+}
+
+/**
+ * Adds request \a nrq to a DRR \a policy instance's set of queued requests
+ *
+ * \param[in] policy the policy
+ * \param[in] nrq    the request to add
+ *
+ * \retval 0	request successfully added
+ */
+static int nrs_drr_req_add(struct ptlrpc_nrs_policy *policy,
+			   struct ptlrpc_nrs_request *nrq)
+{
+	struct nrs_drr_head *head;
+	struct nrs_drr_class *cli;
+
+	cli = container_of(nrs_request_resource(nrq),
+			   struct nrs_drr_class, dc_res);
+	head = container_of(nrs_request_resource(nrq)->res_parent,
+			    struct nrs_drr_head, dh_res);
+
+	list_add_tail(&nrq->nr_u.drr.dr_list, &cli->dc_list);
+	if (cli->dc_queued++ == 0) {
+		list_add_tail(&cli->dc_active, &head->dh_active);
+		head->dh_nr_active++;
+	}
+
+	return 0;
+}
+
+/**
+ * Removes request \a nrq from a DRR \a policy instance's set of queued
+ * requests.
+ *
+ * \param[in] policy the policy
+ * \param[in] nrq    the request to remove
+ */
+static void nrs_drr_req_del(struct ptlrpc_nrs_policy *policy,
+			    struct ptlrpc_nrs_request *nrq)
+{
+	struct nrs_drr_head *head;
+	struct nrs_drr_class *cli;
+
+	cli = container_of(nrs_request_resource(nrq),
+			   struct nrs_drr_class, dc_res);
+	head = container_of(nrs_request_resource(nrq)->res_parent,
+			    struct nrs_drr_head, dh_res);
+
+	list_del_init(&nrq->nr_u.drr.dr_list);
+	if (--cli->dc_queued == 0)
+		nrs_drr_class_deactivate(head, cli);
+}
+
+/**
+ * Called right after the request \a nrq finishes being handled by DRR policy
+ * instance \a policy; charges the class the time it took.
+ *
+ * \param[in] policy the policy that handled the request
+ * \param[in] nrq    the request that was handled
+ */
+static void nrs_drr_req_stop(struct ptlrpc_nrs_policy *policy,
+			     struct ptlrpc_nrs_request *nrq)
+{
+	struct ptlrpc_request *req = container_of(nrq, struct ptlrpc_request,
+						  rq_nrq);
+	struct nrs_drr_class *cli;
+	u64 cost;
+
+	cli = container_of(nrs_request_resource(nrq),
+			   struct nrs_drr_class, dc_res);
+
+	cost = ktime_to_ns(ktime_sub(ktime_get(), nrq->nr_u.drr.dr_start));
+	cli->dc_deficit -= (s64)(cost - nrq->nr_u.drr.dr_charged);
+	cli->dc_cost_avg = (cli->dc_cost_avg * 7 + cost) >> 3;
+	cli->dc_served++;
+	cli->dc_cost_total += cost;
+
+	CDEBUG(D_RPCTRACE,
+	       "NRS: finished handling %s request from %s, class %s, cost %llu\n",
+	       NRS_POL_NAME_DRR, libcfs_id2str(req->rq_peer), cli->dc_id,
+	       cost);
+}
+
+/**
+ * debugfs interface
+ */
+
+/**
+ * Retrieves the quantum of DRR policy instances on both the regular and
+ * high-priority NRS head of a service, in usec of service time per round and
+ * unit of weight.
+ *
+ * For example:
+ *
+ *	reg_quantum:2000
+ *	hp_quantum:2000
+ */
+static int
+ptlrpc_lprocfs_nrs_drr_quantum_seq_show(struct seq_file *m, void *data)
+{
+	struct ptlrpc_service *svc = m->private;
+	u32 quantum;
+	int rc;
+
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+				       NRS_POL_NAME_DRR,
+				       NRS_CTL_DRR_RD_QUANTUM,
+				       true, &quantum);
+	if (rc == 0)
+		seq_printf(m, NRS_LPROCFS_QUANTUM_NAME_REG "%u\n", quantum);
+	else if (rc != -ENODEV)
+		return rc;
+
+	if (!nrs_svc_has_hp(svc))
+		return rc;
+
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+				       NRS_POL_NAME_DRR,
+				       NRS_CTL_DRR_RD_QUANTUM,
+				       true, &quantum);
+	if (rc == 0)
+		seq_printf(m, NRS_LPROCFS_QUANTUM_NAME_HP "%u\n", quantum);
+
+	return rc;
+}
+
+/**
+ * Sets the quantum of DRR policy instances on both NRS heads of a service,
+ * in usec.
+ *
+ * For example:
+ *
+ * lctl set_param ost.OSS.ost_io.nrs_drr_quantum=5000
+ */
+static ssize_t
+ptlrpc_lprocfs_nrs_drr_quantum_seq_write(struct file *file,
+					 const char __user *buffer,
+					 size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	u32 quantum;
+	int rc;
+	int rc2 = -ENODEV;
+
+	rc = kstrtouint_from_user(buffer, count, 0, &quantum);
+	if (rc)
+		return rc;
+
+	if (quantum == 0 || quantum > NRS_DRR_QUANTUM_MAX)
+		return -EINVAL;
+
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+				       NRS_POL_NAME_DRR,
+				       NRS_CTL_DRR_WR_QUANTUM, false,
+				       &quantum);
+	if (rc < 0 && rc != -ENODEV)
+		return rc;
+
+	if (nrs_svc_has_hp(svc)) {
+		rc2 = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+						NRS_POL_NAME_DRR,
+						NRS_CTL_DRR_WR_QUANTUM, false,
+						&quantum);
+		if (rc2 < 0 && rc2 != -ENODEV)
+			return rc2;
+	}
+
+	return rc == -ENODEV && rc2 == -ENODEV ? -ENODEV : count;
+}
+
+LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_drr_quantum);
+
+/**
+ * Shows the weight rules and the classes of DRR policy instances, with the
+ * service time each class was charged.
+ */
+static int
+ptlrpc_lprocfs_nrs_drr_weight_seq_show(struct seq_file *m, void *data)
+{
+	struct ptlrpc_service *svc = m->private;
+	int rc;
+
+	seq_puts(m, "regular_requests:\n");
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+				       NRS_POL_NAME_DRR,
+				       NRS_CTL_DRR_RD_WEIGHT,
+				       false, m);
+	/**
+	 * -ENOSPC means buf in the parameter m is overflow, return 0
+	 * here to let upper layer function seq_read alloc a larger
+	 * memory area and do this process again.
+	 */
+	if (rc == -ENOSPC)
+		return 0;
+	if (rc != 0 && rc != -ENODEV)
+		return rc;
+
+	if (!nrs_svc_has_hp(svc))
+		return 0;
+
+	seq_puts(m, "high_priority_requests:\n");
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+				       NRS_POL_NAME_DRR,
+				       NRS_CTL_DRR_RD_WEIGHT,
+				       false, m);
+	if (rc == -ENOSPC || rc == -ENODEV)
+		rc = 0;
+
+	return rc;
+}
+
+/**
+ * Sets the weight of a class of DRR policy instances, as "<id>:<weight>".
+ * The id is the client UUID, JobID, UID or GID, depending on what the policy
+ * was started with; setting the weight to 1 drops the rule.
+ *
+ * For example:
+ *
+ * lctl set_param ost.OSS.ost_io.nrs_drr_weight=dd.500:4
+ */
+static ssize_t
+ptlrpc_lprocfs_nrs_drr_weight_seq_write(struct file *file,
+					const char __user *buffer,
+					size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	struct nrs_drr_rule rule = { { 0 } };
+	char kernbuf[NRS_DRR_ID_LEN + 8];
+	char *sep;
+	int rc;
+	int rc2 = -ENODEV;
+
+	if (count >= sizeof(kernbuf))
+		return -EINVAL;
+
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+
+	kernbuf[count] = '\0';
+	strim(kernbuf);
+
+	/* JobIDs may contain ':', the weight comes after the last one */
+	sep = strrchr(kernbuf, ':');
+	if (sep == NULL || sep == kernbuf)
+		return -EINVAL;
+	*sep++ = '\0';
+
+	rc = kstrtouint(sep, 10, &rule.dru_weight);
+	if (rc)
+		return rc;
+
+	if (rule.dru_weight == 0 || rule.dru_weight > NRS_DRR_WEIGHT_MAX ||
+	    strlen(kernbuf) >= NRS_DRR_ID_LEN)
+		return -EINVAL;
+
+	strscpy(rule.dru_id, kernbuf, sizeof(rule.dru_id));
+
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+				       NRS_POL_NAME_DRR,
+				       NRS_CTL_DRR_WR_WEIGHT, false, &rule);
+	if (rc < 0 && rc != -ENODEV)
+		return rc;
+
+	if (nrs_svc_has_hp(svc)) {
+		rc2 = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+						NRS_POL_NAME_DRR,
+						NRS_CTL_DRR_WR_WEIGHT, false,
+						&rule);
+		if (rc2 < 0 && rc2 != -ENODEV)
+			return rc2;
+	}
+
+	return rc == -ENODEV && rc2 == -ENODEV ? -ENODEV : count;
+}
+
+LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_drr_weight);
+
+/**
+ * Initializes a DRR policy's lprocfs interface for service \a svc
+ *
+ * \param[in] svc the service
+ *
+ * \retval 0	success
+ * \retval != 0	error
+ */
+static int nrs_drr_lprocfs_init(struct ptlrpc_service *svc)
+{
+	struct ldebugfs_vars nrs_drr_lprocfs_vars[] = {
+		{ .name		= "nrs_drr_quantum",
+		  .fops		= &ptlrpc_lprocfs_nrs_drr_quantum_fops,
+		  .data = svc },
+		{ .name		= "nrs_drr_weight",
+		  .fops		= &ptlrpc_lprocfs_nrs_drr_weight_fops,
+		  .data = svc },
+		{ NULL }
+	};
+
+	if (!svc->srv_debugfs_entry)
+		return 0;
+
+	ldebugfs_add_vars(svc->srv_debugfs_entry, nrs_drr_lprocfs_vars, NULL);
+
+	return 0;
+}
+
+/**
+ * DRR policy operations
+ */
+static const struct ptlrpc_nrs_pol_ops nrs_drr_ops = {
+	.op_policy_start	= nrs_drr_start,
+	.op_policy_stop		= nrs_drr_stop,
+	.op_policy_ctl		= nrs_drr_ctl,
+	.op_res_get		= nrs_drr_res_get,
+	.op_res_put		= nrs_drr_res_put,
+	.op_req_get		= nrs_drr_req_get,
+	.op_req_enqueue		= nrs_drr_req_add,
+	.op_req_dequeue		= nrs_drr_req_del,
+	.op_req_stop		= nrs_drr_req_stop,
+	.op_lprocfs_init	= nrs_drr_lprocfs_init,
+};
+
+/**
+ * DRR policy configuration
+ */
+struct ptlrpc_nrs_pol_conf nrs_conf_drr = {
+	.nc_name		= NRS_POL_NAME_DRR,
+	.nc_ops			= &nrs_drr_ops,
+	.nc_compat		= nrs_policy_compat_all,
+};
+
+/** @} DRR policy */
+
+/** @} nrs */
@@ -65,6 +65,16 @@ static int tbf_depth = 3;
 module_param(tbf_depth, int, 0644);
 MODULE_PARM_DESC(tbf_depth, "How many tokens that a client can save up");
 
+static int tbf_adapt_latency = 100000;
+module_param(tbf_adapt_latency, int, 0644);
+MODULE_PARM_DESC(tbf_adapt_latency,
+		 "Target service latency of adaptive rules in usec");
+
+/* How often the rates of adaptive rules are reconsidered */
+#define NRS_TBF_ADAPT_INTERVAL	NSEC_PER_SEC
+/* Queued requests per running thread beyond which a partition is overloaded */
+#define NRS_TBF_ADAPT_BACKLOG	4
+
 static enum hrtimer_restart nrs_tbf_timer_cb(struct hrtimer *timer)
 {
 	struct nrs_tbf_head *head = container_of(timer, struct nrs_tbf_head,
@@ -276,6 +286,48 @@ nrs_tbf_cli_fini(struct nrs_tbf_client *cli)
 	OBD_FREE_PTR(cli);
 }
 
+/**
+ * Sets the RPC rate of \a rule, kept within the bounds of an adaptive rule.
+ *
+ * \retval true if the rate changed
+ */
+static bool nrs_tbf_rule_set_rate(struct nrs_tbf_rule *rule, __u64 rate)
+{
+	if (rule->tr_rate_max != 0)
+		rate = clamp(rate, rule->tr_rate_min, rule->tr_rate_max);
+	if (rate == rule->tr_rpc_rate)
+		return false;
+
+	rule->tr_rpc_rate = rate;
+	rule->tr_nsecs_per_rpc = NSEC_PER_SEC / rule->tr_rpc_rate;
+	rule->tr_generation++;
+	return true;
+}
+
+/**
+ * Makes \a rule adaptive, with its rate scaled between \a min and \a max.
+ *
+ * A bound of 0 keeps the current one of an adaptive rule; for a static rule
+ * the minimum defaults to 1 RPC/s and the maximum to the current rate, so the
+ * rate the admin set is the ceiling.
+ */
+static int nrs_tbf_rule_set_bounds(struct nrs_tbf_rule *rule,
+				   __u64 min, __u64 max)
+{
+	if (min == 0)
+		min = rule->tr_rate_min ? rule->tr_rate_min : 1;
+	if (max == 0)
+		max = rule->tr_rate_max ? rule->tr_rate_max :
+		      max(rule->tr_rpc_rate, min);
+	if (min > max)
+		return -EINVAL;
+
+	rule->tr_rate_min = min;
+	rule->tr_rate_max = max;
+	nrs_tbf_rule_set_rate(rule, rule->tr_rpc_rate);
+	return 0;
+}
+
 static int
 nrs_tbf_rule_start(struct ptlrpc_nrs_policy *policy,
 		   struct nrs_tbf_head *head,
@@ -309,6 +361,17 @@ nrs_tbf_rule_start(struct ptlrpc_nrs_policy *policy,
 	spin_lock_init(&rule->tr_rule_lock);
 	rule->tr_head = head;
 
+	if (start->u.tc_start.ts_rate_min != 0 ||
+	    start->u.tc_start.ts_rate_max != 0) {
+		rc = nrs_tbf_rule_set_bounds(rule,
+					     start->u.tc_start.ts_rate_min,
+					     start->u.tc_start.ts_rate_max);
+		if (rc) {
+			OBD_FREE_PTR(rule);
+			return rc;
+		}
+	}
+
 	rc = head->th_ops->o_rule_init(policy, rule, start);
 	if (rc) {
 		OBD_FREE_PTR(rule);
@@ -414,6 +477,8 @@ nrs_tbf_rule_change_rate(struct ptlrpc_nrs_policy *policy,
 	if (rule == NULL)
 		return -ENOENT;
 
+	if (rule->tr_rate_max != 0)
+		rate = clamp(rate, rule->tr_rate_min, rule->tr_rate_max);
 	rule->tr_rpc_rate = rate;
 	rule->tr_nsecs_per_rpc = NSEC_PER_SEC / rule->tr_rpc_rate;
 	rule->tr_generation++;
@@ -422,6 +487,33 @@ nrs_tbf_rule_change_rate(struct ptlrpc_nrs_policy *policy,
 	return 0;
 }
 
+static int
+nrs_tbf_rule_change_bounds(struct ptlrpc_nrs_policy *policy,
+			   struct nrs_tbf_head *head,
+			   struct nrs_tbf_cmd *change)
+{
+	struct nrs_tbf_rule *rule;
+	int rc = 0;
+
+	assert_spin_locked(&policy->pol_nrs->nrs_lock);
+
+	rule = nrs_tbf_rule_find(head, change->tc_name);
+	if (rule == NULL)
+		return -ENOENT;
+
+	if (change->u.tc_change.tc_static) {
+		rule->tr_rate_min = 0;
+		rule->tr_rate_max = 0;
+	} else {
+		rc = nrs_tbf_rule_set_bounds(rule,
+					     change->u.tc_change.tc_rate_min,
+					     change->u.tc_change.tc_rate_max);
+	}
+	nrs_tbf_rule_put(rule);
+
+	return rc;
+}
+
 static int
 nrs_tbf_rule_change(struct ptlrpc_nrs_policy *policy,
 		    struct nrs_tbf_head *head,
@@ -431,6 +523,14 @@ nrs_tbf_rule_change(struct ptlrpc_nrs_policy *policy,
 	char	*next_name = change->u.tc_change.tc_next_name;
 	int	 rc;
 
+	if (change->u.tc_change.tc_static ||
+	    change->u.tc_change.tc_rate_min != 0 ||
+	    change->u.tc_change.tc_rate_max != 0) {
+		rc = nrs_tbf_rule_change_bounds(policy, head, change);
+		if (rc)
+			return rc;
+	}
+
 	if (rate != 0) {
 		rc = nrs_tbf_rule_change_rate(policy, head, change->tc_name,
 					      rate);
@@ -1588,8 +1688,8 @@ static int ldlm_tbf_id_cli_set(struct ptlrpc_request *req,
 	return 0;
 }
 
-static int nrs_tbf_id_cli_set(struct ptlrpc_request *req, struct tbf_id *id,
-			      enum nrs_tbf_flag ti_type)
+int nrs_tbf_id_cli_set(struct ptlrpc_request *req, struct tbf_id *id,
+		       enum nrs_tbf_flag ti_type)
 {
 	u32 opc = lustre_msg_get_opc(req->rq_reqmsg);
 	struct req_format *fmt = req_fmt(opc);
@@ -2797,6 +2897,8 @@ static int nrs_tbf_start(struct ptlrpc_nrs_policy *policy, char *arg)
 	INIT_LIST_HEAD(&head->th_list);
 	hrtimer_init(&head->th_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
 	head->th_timer.function = nrs_tbf_timer_cb;
+	head->th_adapt_target = (__u64)tbf_adapt_latency * NSEC_PER_USEC;
+	head->th_adapt_check = ktime_to_ns(ktime_get());
 	rc = head->th_ops->o_startup(policy, head);
 	if (rc)
 		GOTO(out_free_heap, rc);
@@ -2908,6 +3010,52 @@ static int nrs_tbf_ctl(struct ptlrpc_nrs_policy *policy,
 		*(__u32 *)arg = head->th_type_flag;
 		}
 		break;
+	/**
+	 * Read the adaptive rate control state of a policy instance.
+	 */
+	case NRS_CTL_TBF_RD_ADAPTIVE: {
+		struct nrs_tbf_head *head = policy->pol_private;
+		struct ptlrpc_service_part *svcpt = policy->pol_nrs->nrs_svcpt;
+		struct seq_file *m = arg;
+		struct nrs_tbf_rule *rule;
+
+		seq_printf(m, "CPT %d:\n", svcpt->scp_cpt);
+		seq_printf(m, "  target_latency_us: %llu\n",
+			   div_u64(head->th_adapt_target, NSEC_PER_USEC));
+		seq_printf(m, "  service_latency_us: %llu\n",
+			   div_u64(head->th_adapt_latency, NSEC_PER_USEC));
+		seq_printf(m, "  queued: %ld\n", policy->pol_req_queued);
+		seq_printf(m, "  active_threads: %d/%d\n",
+			   svcpt->scp_nreqs_active, svcpt->scp_nthrs_running);
+		seq_printf(m, "  raised: %llu\n", head->th_adapt_raised);
+		seq_printf(m, "  lowered: %llu\n", head->th_adapt_lowered);
+		seq_printf(m, "  rules:\n");
+
+		spin_lock(&head->th_rule_lock);
+		list_for_each_entry(rule, &head->th_list, tr_linkage) {
+			if (rule->tr_rate_max == 0)
+				continue;
+			seq_printf(m, "    %s rate %llu min %llu max %llu\n",
+				   rule->tr_name, rule->tr_rpc_rate,
+				   rule->tr_rate_min, rule->tr_rate_max);
+		}
+		spin_unlock(&head->th_rule_lock);
+		}
+		break;
+	/**
+	 * Write the target service latency of a policy instance, in usec.
+	 */
+	case NRS_CTL_TBF_WR_ADAPTIVE: {
+		struct nrs_tbf_head *head = policy->pol_private;
+
+		head->th_adapt_target = (__u64)*(__u32 *)arg * NSEC_PER_USEC;
+		/* start sampling afresh, nothing is sampled while disabled */
+		head->th_adapt_check = ktime_to_ns(ktime_get());
+		head->th_adapt_lat_sum = 0;
+		head->th_adapt_lat_cnt = 0;
+		head->th_adapt_throttled = 0;
+		}
+		break;
 	}
 
 	RETURN(rc);
@@ -3019,6 +3167,83 @@ static void nrs_tbf_res_put(struct ptlrpc_nrs_policy *policy,
 	head->th_ops->o_cli_put(head, cli);
 }
 
+/**
+ * Scales the rates of the adaptive rules of \a head with the load of the
+ * service partition, once every NRS_TBF_ADAPT_INTERVAL.
+ *
+ * The partition is overloaded when its requests take longer than the target
+ * latency to be served, or when all of its threads are busy and the backlog
+ * keeps growing; the adaptive rules are then slowed down by a quarter, to no
+ * less than their minimum rate. When the requests are served well within the
+ * target, some threads are idle and classes of adaptive rules were held back
+ * for lack of tokens, the rules are sped up by an eighth, to no more than
+ * their maximum rate. The classes pick up the new rates through the rule
+ * generation, as they do for an admin "change" command.
+ *
+ * \param[in] policy the policy instance
+ * \param[in] head   the TBF policy instance
+ * \param[in] now    the current time, in nsec
+ */
+static void nrs_tbf_adapt(struct ptlrpc_nrs_policy *policy,
+			  struct nrs_tbf_head *head, __u64 now)
+{
+	struct ptlrpc_service_part *svcpt = policy->pol_nrs->nrs_svcpt;
+	struct nrs_tbf_rule *rule;
+	bool busy;
+	int step = 0;
+
+	assert_spin_locked(&svcpt->scp_req_lock);
+
+	if (head->th_adapt_target == 0 ||
+	    now - head->th_adapt_check < NRS_TBF_ADAPT_INTERVAL)
+		return;
+
+	head->th_adapt_latency = head->th_adapt_lat_cnt == 0 ? 0 :
+		div_u64(head->th_adapt_lat_sum, head->th_adapt_lat_cnt);
+	busy = svcpt->scp_nreqs_active >= svcpt->scp_nthrs_running;
+
+	if (head->th_adapt_latency > head->th_adapt_target ||
+	    (busy && policy->pol_req_queued >
+	     svcpt->scp_nthrs_running * NRS_TBF_ADAPT_BACKLOG))
+		step = -1;
+	else if (!busy && head->th_adapt_throttled > 0 &&
+		 head->th_adapt_latency < head->th_adapt_target / 2)
+		step = 1;
+
+	if (step != 0) {
+		spin_lock(&head->th_rule_lock);
+		list_for_each_entry(rule, &head->th_list, tr_linkage) {
+			__u64 rate = rule->tr_rpc_rate;
+
+			if (rule->tr_rate_max == 0)
+				continue;
+
+			if (step > 0)
+				rate += max_t(__u64, rate >> 3, 1);
+			else
+				rate -= max_t(__u64, rate >> 2, 1);
+			if (!nrs_tbf_rule_set_rate(rule, rate))
+				continue;
+
+			if (step > 0)
+				head->th_adapt_raised++;
+			else
+				head->th_adapt_lowered++;
+			CDEBUG(D_RPCTRACE,
+			       "TBF %s rule %s rate %llu, latency %llu/%llu ns, queued %ld\n",
+			       step > 0 ? "raises" : "lowers", rule->tr_name,
+			       rule->tr_rpc_rate, head->th_adapt_latency,
+			       head->th_adapt_target, policy->pol_req_queued);
+		}
+		spin_unlock(&head->th_rule_lock);
+	}
+
+	head->th_adapt_check = now;
+	head->th_adapt_lat_sum = 0;
+	head->th_adapt_lat_cnt = 0;
+	head->th_adapt_throttled = 0;
+}
+
 /**
  * Called when getting a request from the TBF policy for handling, or just
  * peeking; removes the request from the policy when it is to be handled.
@@ -3068,6 +3293,8 @@ struct ptlrpc_nrs_request *nrs_tbf_req_get(struct ptlrpc_nrs_policy *policy,
 		__u64 deadline;
 		__u64 old_resid = 0;
 
+		nrs_tbf_adapt(policy, head, now);
+
 		deadline = cli->tc_check_time +
 			  cli->tc_nsecs;
 		LASSERT(now >= cli->tc_check_time);
@@ -3095,6 +3322,7 @@ struct ptlrpc_nrs_request *nrs_tbf_req_get(struct ptlrpc_nrs_policy *policy,
 			cli->tc_ntoken = ntoken;
 			cli->tc_check_time = now;
 			list_del_init(&nrq->nr_u.tbf.tr_list);
+			nrq->nr_u.tbf.tr_start = now;
 			if (list_empty(&cli->tc_list)) {
 				binheap_remove(head->th_binheap,
 					       &cli->tc_node);
@@ -3114,6 +3342,10 @@ struct ptlrpc_nrs_request *nrs_tbf_req_get(struct ptlrpc_nrs_policy *policy,
 		} else {
 			ktime_t time;
 
+			if (rule->tr_rate_max != 0 &&
+			    head->th_adapt_target != 0)
+				head->th_adapt_throttled++;
+
 			if (rule->tr_flags & NTRS_REALTIME) {
 				cli->tc_deadline = deadline;
 				cli->tc_nsecs_resid = old_resid;
@@ -3229,8 +3461,8 @@ static void nrs_tbf_req_del(struct ptlrpc_nrs_policy *policy,
 }
 
 /**
- * Prints a debug statement right before the request \a nrq stops being
- * handled.
+ * Records the service time of the request \a nrq for the adaptive rate
+ * control and prints a debug statement right before it stops being handled.
  *
  * \param[in] policy The policy handling the request
  * \param[in] nrq    The request being handled
@@ -3243,9 +3475,17 @@ static void nrs_tbf_req_stop(struct ptlrpc_nrs_policy *policy,
 {
 	struct ptlrpc_request *req = container_of(nrq, struct ptlrpc_request,
 						  rq_nrq);
+	struct nrs_tbf_head *head = policy->pol_private;
 
 	assert_spin_locked(&policy->pol_nrs->nrs_svcpt->scp_req_lock);
 
+	/* service time sample for the adaptive rate control */
+	if (head->th_adapt_target != 0) {
+		head->th_adapt_lat_sum += ktime_to_ns(ktime_get()) -
+					  nrq->nr_u.tbf.tr_start;
+		head->th_adapt_lat_cnt++;
+	}
+
 	CDEBUG(D_RPCTRACE, "NRS stop %s request from %s, seq: %llu\n",
 	       policy->pol_desc->pd_name, libcfs_id2str(req->rq_peer),
 	       nrq->nr_u.tbf.tr_sequence);
@@ -3429,6 +3669,37 @@ nrs_tbf_parse_value_pair(struct nrs_tbf_cmd *cmd, char *buffer)
 			cmd->u.tc_change.tc_next_name = val;
 		else
 			return -EINVAL;
+	} else if (strcmp(key, "min_rate") == 0 ||
+		   strcmp(key, "max_rate") == 0) {
+		bool is_min = strcmp(key, "min_rate") == 0;
+
+		rc = kstrtoull(val, 10, &rate);
+		if (rc)
+			return rc;
+
+		if (rate <= 0 || rate >= LPROCFS_NRS_RATE_MAX)
+			return -EINVAL;
+
+		if (cmd->tc_cmd == NRS_CTL_TBF_START_RULE) {
+			if (is_min)
+				cmd->u.tc_start.ts_rate_min = rate;
+			else
+				cmd->u.tc_start.ts_rate_max = rate;
+		} else if (cmd->tc_cmd == NRS_CTL_TBF_CHANGE_RULE) {
+			if (is_min)
+				cmd->u.tc_change.tc_rate_min = rate;
+			else
+				cmd->u.tc_change.tc_rate_max = rate;
+		} else {
+			return -EINVAL;
+		}
+	} else if (strcmp(key, "adaptive") == 0) {
+		/* only "adaptive=0", turning an adaptive rule static again */
+		if (cmd->tc_cmd != NRS_CTL_TBF_CHANGE_RULE ||
+		    strcmp(val, "0") != 0)
+			return -EINVAL;
+
+		cmd->u.tc_change.tc_static = true;
 	} else if (strcmp(key, "realtime") == 0) {
 		unsigned long realtime;
 
@@ -3466,7 +3737,14 @@ nrs_tbf_parse_value_pairs(struct nrs_tbf_cmd *cmd, char *buffer)
 		break;
 	case NRS_CTL_TBF_CHANGE_RULE:
 		if (cmd->u.tc_change.tc_rpc_rate == 0 &&
-		    cmd->u.tc_change.tc_next_name == NULL)
+		    cmd->u.tc_change.tc_next_name == NULL &&
+		    cmd->u.tc_change.tc_rate_min == 0 &&
+		    cmd->u.tc_change.tc_rate_max == 0 &&
+		    !cmd->u.tc_change.tc_static)
+			return -EINVAL;
+		if (cmd->u.tc_change.tc_static &&
+		    (cmd->u.tc_change.tc_rate_min != 0 ||
+		     cmd->u.tc_change.tc_rate_max != 0))
 			return -EINVAL;
 		break;
 	case NRS_CTL_TBF_STOP_RULE:
@@ -3653,6 +3931,95 @@ out:
 
 LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_tbf_rule);
 
+/**
+ * The maximum target service latency of the adaptive rate control, in usec.
+ */
+#define LPROCFS_NRS_TBF_LATENCY_MAX	60000000U	/* 60s */
+
+/**
+ * Shows the adaptive rate control state of the TBF policy instances of a
+ * service: the target and measured service latency, the load of each
+ * partition, how often the controller changed rates and the current rates
+ * of the adaptive rules.
+ */
+static int
+ptlrpc_lprocfs_nrs_tbf_adaptive_seq_show(struct seq_file *m, void *data)
+{
+	struct ptlrpc_service *svc = m->private;
+	int rc;
+
+	seq_printf(m, "regular_requests:\n");
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+				       NRS_POL_NAME_TBF,
+				       NRS_CTL_TBF_RD_ADAPTIVE,
+				       false, m);
+	if (rc == -ENOSPC)
+		return 0;
+	else if (rc != 0 && rc != -ENODEV)
+		return rc;
+
+	if (!nrs_svc_has_hp(svc))
+		return rc;
+
+	seq_printf(m, "high_priority_requests:\n");
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+				       NRS_POL_NAME_TBF,
+				       NRS_CTL_TBF_RD_ADAPTIVE,
+				       false, m);
+	if (rc == -ENOSPC)
+		return 0;
+
+	return rc;
+}
+
+/**
+ * Sets the target service latency of the TBF policy instances on both NRS
+ * heads of a service, in usec; 0 stops the adaptation, leaving the adaptive
+ * rules at their current rates.
+ *
+ * For example:
+ *
+ * lctl set_param ost.OSS.ost_io.nrs_tbf_adaptive=50000
+ */
+static ssize_t
+ptlrpc_lprocfs_nrs_tbf_adaptive_seq_write(struct file *file,
+					  const char __user *buffer,
+					  size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	__u32 target;
+	int rc;
+	int rc2 = -ENODEV;
+
+	rc = kstrtouint_from_user(buffer, count, 0, &target);
+	if (rc)
+		return rc;
+
+	if (target > LPROCFS_NRS_TBF_LATENCY_MAX)
+		return -EINVAL;
+
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+				       NRS_POL_NAME_TBF,
+				       NRS_CTL_TBF_WR_ADAPTIVE, false,
+				       &target);
+	if (rc < 0 && rc != -ENODEV)
+		return rc;
+
+	if (nrs_svc_has_hp(svc)) {
+		rc2 = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+						NRS_POL_NAME_TBF,
+						NRS_CTL_TBF_WR_ADAPTIVE, false,
+						&target);
+		if (rc2 < 0 && rc2 != -ENODEV)
+			return rc2;
+	}
+
+	return rc == -ENODEV && rc2 == -ENODEV ? -ENODEV : count;
+}
+
+LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_tbf_adaptive);
+
 /**
  * Initializes a TBF policy's lprocfs interface for service \a svc
  *
@@ -3667,6 +4034,9 @@ static int nrs_tbf_lprocfs_init(struct ptlrpc_service *svc)
 		{ .name		= "nrs_tbf_rule",
 		  .fops		= &ptlrpc_lprocfs_nrs_tbf_rule_fops,
 		  .data = svc },
+		{ .name		= "nrs_tbf_adaptive",
+		  .fops		= &ptlrpc_lprocfs_nrs_tbf_adaptive_fops,
+		  .data = svc },
 		{ NULL }
 	};
 
@@ -306,6 +306,58 @@ void lustre_put_emerg_rs(struct ptlrpc_reply_state *rs)
 	wake_up(&svcpt->scp_rep_waitq);
 }
 
+/*
+ * Reply states of PTLRPC_RS_POOL_SIZE for the small replies. The slab keeps
+ * them in per-CPU caches and gives them back to the system under memory
+ * pressure.
+ */
+static struct kmem_cache *ptlrpc_rs_cache;
+
+int ptlrpc_rs_cache_init(void)
+{
+	ptlrpc_rs_cache = kmem_cache_create("ptlrpc_rs_cache",
+					    PTLRPC_RS_POOL_SIZE, 0,
+					    SLAB_HWCACHE_ALIGN, NULL);
+	return ptlrpc_rs_cache ? 0 : -ENOMEM;
+}
+
+void ptlrpc_rs_cache_fini(void)
+{
+	kmem_cache_destroy(ptlrpc_rs_cache);
+}
+
+/**
+ * Allocate a reply state of PTLRPC_RS_POOL_SIZE for a reply of \a svcpt
+ * from ptlrpc_rs_cache.
+ */
+struct ptlrpc_reply_state *
+lustre_get_pool_rs(struct ptlrpc_service_part *svcpt, int size)
+{
+	struct ptlrpc_service *svc = svcpt->scp_service;
+	struct ptlrpc_reply_state *rs;
+
+	LASSERT(size <= PTLRPC_RS_POOL_SIZE);
+
+	OBD_SLAB_CPT_ALLOC(rs, ptlrpc_rs_cache, svc->srv_cptable,
+			   svcpt->scp_cpt, PTLRPC_RS_POOL_SIZE);
+	if (rs == NULL)
+		return NULL;
+
+	rs->rs_size = PTLRPC_RS_POOL_SIZE;
+	rs->rs_svcpt = svcpt;
+	rs->rs_pooled = 1;
+
+	if (likely(svc->srv_stats != NULL))
+		lprocfs_counter_incr(svc->srv_stats, PTLRPC_REPPOOL_CNTR);
+
+	return rs;
+}
+
+void lustre_put_pool_rs(struct ptlrpc_reply_state *rs)
+{
+	OBD_SLAB_FREE(rs, ptlrpc_rs_cache, PTLRPC_RS_POOL_SIZE);
+}
+
 int lustre_pack_reply_v2(struct ptlrpc_request *req, int count,
 			 __u32 *lens, char **bufs, int flags)
 {
@@ -1831,7 +1883,7 @@ void lustre_swab_obdo(struct obdo *o)
 	__swab32s(&o->o_gid_h);
 	__swab64s(&o->o_data_version);
 	__swab32s(&o->o_projid);
-	BUILD_BUG_ON(offsetof(typeof(*o), o_padding_4) == 0);
+	__swab32s(&o->o_compr_len);
 	BUILD_BUG_ON(offsetof(typeof(*o), o_padding_5) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*o), o_padding_6) == 0);
 
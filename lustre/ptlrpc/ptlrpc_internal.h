@@ -52,6 +52,11 @@ extern struct ptlrpc_nrs_pol_conf nrs_conf_crrn;
 extern struct ptlrpc_nrs_pol_conf nrs_conf_orr;
 extern struct ptlrpc_nrs_pol_conf nrs_conf_trr;
 extern struct ptlrpc_nrs_pol_conf nrs_conf_tbf;
+extern struct ptlrpc_nrs_pol_conf nrs_conf_drr;
+
+/* nrs_tbf.c */
+int nrs_tbf_id_cli_set(struct ptlrpc_request *req, struct tbf_id *id,
+		       enum nrs_tbf_flag ti_type);
 #endif /* HAVE_SERVER_SUPPORT */
 
 /**
@@ -154,6 +159,8 @@ void ptlrpc_nrs_req_finalize(struct ptlrpc_request *req);
 void ptlrpc_nrs_req_stop_nolock(struct ptlrpc_request *req);
 void ptlrpc_nrs_req_add(struct ptlrpc_service_part *svcpt,
 			struct ptlrpc_request *req, bool hp);
+int ptlrpc_nrs_req_add_batch(struct ptlrpc_service_part *svcpt,
+			     struct list_head *reqs, bool hp);
 
 struct ptlrpc_request *
 ptlrpc_nrs_req_get_nolock0(struct ptlrpc_service_part *svcpt, bool hp,
@@ -271,6 +278,11 @@ void ptlrpc_fill_bulk_md(struct lnet_md *md, struct ptlrpc_bulk_desc *desc,
 struct ptlrpc_reply_state *
 lustre_get_emerg_rs(struct ptlrpc_service_part *svcpt);
 void lustre_put_emerg_rs(struct ptlrpc_reply_state *rs);
+struct ptlrpc_reply_state *
+lustre_get_pool_rs(struct ptlrpc_service_part *svcpt, int size);
+void lustre_put_pool_rs(struct ptlrpc_reply_state *rs);
+int ptlrpc_rs_cache_init(void);
+void ptlrpc_rs_cache_fini(void);
 void lustre_msg_early_size_init(void); /* just for init */
 
 /* pinger.c */
@@ -137,6 +137,17 @@ module_param(ptlrpcd_cpts, charp, 0644);
 MODULE_PARM_DESC(ptlrpcd_cpts,
 		 "CPU partitions ptlrpcd threads should run in");
 
+/*
+ * ptlrpcd_import_affinity: run ptlrpcd work items (e.g. the osc writeback
+ * work that builds BRW RPCs) on the CPT of the import peer rather than on
+ * the CPT of the queueing thread, so RPCs for the stripes of one large I/O
+ * are built concurrently on several CPTs instead of all on the caller's.
+ */
+static int ptlrpcd_import_affinity = 1;
+module_param(ptlrpcd_import_affinity, int, 0644);
+MODULE_PARM_DESC(ptlrpcd_import_affinity,
+		 "Run ptlrpcd work on the CPT of the import peer (default 1)");
+
 /* ptlrpcds_cpt_idx maps cpt numbers to an index in the ptlrpcds array. */
 static int		*ptlrpcds_cpt_idx;
 
@@ -176,6 +187,12 @@ ptlrpcd_select_pc(struct ptlrpc_request *req)
 		return &ptlrpcd_rcv;
 
 	cpt = cfs_cpt_current(cfs_cpt_tab, 1);
+	if (req != NULL && req->rq_import_affinity && ptlrpcd_import_affinity) {
+		int imp_cpt = READ_ONCE(req->rq_import->imp_cpt);
+
+		if (imp_cpt >= 0 && imp_cpt < cfs_cpt_number(cfs_cpt_tab))
+			cpt = imp_cpt;
+	}
 	if (ptlrpcds_cpt_idx == NULL)
 		idx = cpt;
 	else
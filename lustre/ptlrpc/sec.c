@@ -2283,6 +2283,7 @@ int sptlrpc_svc_unwrap_request(struct ptlrpc_request *req)
  */
 int sptlrpc_svc_alloc_rs(struct ptlrpc_request *req, int msglen)
 {
+	struct ptlrpc_service_part *svcpt;
 	struct ptlrpc_sec_policy *policy;
 	struct ptlrpc_reply_state *rs;
 	int rc;
@@ -2295,10 +2296,24 @@ int sptlrpc_svc_alloc_rs(struct ptlrpc_request *req, int msglen)
 	policy = req->rq_svc_ctx->sc_policy;
 	LASSERT(policy->sp_sops->alloc_rs);
 
+	svcpt = req->rq_rqbd->rqbd_svcpt;
+	/*
+	 * small replies of the null flavor, which adds nothing to the message,
+	 * take their reply state from the reply state cache if enabled
+	 */
+	if (policy->sp_policy == SPTLRPC_POLICY_NULL &&
+	    svcpt->scp_service->srv_rep_pool &&
+	    sizeof(*rs) + msglen <= PTLRPC_RS_POOL_SIZE)
+		req->rq_reply_state = lustre_get_pool_rs(svcpt,
+							 sizeof(*rs) + msglen);
+
 	rc = policy->sp_sops->alloc_rs(req, msglen);
+	if (unlikely(rc != 0 && req->rq_reply_state != NULL &&
+		     req->rq_reply_state->rs_pooled)) {
+		lustre_put_pool_rs(req->rq_reply_state);
+		req->rq_reply_state = NULL;
+	}
 	if (unlikely(rc == -ENOMEM)) {
-		struct ptlrpc_service_part *svcpt = req->rq_rqbd->rqbd_svcpt;
-
 		if (svcpt->scp_service->srv_max_reply_size <
 		   msglen + sizeof(struct ptlrpc_reply_state)) {
 			/* Just return failure if the size is too big */
@@ -2359,6 +2374,7 @@ void sptlrpc_svc_free_rs(struct ptlrpc_reply_state *rs)
 {
 	struct ptlrpc_sec_policy *policy;
 	unsigned int prealloc;
+	unsigned int pooled;
 
 	ENTRY;
 
@@ -2369,10 +2385,13 @@ void sptlrpc_svc_free_rs(struct ptlrpc_reply_state *rs)
 	LASSERT(policy->sp_sops->free_rs);
 
 	prealloc = rs->rs_prealloc;
+	pooled = rs->rs_pooled;
 	policy->sp_sops->free_rs(rs);
 
 	if (prealloc)
 		lustre_put_emerg_rs(rs);
+	else if (pooled)
+		lustre_put_pool_rs(rs);
 	EXIT;
 }
 
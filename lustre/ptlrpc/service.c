@@ -65,6 +65,12 @@ static void ptlrpc_server_hpreq_fini(struct ptlrpc_request *req);
 static void ptlrpc_at_remove_timed(struct ptlrpc_request *req);
 static int ptlrpc_start_threads(struct ptlrpc_service *svc);
 static int ptlrpc_start_thread(struct ptlrpc_service_part *svcpt, int wait);
+static inline bool ptlrpc_thread_should_stop(struct ptlrpc_thread *thread);
+static inline int
+ptlrpc_server_request_incoming(struct ptlrpc_service_part *svcpt);
+static struct ptlrpc_request *
+ptlrpc_server_request_get_nolock(struct ptlrpc_service_part *svcpt,
+				 bool force);
 
 /** Holds a list of all PTLRPC services */
 LIST_HEAD(ptlrpc_all_services);
@@ -631,6 +637,7 @@ static int ptlrpc_service_part_init(struct ptlrpc_service *svc,
 
 	/* acitve requests and hp requests */
 	spin_lock_init(&svcpt->scp_req_lock);
+	svcpt->scp_thr_check = ktime_get();
 
 	/* reply states */
 	spin_lock_init(&svcpt->scp_rep_lock);
@@ -813,6 +820,7 @@ struct ptlrpc_service *ptlrpc_register_service(struct ptlrpc_service_conf *conf,
 	service->srv_thread_name	= conf->psc_thr.tc_thr_name;
 	service->srv_ctx_tags		= conf->psc_thr.tc_ctx_tags;
 	service->srv_hpreq_ratio	= PTLRPC_SVC_HP_RATIO;
+	service->srv_req_batch		= PTLRPC_SVC_REQ_BATCH;
 	service->srv_ops		= conf->psc_ops;
 
 	for (i = 0; i < ncpts; i++) {
@@ -1199,18 +1207,33 @@ static void ptlrpc_server_finish_request(struct ptlrpc_service_part *svcpt,
 /**
  * to finish an active request: stop sending more early replies, and release
  * the request. should be called after we finished handling the request.
+ *
+ * If \a thread is given, the next request for it to handle is taken from NRS
+ * under the same scp_req_lock and left in ptlrpc_thread::t_next_req, so that
+ * a busy thread takes the partition lock once per request instead of twice.
  */
 static void ptlrpc_server_finish_active_request(
 					struct ptlrpc_service_part *svcpt,
-					struct ptlrpc_request *req)
+					struct ptlrpc_request *req,
+					struct ptlrpc_thread *thread)
 {
+	struct ptlrpc_request *next = NULL;
+
 	spin_lock(&svcpt->scp_req_lock);
 	ptlrpc_nrs_req_stop_nolock(req);
 	svcpt->scp_nreqs_active--;
 	if (req->rq_hp)
 		svcpt->scp_nhreqs_active--;
+	if (thread != NULL)
+		next = ptlrpc_server_request_get_nolock(svcpt, false);
 	spin_unlock(&svcpt->scp_req_lock);
 
+	if (next != NULL) {
+		if (likely(next->rq_export))
+			class_export_rpc_inc(next->rq_export);
+		thread->t_next_req = next;
+	}
+
 	ptlrpc_nrs_req_finalize(req);
 
 	if (req->rq_export != NULL)
@@ -2055,8 +2078,14 @@ int ptlrpc_hpreq_handler(struct ptlrpc_request *req)
 }
 EXPORT_SYMBOL(ptlrpc_hpreq_handler);
 
+/**
+ * Prepares request \a req for NRS and queues it on \a reqs or, if it is a high
+ * priority one, on \a hpreqs, for ptlrpc_nrs_req_add_batch() to enqueue.
+ */
 static int ptlrpc_server_request_add(struct ptlrpc_service_part *svcpt,
-				     struct ptlrpc_request *req)
+				     struct ptlrpc_request *req,
+				     struct list_head *reqs,
+				     struct list_head *hpreqs)
 {
 	int rc;
 	bool hp;
@@ -2142,7 +2171,7 @@ static int ptlrpc_server_request_add(struct ptlrpc_service_part *svcpt,
 	req->rq_svc_thread = NULL;
 	req->rq_session.lc_thread = NULL;
 
-	ptlrpc_nrs_req_add(svcpt, req, hp);
+	list_add_tail(&req->rq_list, hp ? hpreqs : reqs);
 
 	RETURN(0);
 }
@@ -2257,13 +2286,12 @@ bool ptlrpc_server_request_pending(struct ptlrpc_service_part *svcpt,
  * Returns a pointer to fetched request.
  */
 static struct ptlrpc_request *
-ptlrpc_server_request_get(struct ptlrpc_service_part *svcpt, bool force)
+ptlrpc_server_request_get_nolock(struct ptlrpc_service_part *svcpt,
+				 bool force)
 {
 	struct ptlrpc_request *req = NULL;
 
-	ENTRY;
-
-	spin_lock(&svcpt->scp_req_lock);
+	assert_spin_locked(&svcpt->scp_req_lock);
 
 	if (ptlrpc_server_high_pending(svcpt, force)) {
 		req = ptlrpc_nrs_req_get_nolock(svcpt, true, force);
@@ -2281,54 +2309,65 @@ ptlrpc_server_request_get(struct ptlrpc_service_part *svcpt, bool force)
 		}
 	}
 
-	spin_unlock(&svcpt->scp_req_lock);
-	RETURN(NULL);
+	return NULL;
 
 got_request:
 	svcpt->scp_nreqs_active++;
 	if (req->rq_hp)
 		svcpt->scp_nhreqs_active++;
 
+	/* sample the queue wait and thread usage for ptlrpc_threads_adjust() */
+	if (svcpt->scp_service->srv_thr_target_wait != 0) {
+		s64 wait = ktime_us_delta(ktime_get_real(),
+				timespec64_to_ktime(req->rq_arrival_time));
+
+		svcpt->scp_thr_wait_sum += max_t(s64, wait, 0);
+		svcpt->scp_thr_busy_sum += svcpt->scp_nreqs_active * 100 /
+					   max(svcpt->scp_nthrs_running, 1);
+		svcpt->scp_thr_samples++;
+	}
+
+	return req;
+}
+
+static struct ptlrpc_request *
+ptlrpc_server_request_get(struct ptlrpc_service_part *svcpt, bool force)
+{
+	struct ptlrpc_request *req;
+
+	ENTRY;
+
+	spin_lock(&svcpt->scp_req_lock);
+	req = ptlrpc_server_request_get_nolock(svcpt, force);
 	spin_unlock(&svcpt->scp_req_lock);
 
-	if (likely(req->rq_export))
+	if (req != NULL && likely(req->rq_export))
 		class_export_rpc_inc(req->rq_export);
 
 	RETURN(req);
 }
 
 /**
- * Handle freshly incoming reqs, add to timed early reply list,
- * pass on to regular request queue.
- * All incoming requests pass through here before getting into
- * ptlrpc_server_handle_req later on.
+ * Handle a freshly incoming req, add it to timed early reply list and
+ * prepare it for the regular request queue; it is queued on \a reqs or
+ * \a hpreqs, to be handed over to NRS with the rest of its batch.
  */
-static int ptlrpc_server_handle_req_in(struct ptlrpc_service_part *svcpt,
-				       struct ptlrpc_thread *thread)
+static int ptlrpc_server_req_in(struct ptlrpc_service_part *svcpt,
+				struct ptlrpc_thread *thread,
+				struct ptlrpc_request *req,
+				struct list_head *reqs,
+				struct list_head *hpreqs)
 {
 	struct ptlrpc_service *svc = svcpt->scp_service;
-	struct ptlrpc_request *req;
 	__u32 deadline;
 	__u32 opc;
 	int rc;
 
 	ENTRY;
 
-	spin_lock(&svcpt->scp_lock);
-	if (list_empty(&svcpt->scp_req_incoming)) {
-		spin_unlock(&svcpt->scp_lock);
-		RETURN(0);
-	}
-
-	req = list_first_entry(&svcpt->scp_req_incoming,
-			       struct ptlrpc_request, rq_list);
-	list_del_init(&req->rq_list);
-	svcpt->scp_nreqs_incoming--;
-	/*
-	 * Consider this still a "queued" request as far as stats are
-	 * concerned
-	 */
-	spin_unlock(&svcpt->scp_lock);
+	/* drop the session of the previous request of the batch */
+	if (thread != NULL)
+		thread->t_env->le_ses = NULL;
 
 	/* go through security check/transform */
 	rc = sptlrpc_svc_unwrap_request(req);
@@ -2469,17 +2508,75 @@ static int ptlrpc_server_handle_req_in(struct ptlrpc_service_part *svcpt,
 	}
 
 	/* Move it over to the request processing queue */
-	rc = ptlrpc_server_request_add(svcpt, req);
+	rc = ptlrpc_server_request_add(svcpt, req, reqs, hpreqs);
 	if (rc)
 		GOTO(err_req, rc);
 
-	wake_up(&svcpt->scp_waitq);
-	RETURN(1);
+	RETURN(0);
 
 err_req:
 	ptlrpc_server_finish_request(svcpt, req);
 
-	RETURN(1);
+	RETURN(rc ? rc : -EINVAL);
+}
+
+/**
+ * Handle freshly incoming reqs, add to timed early reply list,
+ * pass on to regular request queue.
+ * All incoming requests pass through here before getting into
+ * ptlrpc_server_handle_req later on.
+ *
+ * Up to ptlrpc_service::srv_req_batch requests are taken off the incoming
+ * queue under one scp_lock, and those accepted are handed over to NRS under
+ * one scp_req_lock, so a flood of small RPCs does not bounce the partition
+ * locks between the LNet callbacks and the service threads for each of them.
+ *
+ * \retval the number of incoming requests handled
+ */
+static int ptlrpc_server_handle_req_in(struct ptlrpc_service_part *svcpt,
+				       struct ptlrpc_thread *thread)
+{
+	struct ptlrpc_request *req;
+	LIST_HEAD(incoming);
+	LIST_HEAD(reqs);
+	LIST_HEAD(hpreqs);
+	int batch = max(svcpt->scp_service->srv_req_batch, 1);
+	int count = 0;
+	int queued;
+
+	ENTRY;
+
+	spin_lock(&svcpt->scp_lock);
+	while (count < batch &&
+	       (req = list_first_entry_or_null(&svcpt->scp_req_incoming,
+					       struct ptlrpc_request,
+					       rq_list)) != NULL) {
+		list_move_tail(&req->rq_list, &incoming);
+		svcpt->scp_nreqs_incoming--;
+		count++;
+	}
+	/*
+	 * Consider these still "queued" requests as far as stats are
+	 * concerned
+	 */
+	spin_unlock(&svcpt->scp_lock);
+
+	if (count == 0)
+		RETURN(0);
+
+	while ((req = list_first_entry_or_null(&incoming,
+					       struct ptlrpc_request,
+					       rq_list)) != NULL) {
+		list_del_init(&req->rq_list);
+		ptlrpc_server_req_in(svcpt, thread, req, &reqs, &hpreqs);
+	}
+
+	queued = ptlrpc_nrs_req_add_batch(svcpt, &hpreqs, true);
+	queued += ptlrpc_nrs_req_add_batch(svcpt, &reqs, false);
+	if (queued > 0)
+		wake_up_nr(&svcpt->scp_waitq, queued);
+
+	RETURN(count);
 }
 
 /**
@@ -2501,7 +2598,11 @@ static int ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 
 	ENTRY;
 
-	request = ptlrpc_server_request_get(svcpt, false);
+	request = thread->t_next_req;
+	if (request != NULL)
+		thread->t_next_req = NULL;
+	else
+		request = ptlrpc_server_request_get(svcpt, false);
 	if (request == NULL)
 		RETURN(0);
 
@@ -2633,7 +2734,14 @@ put_conn:
 			  div_u64(arrived_usecs, USEC_PER_SEC));
 	}
 
-	ptlrpc_server_finish_active_request(svcpt, request);
+	/*
+	 * Take the next request while retiring this one, unless the thread
+	 * has incoming requests to handle first or is about to stop.
+	 */
+	if (svc->srv_req_batch <= 1 || ptlrpc_server_request_incoming(svcpt) ||
+	    ptlrpc_thread_should_stop(thread))
+		thread = NULL;
+	ptlrpc_server_finish_active_request(svcpt, request, thread);
 
 	RETURN(1);
 }
@@ -2846,11 +2954,103 @@ static inline int ptlrpc_threads_increasable(struct ptlrpc_service_part *svcpt)
 
 /**
  * too many requests and allowed to create more threads
+ *
+ * When the service is scaled to a queue wait target, also start the threads
+ * ptlrpc_threads_adjust() wants, and only start threads on a burst if the
+ * requests of the current interval already wait longer than the target.
  */
 static inline int ptlrpc_threads_need_create(struct ptlrpc_service_part *svcpt)
 {
-	return !ptlrpc_threads_enough(svcpt) &&
-		ptlrpc_threads_increasable(svcpt);
+	int target = svcpt->scp_service->srv_thr_target_wait;
+
+	if (!ptlrpc_threads_increasable(svcpt))
+		return 0;
+
+	if (target == 0)
+		return !ptlrpc_threads_enough(svcpt);
+
+	return svcpt->scp_nthrs_running + svcpt->scp_nthrs_starting <
+	       svcpt->scp_nthrs_want ||
+	       (!ptlrpc_threads_enough(svcpt) &&
+		svcpt->scp_thr_wait_sum >
+		(__u64)target * svcpt->scp_thr_samples);
+}
+
+/**
+ * Scales the threads of \a svcpt to the queue wait target of its service,
+ * once every PTLRPC_THR_ADJUST_INTERVAL.
+ *
+ * If the requests dispatched in the interval waited longer than the target,
+ * a quarter more threads are wanted; if they waited less than half of it and
+ * fewer than half of the threads were busy, one thread less. The count stays
+ * within threads_min and threads_max. Missing threads are started by the
+ * service threads, extra ones stop from the highest numbered down, see
+ * ptlrpc_thread_should_stop().
+ */
+static void ptlrpc_threads_adjust(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service *svc = svcpt->scp_service;
+	ktime_t now = ktime_get();
+	__u32 target = svc->srv_thr_target_wait;
+	int running;
+	int want;
+
+	if (target == 0 ||
+	    ktime_ms_delta(now, svcpt->scp_thr_check) <
+	    PTLRPC_THR_ADJUST_INTERVAL)
+		return;
+
+	spin_lock(&svcpt->scp_req_lock);
+	if (ktime_ms_delta(now, svcpt->scp_thr_check) <
+	    PTLRPC_THR_ADJUST_INTERVAL) {
+		spin_unlock(&svcpt->scp_req_lock);
+		return;
+	}
+
+	if (svcpt->scp_thr_samples != 0) {
+		svcpt->scp_thr_wait_avg = div_u64(svcpt->scp_thr_wait_sum,
+						  svcpt->scp_thr_samples);
+		svcpt->scp_thr_busy_avg = div_u64(svcpt->scp_thr_busy_sum,
+						  svcpt->scp_thr_samples);
+	} else {
+		svcpt->scp_thr_wait_avg = 0;
+		svcpt->scp_thr_busy_avg = 0;
+	}
+	svcpt->scp_thr_wait_sum = 0;
+	svcpt->scp_thr_busy_sum = 0;
+	svcpt->scp_thr_samples = 0;
+	svcpt->scp_thr_check = now;
+
+	running = svcpt->scp_nthrs_running;
+	want = running;
+	if (svcpt->scp_thr_wait_avg > target)
+		want = running + max(running / 4, 1);
+	else if (svcpt->scp_thr_wait_avg < target / 2 &&
+		 svcpt->scp_thr_busy_avg < 50)
+		want = running - 1;
+	want = clamp(want, svc->srv_nthrs_cpt_init, svc->srv_nthrs_cpt_limit);
+
+	if (want > running)
+		svcpt->scp_thr_grown++;
+	else if (want < running)
+		svcpt->scp_thr_shrunk++;
+	spin_unlock(&svcpt->scp_req_lock);
+
+	spin_lock(&svcpt->scp_lock);
+	svcpt->scp_nthrs_want = want;
+	spin_unlock(&svcpt->scp_lock);
+
+	if (want == running)
+		return;
+
+	CDEBUG(D_RPCTRACE,
+	       "%s[%d]: %s to %d threads, wait %uus target %uus, busy %u%%\n",
+	       svc->srv_name, svcpt->scp_cpt, want > running ? "grow" : "shrink",
+	       want, svcpt->scp_thr_wait_avg, target, svcpt->scp_thr_busy_avg);
+
+	/* wake the idle threads up, for the highest numbered one to stop */
+	if (want < running)
+		wake_up_all(&svcpt->scp_waitq);
 }
 
 static inline int ptlrpc_thread_stopping(struct ptlrpc_thread *thread)
@@ -2863,8 +3063,11 @@ static inline int ptlrpc_thread_stopping(struct ptlrpc_thread *thread)
 static inline bool ptlrpc_thread_should_stop(struct ptlrpc_thread *thread)
 {
 	struct ptlrpc_service_part *svcpt = thread->t_svcpt;
+	struct ptlrpc_service *svc = svcpt->scp_service;
 
-	return thread->t_id >= svcpt->scp_service->srv_nthrs_cpt_limit &&
+	return (thread->t_id >= svc->srv_nthrs_cpt_limit ||
+		(svc->srv_thr_target_wait != 0 && svcpt->scp_nthrs_want != 0 &&
+		 thread->t_id >= svcpt->scp_nthrs_want)) &&
 		thread->t_id == svcpt->scp_thr_nextid - 1;
 }
 
@@ -2882,6 +3085,7 @@ static inline void ptlrpc_thread_stop(struct ptlrpc_thread *thread)
 	spin_lock(&svcpt->scp_lock);
 	if (ptlrpc_thread_should_stop(thread)) {
 		ptlrpc_stop_thread(thread);
+		thread_add_flags(thread, SVC_RETIRED);
 		svcpt->scp_thr_nextid--;
 	}
 	spin_unlock(&svcpt->scp_lock);
@@ -2977,6 +3181,8 @@ ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 		wait_event_idle_exclusive_lifo(
 			svcpt->scp_waitq,
 			ptlrpc_thread_stopping(thread) ||
+			ptlrpc_thread_should_stop(thread) ||
+			thread->t_next_req != NULL ||
 			ptlrpc_server_request_incoming(svcpt) ||
 			ptlrpc_server_request_pending(svcpt, false) ||
 			ptlrpc_rqbd_pending(svcpt) ||
@@ -2984,6 +3190,8 @@ ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 	else if (wait_event_idle_exclusive_lifo_timeout(
 			 svcpt->scp_waitq,
 			 ptlrpc_thread_stopping(thread) ||
+			 ptlrpc_thread_should_stop(thread) ||
+			 thread->t_next_req != NULL ||
 			 ptlrpc_server_request_incoming(svcpt) ||
 			 ptlrpc_server_request_pending(svcpt, false) ||
 			 ptlrpc_rqbd_pending(svcpt) ||
@@ -3132,6 +3340,7 @@ static int ptlrpc_main(void *arg)
 
 		ptlrpc_check_rqbd_pool(svcpt);
 
+		ptlrpc_threads_adjust(svcpt);
 		if (ptlrpc_threads_need_create(svcpt)) {
 			/* Ignore return code - we tried... */
 			ptlrpc_start_thread(svcpt, 0);
@@ -3146,11 +3355,11 @@ static int ptlrpc_main(void *arg)
 		/* Process all incoming reqs before handling any */
 		if (ptlrpc_server_request_incoming(svcpt)) {
 			lu_context_enter(&env->le_ctx);
-			ptlrpc_server_handle_req_in(svcpt, thread);
+			counter += ptlrpc_server_handle_req_in(svcpt, thread);
 			lu_context_exit(&env->le_ctx);
 
 			/* but limit ourselves in case of flood */
-			if (counter++ < 100)
+			if (counter < 100)
 				continue;
 			counter = 0;
 			idle = false;
@@ -3159,7 +3368,8 @@ static int ptlrpc_main(void *arg)
 		if (ptlrpc_at_check(svcpt))
 			ptlrpc_at_check_timed(svcpt);
 
-		if (ptlrpc_server_request_pending(svcpt, false)) {
+		if (thread->t_next_req != NULL ||
+		    ptlrpc_server_request_pending(svcpt, false)) {
 			lu_context_enter(&env->le_ctx);
 			ptlrpc_server_handle_request(svcpt, thread);
 			lu_context_exit(&env->le_ctx);
@@ -3191,12 +3401,20 @@ static int ptlrpc_main(void *arg)
 		 * thread should be stopped, then stop in reverse order so the
 		 * the threads always have contiguous thread index values.
 		 */
-		if (unlikely(ptlrpc_thread_should_stop(thread)))
+		if (unlikely(ptlrpc_thread_should_stop(thread)) &&
+		    thread->t_next_req == NULL)
 			ptlrpc_thread_stop(thread);
 	}
 
 	ptlrpc_watchdog_disable(&thread->t_watchdog);
 
+	/* the service is stopping, drop the request taken in advance */
+	if (thread->t_next_req != NULL) {
+		ptlrpc_server_finish_active_request(svcpt, thread->t_next_req,
+						    NULL);
+		thread->t_next_req = NULL;
+	}
+
 out_ctx_fini:
 	lu_context_fini(&env->le_ctx);
 out_env_remove:
@@ -3472,8 +3690,11 @@ static int ptlrpc_start_threads(struct ptlrpc_service *svc)
 static int ptlrpc_start_thread(struct ptlrpc_service_part *svcpt, int wait)
 {
 	struct ptlrpc_thread *thread;
+	struct ptlrpc_thread *stopped;
+	struct ptlrpc_thread *tmp;
 	struct ptlrpc_service *svc;
 	struct task_struct *task;
+	LIST_HEAD(zombie);
 	int rc;
 
 	ENTRY;
@@ -3529,12 +3750,39 @@ static int ptlrpc_start_thread(struct ptlrpc_service_part *svcpt, int wait)
 
 	svcpt->scp_nthrs_starting++;
 	thread->t_id = svcpt->scp_thr_nextid++;
+	/* a thread started on a burst is wanted until the next adjustment */
+	if (svcpt->scp_nthrs_want != 0 &&
+	    svcpt->scp_nthrs_want < svcpt->scp_thr_nextid)
+		svcpt->scp_nthrs_want = svcpt->scp_thr_nextid;
 	thread_add_flags(thread, SVC_STARTING);
 	thread->t_svcpt = svcpt;
 
+	/*
+	 * Reap the threads which stopped as the thread count went down, so
+	 * a service which keeps growing and shrinking does not pile them up.
+	 * The other stopped threads may still be waited for, by the caller
+	 * which started them if they failed to start, or by
+	 * ptlrpc_svcpt_stop_threads() which frees them.
+	 */
+	if (!svc->srv_is_stopping) {
+		list_for_each_entry_safe(stopped, tmp, &svcpt->scp_threads,
+					 t_link) {
+			if (thread_is_stopped(stopped) &&
+			    thread_is_retired(stopped))
+				list_move(&stopped->t_link, &zombie);
+		}
+	}
+
 	list_add(&thread->t_link, &svcpt->scp_threads);
 	spin_unlock(&svcpt->scp_lock);
 
+	while ((stopped = list_first_entry_or_null(&zombie,
+						   struct ptlrpc_thread,
+						   t_link)) != NULL) {
+		list_del(&stopped->t_link);
+		OBD_FREE_PTR(stopped);
+	}
+
 	if (svcpt->scp_cpt >= 0) {
 		snprintf(thread->t_name, PTLRPC_THR_NAME_LEN, "%s%02d_%03d",
 			 svc->srv_thread_name, svcpt->scp_cpt, thread->t_id);
@@ -3792,7 +4040,7 @@ ptlrpc_service_purge_all(struct ptlrpc_service *svc)
 
 		while (ptlrpc_server_request_pending(svcpt, true)) {
 			req = ptlrpc_server_request_get(svcpt, true);
-			ptlrpc_server_finish_active_request(svcpt, req);
+			ptlrpc_server_finish_active_request(svcpt, req, NULL);
 		}
 
 		/*
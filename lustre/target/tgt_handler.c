@@ -37,6 +37,9 @@
 #include <linux/user_namespace.h>
 #include <linux/delay.h>
 #include <linux/uidgid.h>
+#include <linux/vmalloc.h>
+#include <linux/lz4.h>
+#include <asm/unaligned.h>
 
 #include <libcfs/linux/linux-mem.h>
 #include <obd.h>
@@ -182,12 +185,70 @@ out:
 }
 EXPORT_SYMBOL(tgt_validate_obdo);
 
+/*
+ * A write RPC from a client with OBD_CONNECT2_MULTIOBJ_BRW can carry the
+ * data of several objects, one obd_ioobj each. The first object is described
+ * by the ost_body, the obdos of the others come in RMF_OBD_IOOBJ_OA.
+ */
+static int tgt_io_multiobj_unpack(struct tgt_session_info *tsi,
+				  struct obd_ioobj *ioo, int obj_count)
+{
+	struct req_capsule	*pill = tsi->tsi_pill;
+	struct lu_nodemap	*nodemap;
+	struct obdo		*oa;
+	int			 i;
+	int			 rc;
+
+	ENTRY;
+
+	if (lustre_msg_get_opc(tgt_ses_req(tsi)->rq_reqmsg) != OST_WRITE ||
+	    !exp_connect_multiobj_brw(tsi->tsi_exp) ||
+	    !req_capsule_field_present(pill, &RMF_OBD_IOOBJ_OA, RCL_CLIENT) ||
+	    req_capsule_get_size(pill, &RMF_OBD_IOOBJ_OA, RCL_CLIENT) !=
+	    (obj_count - 1) * sizeof(*oa)) {
+		CERROR("%s: client %s sent %d ioobjs: rc = %d\n",
+		       tgt_name(tsi->tsi_tgt),
+		       obd_export_nid2str(tsi->tsi_exp), obj_count, -EPROTO);
+		RETURN(-EPROTO);
+	}
+
+	oa = req_capsule_client_get(pill, &RMF_OBD_IOOBJ_OA);
+	if (oa == NULL)
+		RETURN(-EPROTO);
+
+	nodemap = nodemap_get_from_exp(tsi->tsi_exp);
+	if (IS_ERR(nodemap))
+		RETURN(PTR_ERR(nodemap));
+
+	for (i = 1; i < obj_count; i++, oa++) {
+		rc = tgt_validate_obdo(tsi, oa);
+		if (rc)
+			GOTO(out, rc);
+
+		oa->o_uid = nodemap_map_id(nodemap, NODEMAP_UID,
+					   NODEMAP_CLIENT_TO_FS, oa->o_uid);
+		oa->o_gid = nodemap_map_id(nodemap, NODEMAP_GID,
+					   NODEMAP_CLIENT_TO_FS, oa->o_gid);
+		oa->o_projid = nodemap_map_id(nodemap, NODEMAP_PROJID,
+					      NODEMAP_CLIENT_TO_FS,
+					      oa->o_projid);
+		ioo[i].ioo_oid = oa->o_oi;
+	}
+	rc = 0;
+out:
+	nodemap_putref(nodemap);
+	RETURN(rc);
+}
+
 static int tgt_io_data_unpack(struct tgt_session_info *tsi, struct ost_id *oi)
 {
 	unsigned		 max_brw;
 	struct niobuf_remote	*rnb;
 	struct obd_ioobj	*ioo;
 	int			 obj_count;
+	int			 bufcnt = 0;
+	int			 i;
+	int			 rc;
 
 	ENTRY;
 
@@ -215,20 +276,23 @@ static int tgt_io_data_unpack(struct tgt_session_info *tsi, struct ost_id *oi)
 		CERROR("%s: short ioobj\n", tgt_name(tsi->tsi_tgt));
 		RETURN(-EPROTO);
 	} else if (obj_count > 1) {
-		CERROR("%s: too many ioobjs (%d)\n", tgt_name(tsi->tsi_tgt),
-		       obj_count);
-		RETURN(-EPROTO);
+		rc = tgt_io_multiobj_unpack(tsi, ioo, obj_count);
+		if (rc)
+			RETURN(rc);
 	}
 
-	if (ioo->ioo_bufcnt == 0) {
-		CERROR("%s: ioo has zero bufcnt\n", tgt_name(tsi->tsi_tgt));
-		RETURN(-EPROTO);
+	for (i = 0; i < obj_count; i++) {
+		if (ioo[i].ioo_bufcnt == 0) {
+			CERROR("%s: ioo has zero bufcnt\n",
+			       tgt_name(tsi->tsi_tgt));
+			RETURN(-EPROTO);
+		}
+		bufcnt += ioo[i].ioo_bufcnt;
 	}
 
-	if (ioo->ioo_bufcnt > PTLRPC_MAX_BRW_PAGES) {
+	if (bufcnt > PTLRPC_MAX_BRW_PAGES) {
 		DEBUG_REQ(D_RPCTRACE, tgt_ses_req(tsi),
-			  "bulk has too many pages (%d)",
-			  ioo->ioo_bufcnt);
+			  "bulk has too many pages (%d)", bufcnt);
 		RETURN(-EPROTO);
 	}
 
@@ -2563,6 +2627,127 @@ static int tgt_shortio2pages(struct niobuf_local *local, int npages,
 	return 0;
 }
 
+#if IS_ENABLED(CONFIG_LZ4_DECOMPRESS)
+/* Attach pages of its own to @desc to receive a compressed write bulk */
+static int tgt_compr_bulk_prep(struct ptlrpc_bulk_desc *desc,
+			       unsigned int len)
+{
+	struct page *page;
+	int count;
+
+	while (len > 0) {
+		page = alloc_page(GFP_NOFS);
+		if (page == NULL)
+			return -ENOMEM;
+
+		count = min_t(unsigned int, len, PAGE_SIZE);
+		/* the desc holds the only reference from now on */
+		desc->bd_frag_ops->add_kiov_frag(desc, page, 0, count);
+		put_page(page);
+		len -= count;
+	}
+
+	return 0;
+}
+
+/*
+ * Decompress the chunks received in @desc into the local pages, see
+ * struct brw_compr_chunk for the format. A malformed bulk is reported
+ * as -EIO like other transfer errors so that the client resends it.
+ */
+static int tgt_compr_bulk2pages(struct ptlrpc_bulk_desc *desc,
+				struct niobuf_local *local, int npages,
+				unsigned int len)
+{
+	unsigned int pos = 0, done = 0, raw_len, clen, off, count;
+	struct page **pages;
+	char *src, *raw, *data, *ptr;
+	int i, j = 0;
+	int rc = 0;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(pages, desc->bd_iov_count);
+	if (pages == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < desc->bd_iov_count; i++)
+		pages[i] = desc->bd_vec[i].bv_page;
+	src = vmap(pages, desc->bd_iov_count, VM_MAP, PAGE_KERNEL);
+	if (src == NULL)
+		GOTO(out_pages, rc = -ENOMEM);
+
+	OBD_ALLOC_LARGE(raw, BRW_COMPR_CHUNK_SIZE);
+	if (raw == NULL)
+		GOTO(out_unmap, rc = -ENOMEM);
+
+	while (pos < len) {
+		if (len - pos < sizeof(struct brw_compr_chunk))
+			GOTO(out_free, rc = -EIO);
+
+		raw_len = get_unaligned_le32(src + pos);
+		clen = get_unaligned_le32(src + pos + sizeof(__u32));
+		pos += sizeof(struct brw_compr_chunk);
+		if (raw_len == 0 || raw_len > BRW_COMPR_CHUNK_SIZE ||
+		    clen > raw_len || clen > len - pos)
+			GOTO(out_free, rc = -EIO);
+
+		if (clen == raw_len) {
+			data = src + pos;
+		} else {
+			rc = LZ4_decompress_safe(src + pos, raw, clen, raw_len);
+			if (rc != raw_len)
+				GOTO(out_free, rc = -EIO);
+			rc = 0;
+			data = raw;
+		}
+		pos += clen;
+
+		for (off = 0; off < raw_len; off += count) {
+			while (j < npages && local[j].lnb_len == 0)
+				j++;
+			if (j == npages)
+				GOTO(out_free, rc = -EIO);
+
+			count = min_t(unsigned int, local[j].lnb_len - done,
+				      raw_len - off);
+			ptr = kmap_atomic(local[j].lnb_page);
+			memcpy(ptr + (local[j].lnb_page_offset & ~PAGE_MASK) +
+			       done, data + off, count);
+			kunmap_atomic(ptr);
+			done += count;
+			if (done == local[j].lnb_len) {
+				j++;
+				done = 0;
+			}
+		}
+	}
+
+	while (j < npages && local[j].lnb_len == 0)
+		j++;
+	if (j != npages)
+		rc = -EIO;
+out_free:
+	OBD_FREE_LARGE(raw, BRW_COMPR_CHUNK_SIZE);
+out_unmap:
+	vunmap(src);
+out_pages:
+	OBD_FREE_PTR_ARRAY_LARGE(pages, desc->bd_iov_count);
+	return rc;
+}
+#else
+static inline int tgt_compr_bulk_prep(struct ptlrpc_bulk_desc *desc,
+				      unsigned int len)
+{
+	return -EOPNOTSUPP;
+}
+
+static inline int tgt_compr_bulk2pages(struct ptlrpc_bulk_desc *desc,
+				       struct niobuf_local *local, int npages,
+				       unsigned int len)
+{
+	return -EOPNOTSUPP;
+}
+#endif
+
 static void tgt_warn_on_cksum(struct ptlrpc_request *req,
 			      struct ptlrpc_bulk_desc *desc,
 			      struct niobuf_local *local_nb, int npages,
@@ -2610,6 +2795,92 @@ static void tgt_warn_on_cksum(struct ptlrpc_request *req,
 			   client_cksum, server_cksum);
 }
 
+/*
+ * Prepare the local buffers of every object of a multi-object write, back to
+ * back in \a lnb and in the order of \a ioo. The first object is described
+ * by \a oa, the others by \a obj_oa. The local buffer count of each object
+ * is returned in \a obj_npages and the total in \a npages.
+ */
+static int tgt_brw_multi_preprw(const struct lu_env *env,
+				struct obd_export *exp, struct obdo *oa,
+				struct obdo *obj_oa, int objcount,
+				struct obd_ioobj *ioo,
+				struct niobuf_remote *rnb,
+				int *obj_npages, int *npages,
+				struct niobuf_local *lnb, ktime_t kstart)
+{
+	int i;
+	int rc = 0;
+
+	*npages = 0;
+	for (i = 0; i < objcount; i++) {
+		obj_npages[i] = PTLRPC_MAX_BRW_PAGES - *npages;
+		rc = obd_preprw(env, OBD_BRW_WRITE, exp,
+				i == 0 ? oa : &obj_oa[i - 1], 1, &ioo[i], rnb,
+				&obj_npages[i], lnb);
+		if (rc < 0)
+			break;
+		rnb += ioo[i].ioo_bufcnt;
+		lnb += obj_npages[i];
+		*npages += obj_npages[i];
+	}
+	if (rc == 0)
+		return 0;
+
+	/* release the objects already prepared */
+	while (i-- > 0) {
+		rnb -= ioo[i].ioo_bufcnt;
+		lnb -= obj_npages[i];
+		obd_commitrw(env, OBD_BRW_WRITE, exp,
+			     i == 0 ? oa : &obj_oa[i - 1], 1, &ioo[i], rnb,
+			     obj_npages[i], lnb, rc, 0, kstart);
+	}
+	return rc;
+}
+
+/*
+ * Commit every object prepared by tgt_brw_multi_preprw(). The overquota
+ * flags of all objects are returned to the client in \a oa, the objects of
+ * one RPC have the same owner.
+ */
+static int tgt_brw_multi_commitrw(const struct lu_env *env,
+				  struct obd_export *exp, struct obdo *oa,
+				  struct obdo *obj_oa, int objcount,
+				  struct obd_ioobj *ioo,
+				  struct niobuf_remote *rnb, int *obj_npages,
+				  struct niobuf_local *lnb, int old_rc,
+				  ktime_t kstart)
+{
+	struct obdo *o;
+	int i, j;
+	int nob;
+	int rc = 0;
+	int rc2;
+
+	for (i = 0; i < objcount; i++) {
+		o = i == 0 ? oa : &obj_oa[i - 1];
+		for (nob = j = 0; j < ioo[i].ioo_bufcnt; j++)
+			nob += rnb[j].rnb_len;
+
+		rc2 = obd_commitrw(env, OBD_BRW_WRITE, exp, o, 1, &ioo[i], rnb,
+				   obj_npages[i], lnb, old_rc, nob, kstart);
+		if (rc == 0)
+			rc = rc2;
+
+		if (o != oa && o->o_valid & OBD_MD_FLALLQUOTA) {
+			if (!(oa->o_valid & OBD_MD_FLFLAGS)) {
+				oa->o_valid |= OBD_MD_FLFLAGS;
+				oa->o_flags = 0;
+			}
+			oa->o_flags |= o->o_flags & OBD_FL_NO_QUOTA_ALL;
+			oa->o_valid |= OBD_MD_FLALLQUOTA;
+		}
+		rnb += ioo[i].ioo_bufcnt;
+		lnb += obj_npages[i];
+	}
+	return rc;
+}
+
 int tgt_brw_write(struct tgt_session_info *tsi)
 {
 	struct tgt_thread_info *tti = tgt_th_info(tsi->tsi_env);
@@ -2620,6 +2891,8 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 	struct niobuf_local	*local_nb;
 	struct obd_ioobj	*ioo;
 	struct ost_body		*body, *repbody;
+	struct obdo		*obj_oa = NULL;
+	int			*obj_npages = NULL;
 	struct lustre_handle	 lockh = {0};
 	__u32			*rcs;
 	int			 objcount, niocount, npages;
@@ -2629,6 +2902,7 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 	bool			 no_reply = false, mmap;
 	struct tgt_thread_big_cache *tbc = req->rq_svc_thread->t_data;
 	bool wait_sync = false;
+	bool compressed = false;
 	const char *obd_name = exp->exp_obd->obd_name;
 	/* '1' for consistency with code that checks !mpflag to restore */
 	unsigned int mpflags = 1;
@@ -2711,6 +2985,20 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 			sizeof(*remote_nb))
 		RETURN(err_serious(-EPROTO));
 
+	if (objcount > 1) {
+		/* only short io may carry several objects, without SRVLOCK */
+		if (!(body->oa.o_valid & OBD_MD_FLFLAGS &&
+		      body->oa.o_flags & OBD_FL_SHORT_IO) ||
+		    remote_nb[0].rnb_flags & OBD_BRW_SRVLOCK)
+			RETURN(err_serious(-EPROTO));
+
+		obj_oa = req_capsule_client_get(&req->rq_pill,
+						&RMF_OBD_IOOBJ_OA);
+		OBD_ALLOC_PTR_ARRAY(obj_npages, objcount);
+		if (obj_npages == NULL)
+			RETURN(-ENOMEM);
+	}
+
 	if ((remote_nb[0].rnb_flags & OBD_BRW_MEMALLOC) &&
 	    ptlrpc_connection_is_local(exp->exp_connection))
 		mpflags = memalloc_noreclaim_save();
@@ -2764,11 +3052,20 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 	if (repbody == NULL)
 		GOTO(out_lock, rc = -ENOMEM);
 	repbody->oa = body->oa;
+	repbody->oa.o_flags &= ~OBD_FL_COMPRESSED;
+	repbody->oa.o_compr_len = 0;
 
 	npages = PTLRPC_MAX_BRW_PAGES;
 	kstart = ktime_get();
-	rc = obd_preprw(tsi->tsi_env, OBD_BRW_WRITE, exp, &repbody->oa,
-			objcount, ioo, remote_nb, &npages, local_nb);
+	if (objcount > 1)
+		rc = tgt_brw_multi_preprw(tsi->tsi_env, exp, &repbody->oa,
+					  obj_oa, objcount, ioo, remote_nb,
+					  obj_npages, &npages, local_nb,
+					  kstart);
+	else
+		rc = obd_preprw(tsi->tsi_env, OBD_BRW_WRITE, exp,
+				&repbody->oa, objcount, ioo, remote_nb,
+				&npages, local_nb);
 	if (rc < 0)
 		GOTO(out_lock, rc);
 	if (body->oa.o_valid & OBD_MD_FLFLAGS &&
@@ -2788,6 +3085,34 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 		rc = tgt_shortio2pages(local_nb, npages, short_io_buf,
 				       short_io_size);
 		desc = NULL;
+	} else if (body->oa.o_valid & OBD_MD_FLFLAGS &&
+		   body->oa.o_flags & OBD_FL_COMPRESSED) {
+		unsigned int compr_len = body->oa.o_compr_len;
+
+		CDEBUG(D_INFO, "Client compressed bulk, size = %u\n",
+		       compr_len);
+		if (compr_len == 0 || compr_len > npages * PAGE_SIZE)
+			GOTO(skip_transfer, rc = -EPROTO);
+
+		desc = ptlrpc_prep_bulk_exp(req, DIV_ROUND_UP(compr_len,
+							      PAGE_SIZE),
+					    ioobj_max_brw_get(ioo),
+					    PTLRPC_BULK_GET_SINK,
+					    OST_BULK_PORTAL,
+					    &ptlrpc_bulk_kiov_pin_ops);
+		if (desc == NULL)
+			GOTO(skip_transfer, rc = -ENOMEM);
+
+		rc = tgt_compr_bulk_prep(desc, compr_len);
+		if (rc != 0)
+			GOTO(skip_transfer, rc);
+
+		rc = sptlrpc_svc_prep_bulk(req, desc);
+		if (rc != 0)
+			GOTO(skip_transfer, rc);
+
+		rc = target_bulk_io(exp, desc);
+		compressed = true;
 	} else {
 		desc = ptlrpc_prep_bulk_exp(req, npages, ioobj_max_brw_get(ioo),
 					    PTLRPC_BULK_GET_SINK,
@@ -2812,6 +3137,11 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 
 	no_reply = rc != 0;
 
+	/* reply -EIO to a corrupted bulk, the client will resend it */
+	if (compressed && rc == 0)
+		rc = tgt_compr_bulk2pages(desc, local_nb, npages,
+					  body->oa.o_compr_len);
+
 skip_transfer:
 	if (body->oa.o_valid & OBD_MD_FLCKSUM && rc == 0) {
 		static int cksum_counter;
@@ -2865,9 +3195,14 @@ out_commitrw:
 	tti->tti_mult_trans = 1;
 
 	/* Must commit after prep above in all cases */
-	rc = obd_commitrw(tsi->tsi_env, OBD_BRW_WRITE, exp, &repbody->oa,
-			  objcount, ioo, remote_nb, npages, local_nb, rc, nob,
-			  kstart);
+	if (objcount > 1)
+		rc = tgt_brw_multi_commitrw(tsi->tsi_env, exp, &repbody->oa,
+					    obj_oa, objcount, ioo, remote_nb,
+					    obj_npages, local_nb, rc, kstart);
+	else
+		rc = obd_commitrw(tsi->tsi_env, OBD_BRW_WRITE, exp,
+				  &repbody->oa, objcount, ioo, remote_nb,
+				  npages, local_nb, rc, nob, kstart);
 	if (rc == -ENOTCONN)
 		/* quota acquire process has been given up because
 		 * either the client has been evicted or the client
@@ -2927,6 +3262,9 @@ out:
 	if (mpflags)
 		memalloc_noreclaim_restore(mpflags);
 
+	if (obj_npages != NULL)
+		OBD_FREE_PTR_ARRAY(obj_npages, objcount);
+
 	RETURN(rc);
 }
 EXPORT_SYMBOL(tgt_brw_write);
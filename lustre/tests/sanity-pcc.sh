@@ -1491,6 +1491,95 @@ test_20() {
 }
 run_test 20 "Auto attach works after the inode was once evicted from cache"
 
+test_21() {
+	local loopfile="$TMP/$tfile"
+	local mntpt="/mnt/pcc.$tdir"
+	local hsm_root="$mntpt/$tdir"
+	local file1=$DIR/$tfile.1.ro
+	local file2=$DIR/$tfile.2.ro
+	local state="$LFS pcc state $file1 | awk -F 'type: ' '{print \$2}' |
+		awk -F ',' '{print \$1}'"
+	local lpcc_path1
+	local lpcc_path2
+
+	setup_loopdev $SINGLEAGT $loopfile $mntpt 50
+	do_facet $SINGLEAGT mkdir -p $hsm_root || error "mkdir $hsm_root failed"
+	setup_pcc_mapping $SINGLEAGT \
+		"fname={*.ro}\ roid=5\ ropcc=1\ romax_mb=1"
+
+	do_facet $SINGLEAGT dd if=/dev/urandom of=$file1 bs=600k count=1 ||
+		error "failed to write $file1"
+	do_facet $SINGLEAGT dd if=/dev/urandom of=$file2 bs=600k count=1 ||
+		error "failed to write $file2"
+	lpcc_path1=$(lpcc_fid2path $hsm_root $file1)
+	lpcc_path2=$(lpcc_fid2path $hsm_root $file2)
+
+	echo "First read-only open copies the file into RO-PCC"
+	do_facet $SINGLEAGT cat $file1 > /dev/null || error "cat $file1 failed"
+	wait_update_facet $SINGLEAGT "$state" "readonly" 30 ||
+		error "$file1 is not attached into RO-PCC"
+	do_facet $SINGLEAGT cmp $file1 $lpcc_path1 ||
+		error "RO-PCC copy of $file1 differs"
+
+	echo "Modification drops the copy, the next open refreshes it"
+	do_facet $SINGLEAGT "echo -n rodata > $file1" ||
+		error "failed to write $file1"
+	check_file_data $SINGLEAGT $file1 "rodata"
+	wait_update_facet $SINGLEAGT "$state" "readonly" 30 ||
+		error "$file1 is not attached into RO-PCC again"
+	check_lpcc_data $SINGLEAGT $lpcc_path1 $file1 "rodata"
+
+	echo "Copies over romax_mb are evicted in LRU order"
+	do_facet $SINGLEAGT dd if=/dev/urandom of=$file1 bs=600k count=1 ||
+		error "failed to write $file1"
+	do_facet $SINGLEAGT cat $file1 > /dev/null || error "cat $file1 failed"
+	wait_update_facet $SINGLEAGT "$state" "readonly" 30 ||
+		error "$file1 is not attached into RO-PCC"
+	do_facet $SINGLEAGT cat $file2 > /dev/null || error "cat $file2 failed"
+	wait_update_facet $SINGLEAGT "[ -f $lpcc_path2 ] && echo cached" \
+		"cached" 30 || error "$file2 is not copied into RO-PCC"
+	do_facet $SINGLEAGT "[ -f $lpcc_path1 ]" &&
+		error "$lpcc_path1 should have been evicted"
+
+	do_facet $SINGLEAGT $LFS pcc detach $file2 ||
+		error "failed to detach $file2"
+	do_facet $SINGLEAGT "[ -f $lpcc_path2 ]" &&
+		error "$lpcc_path2 should have been removed"
+	return 0
+}
+run_test 21 "RO-PCC copies files on read-only open and evicts them in LRU"
+
+test_22() {
+	local agt_host=$(facet_active_host $SINGLEAGT)
+	local loopfile="$TMP/$tfile"
+	local mntpt="/mnt/pcc.$tdir"
+	local hsm_root="$mntpt/$tdir"
+	local file=$DIR/$tfile.ro
+	local nr_llite
+
+	setup_loopdev $SINGLEAGT $loopfile $mntpt 600
+	do_facet $SINGLEAGT mkdir -p $hsm_root || error "mkdir $hsm_root failed"
+	setup_pcc_mapping $SINGLEAGT \
+		"fname={*.ro}\ roid=5\ ropcc=1\ romax_mb=1024"
+
+	do_facet $SINGLEAGT dd if=/dev/zero of=$file bs=1M count=512 ||
+		error "failed to write $file"
+	cancel_lru_locks osc
+	nr_llite=$(do_facet $SINGLEAGT $LCTL get_param -N llite.* | wc -l)
+
+	echo "Plain umount while $file is copied into RO-PCC"
+	do_facet $SINGLEAGT $MULTIOP $file oc || error "failed to open $file"
+	do_facet $SINGLEAGT umount $MOUNT ||
+		error "umount $MOUNT failed with a RO-PCC copy running"
+	zconf_mount $agt_host $MOUNT || error "failed to remount $MOUNT"
+
+	# the copy keeps the unmounted client alive until it ends
+	wait_update_facet $SINGLEAGT \
+		"$LCTL get_param -N llite.* | wc -l" $nr_llite 300 ||
+		error "the unmounted client is still alive"
+}
+run_test 22 "Plain umount does not wait for a running RO-PCC copy"
+
 #test 101: containers and PCC
 #LU-15170: Test mount namespaces with PCC
 #This tests the cases where the PCC mount is not present in the container by
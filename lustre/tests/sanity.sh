@@ -1513,6 +1513,48 @@ test_24H() {
 }
 run_test 24H "repeat FLD_QUERY rpc"
 
+test_24I() {
+	local prefetch="mdc.*.readdir_prefetch"
+	local nrfiles=${COUNT:-20000}
+	local num_ls
+	local hits
+	local p
+
+	$LCTL get_param $prefetch || skip "no readdir_prefetch parameter"
+
+	local old=$($LCTL get_param -n $prefetch | head -n1)
+
+	stack_trap "$LCTL set_param $prefetch=$old"
+	test_mkdir -c 1 $DIR/$tdir
+	stack_trap "simple_cleanup_common $nrfiles"
+	createmany -m $DIR/$tdir/$tfile $nrfiles ||
+		error "createmany $DIR/$tdir failed"
+
+	for p in 0 1; do
+		$LCTL set_param $prefetch=$p
+		cancel_lru_locks mdc
+		$LCTL set_param mdc.*.stats=clear
+		$LCTL set_param mdc.*.readdir_prefetch_stats=clear
+		num_ls=$(ls $DIR/$tdir | sort -u | wc -l)
+		echo "readdir_prefetch=$p: $num_ls entries," \
+		     "$(calc_stats mdc.*.stats mds_readpage) readpages"
+		$LCTL get_param mdc.*.readdir_prefetch_stats
+		(( num_ls == nrfiles )) ||
+			error "prefetch=$p: expected $nrfiles, got $num_ls"
+
+		hits=$($LCTL get_param -n mdc.*.readdir_prefetch_stats |
+		       awk '/prefetch_hits:/ { sum += $2 } END { print sum }')
+		if (( p == 0 )); then
+			(( hits == 0 )) ||
+				error "$hits prefetched pages with prefetch off"
+		else
+			(( hits > 0 )) ||
+				error "readdir did not use any prefetched page"
+		fi
+	done
+}
+run_test 24I "readdir with directory page prefetch"
+
 test_25a() {
 	echo '== symlink sanity ============================================='
 
@@ -11092,6 +11134,63 @@ test_101j() {
 }
 run_test 101j "A complete read block should be submitted when no RA"
 
+test_101k() {
+	local old_jobvar=$($LCTL get_param -n jobid_var)
+	local old_jobname=$($LCTL get_param -n jobid_name)
+	local jobid="ra.$$"
+
+	stack_trap "$LCTL set_param jobid_var=$old_jobvar \
+		    jobid_name=$old_jobname"
+	$LCTL set_param jobid_var=nodelocal jobid_name=$jobid
+
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 ||
+		error "dd write $DIR/$tfile failed"
+	cancel_lru_locks osc
+
+	stack_trap "$LCTL set_param -n llite.*.read_ahead_job_stats=0"
+	$LCTL set_param -n llite.*.read_ahead_job_stats=1
+	dd if=$DIR/$tfile of=/dev/null bs=4k ||
+		error "dd read $DIR/$tfile failed"
+	$LCTL get_param llite.*.read_ahead_job_stats
+	$LCTL get_param -n llite.*.read_ahead_job_stats |
+		grep -A 20 "job_id:.*$jobid" |
+		grep -q "hits" || error "no readahead hits for job $jobid"
+
+	$LCTL get_param -n llite.*.read_ahead_trace | tail -n 5
+	$LCTL get_param -n llite.*.read_ahead_trace | grep -q "$jobid" ||
+		error "no readahead trace entry for job $jobid"
+}
+run_test 101k "per-job readahead stats and ras_update trace"
+
+test_101l() {
+	local file=$DIR/$tfile
+	local skipped
+	local hits
+
+	$LFS setstripe -c 1 -i 0 $file
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=32 ||
+		error "dd to $TMP/$tfile failed"
+	stack_trap "rm -f $TMP/$tfile $file"
+	cp $TMP/$tfile $file || error "cp to $file failed"
+	cancel_lru_locks osc
+
+	# cache the middle of the file, then read it all from the start so
+	# that the readahead windows run into the cached pages
+	dd if=$file of=/dev/null bs=1M skip=8 count=16 ||
+		error "read of the middle of $file failed"
+	$LCTL set_param -n llite.*.read_ahead_stats=0
+	cmp $TMP/$tfile $file || error "data differ"
+
+	$LCTL get_param llite.*.read_ahead_stats
+	skipped=$($LCTL get_param -n llite.*.read_ahead_stats |
+		  get_named_value 'skipped_cached_pages' | calc_total)
+	hits=$($LCTL get_param -n llite.*.read_ahead_stats |
+	       get_named_value 'hits' | calc_total)
+	(( skipped > 0 )) || error "readahead did not skip cached pages"
+	(( hits > 0 )) || error "no page was read ahead"
+}
+run_test 101l "readahead steps over cached pages"
+
 setup_test102() {
 	test_mkdir $DIR/$tdir
 	chown $RUNAS_ID $DIR/$tdir
@@ -12364,6 +12463,130 @@ test_115() {
 }
 run_test 115 "verify dynamic thread creation===================="
 
+test_115b() {
+	local param="mds.MDS.mdt.req_batch"
+	local batch
+	local i
+
+	batch=$(do_facet mds1 $LCTL get_param -n $param 2>/dev/null) ||
+		skip "no req_batch on MDS"
+	stack_trap "do_facet mds1 $LCTL set_param $param=$batch"
+
+	do_facet mds1 $LCTL set_param $param=0 &&
+		error "req_batch 0 should be rejected"
+
+	test_mkdir $DIR/$tdir
+	for i in 1 64; do
+		do_facet mds1 $LCTL set_param $param=$i ||
+			error "failed to set req_batch to $i"
+		createmany -o $DIR/$tdir/f$i- 2000 ||
+			error "create with req_batch $i failed"
+		unlinkmany $DIR/$tdir/f$i- 2000 ||
+			error "unlink with req_batch $i failed"
+	done
+}
+run_test 115b "batched request intake with different batch sizes"
+
+# grow and shrink decisions made by the MDT service threads scaling
+mdt_threads_decisions() {
+	do_facet mds1 $LCTL get_param -n mds.MDS.mdt.threads_scaling |
+		awk '/grown:|shrunk:/ { sum += $2 } END { print sum + 0 }'
+}
+
+test_115c() {
+	local param="mds.MDS.mdt.threads_target_wait_us"
+	local target
+	local min
+	local max
+	local started
+	local idle_started
+	local before
+	local after
+	local i
+
+	target=$(do_facet mds1 $LCTL get_param -n $param 2>/dev/null) ||
+		skip "no threads_target_wait_us on MDS"
+	stack_trap "do_facet mds1 $LCTL set_param $param=$target"
+
+	min=$(do_facet mds1 $LCTL get_param -n mds.MDS.mdt.threads_min)
+	max=$(do_facet mds1 $LCTL get_param -n mds.MDS.mdt.threads_max)
+	(( min < max )) || skip "threads_min $min, threads_max $max"
+
+	before=$(mdt_threads_decisions)
+	test_mkdir $DIR/$tdir
+
+	# any queue wait is above a 1us target, the threads should grow
+	do_facet mds1 $LCTL set_param $param=1 ||
+		error "failed to set $param"
+	createmany -o $DIR/$tdir/f- 5000 || error "create failed"
+	unlinkmany $DIR/$tdir/f- 5000 || error "unlink failed"
+
+	do_facet mds1 $LCTL get_param mds.MDS.mdt.threads_scaling ||
+		error "no threads_scaling on MDS"
+
+	started=$(do_facet mds1 $LCTL get_param -n mds.MDS.mdt.threads_started)
+	(( started <= max )) ||
+		error "$started threads started, more than threads_max $max"
+
+	# nothing waits for 1s on an idle MDS, the threads should shrink.
+	# Threads only reconsider their count when woken, so keep a trickle
+	# of requests going over a few adjust intervals.
+	do_facet mds1 $LCTL set_param $param=1000000 ||
+		error "failed to set $param"
+	for i in {1..10}; do
+		touch $DIR/$tdir/idle-$i || error "touch idle-$i failed"
+		sleep 1
+	done
+
+	do_facet mds1 $LCTL get_param mds.MDS.mdt.threads_scaling
+	after=$(mdt_threads_decisions)
+	idle_started=$(do_facet mds1 $LCTL get_param -n \
+		       mds.MDS.mdt.threads_started)
+	echo "decisions $before -> $after, threads $started -> $idle_started"
+	(( after > before || idle_started != started )) ||
+		error "no grow or shrink decision, $started threads"
+
+	do_facet mds1 $LCTL set_param $param=0 ||
+		error "failed to disable $param"
+}
+run_test 115c "scale service threads to a queue wait target"
+
+test_115d() {
+	local param="mds.MDS.mdt.reply_pool"
+	local stats="mds.MDS.mdt.stats"
+	local pool
+	local allocs
+
+	pool=$(do_facet mds1 $LCTL get_param -n $param 2>/dev/null) ||
+		skip "no reply_pool on MDS"
+	stack_trap "do_facet mds1 $LCTL set_param $param=$pool"
+
+	do_facet mds1 $LCTL set_param $param=1 ||
+		error "failed to enable $param"
+	do_facet mds1 $LCTL set_param $stats=clear
+
+	test_mkdir $DIR/$tdir
+	createmany -o $DIR/$tdir/f- 2000 || error "create failed"
+	unlinkmany $DIR/$tdir/f- 2000 || error "unlink failed"
+
+	allocs=$(do_facet mds1 $LCTL get_param -n $stats |
+		 awk '/^reply_pool_alloc/ { print $2 }')
+	echo "${allocs:-0} reply states from the reply state cache"
+	(( ${allocs:-0} > 0 )) ||
+		error "no reply state taken from the reply state cache"
+
+	do_facet mds1 $LCTL set_param $param=0 ||
+		error "failed to disable $param"
+	do_facet mds1 $LCTL set_param $stats=clear
+	createmany -o $DIR/$tdir/g- 100 || error "create failed"
+	unlinkmany $DIR/$tdir/g- 100 || error "unlink failed"
+	allocs=$(do_facet mds1 $LCTL get_param -n $stats |
+		 awk '/^reply_pool_alloc/ { print $2 }')
+	(( ${allocs:-0} == 0 )) ||
+		error "$allocs reply states from the disabled cache"
+}
+run_test 115d "small replies take their reply state from a slab cache"
+
 free_min_max () {
 	wait_delete_completed
 	AVAIL=($(lctl get_param -n osc.*[oO][sS][cC]-[^M]*.kbytesavail))
@@ -13036,6 +13259,68 @@ test_119d() # bug 15950
 }
 run_test 119d "The DIO path should try to send a new rpc once one is completed"
 
+test_119e()
+{
+	$LCTL get_param -n llite.*.unaligned_dio > /dev/null 2>&1 ||
+		skip "client does not support unaligned_dio"
+
+	local ref=$TMP/$tfile.ref
+	local out=$TMP/$tfile.out
+
+	stack_trap "rm -f $ref $out"
+	dd if=/dev/urandom of=$ref bs=1000 count=1500 ||
+		error "cannot create $ref"
+
+	# 1000-byte records are neither offset nor size aligned
+	dd if=$ref of=$DIR/$tfile bs=1000 oflag=direct ||
+		error "unaligned direct write failed"
+	cancel_lru_locks osc
+	cmp $ref $DIR/$tfile || error "data mismatch after direct write"
+
+	dd if=$DIR/$tfile of=$out bs=1000 iflag=direct ||
+		error "unaligned direct read failed"
+	cmp $ref $out || error "data mismatch after direct read"
+
+	$LCTL set_param llite.*.unaligned_dio=0
+	stack_trap "$LCTL set_param llite.*.unaligned_dio=1"
+	dd if=$ref of=$DIR/$tfile bs=1000 count=1 seek=1 oflag=direct \
+		conv=notrunc && error "unaligned direct write should fail"
+	return 0
+}
+run_test 119e "unaligned directIO goes through bounce pages"
+
+test_119f()
+{
+	$LCTL get_param -n llite.*.hybrid_io > /dev/null 2>&1 ||
+		skip "client does not support hybrid_io"
+
+	local ref=$TMP/$tfile.ref
+	local old=$($LCTL get_param -n llite.*.hybrid_io | head -n1)
+	local bytes
+
+	stack_trap "rm -f $ref"
+	dd if=/dev/urandom of=$ref bs=1M count=16 ||
+		error "cannot create $ref"
+
+	stack_trap "$LCTL set_param llite.*.hybrid_io=$old"
+	$LCTL set_param llite.*.hybrid_io=1
+	$LCTL set_param llite.*.stats=clear
+
+	# 4MiB buffered writes are above the default write threshold
+	dd if=$ref of=$DIR/$tfile bs=4M || error "buffered write failed"
+	bytes=$($LCTL get_param -n llite.*.stats |
+		awk '/^hybrid_write_bytes/ { print $7 }')
+	(( ${bytes:-0} == 16 * 1048576 )) ||
+		error "hybrid_write_bytes $bytes != $((16 * 1048576))"
+
+	# small writes stay buffered and must be coherent with direct ones
+	dd if=$ref of=$DIR/$tfile bs=4k count=1 seek=1 skip=1 conv=notrunc ||
+		error "small write failed"
+	cancel_lru_locks osc
+	cmp $ref $DIR/$tfile || error "data mismatch"
+}
+run_test 119f "large buffered I/O switches to directIO"
+
 test_120a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	remote_mds_nodsh && skip "remote MDS with nodsh"
@@ -13476,6 +13761,111 @@ test_123c() {
 }
 run_test 123c "Can not initialize inode warning on DNE statahead"
 
+test_123d() {
+	local num=1000
+	local batch_max
+	local swrong
+	local ewrong
+
+	test_mkdir -c 1 $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile $num ||
+		error "failed to create $num files in $DIR/$tdir"
+
+	batch_max=$($LCTL get_param -n llite.*.statahead_batch_max | head -n 1)
+	stack_trap "$LCTL set_param llite.*.statahead_batch_max=$batch_max"
+
+	for batch in 0 1 16 $batch_max; do
+		$LCTL set_param llite.*.statahead_batch_max=$batch
+		swrong=$($LCTL get_param -n llite.*.statahead_stats |
+			awk '/statahead.wrong:/ { sum += $3 } END { print sum }')
+		cancel_lru_locks mdc
+		ls -l $DIR/$tdir | grep -c $tfile | grep -q "^$num$" ||
+			error "ls -l with statahead_batch_max=$batch failed"
+		ewrong=$($LCTL get_param -n llite.*.statahead_stats |
+			awk '/statahead.wrong:/ { sum += $3 } END { print sum }')
+		(( ewrong == swrong )) ||
+			error "statahead stopped with statahead_batch_max=$batch"
+	done
+}
+run_test 123d "statahead works with different statahead_batch_max"
+
+test_123e() {
+	local num=1000
+	local before
+	local after
+
+	$LCTL get_param -n llite.*.statahead_fname > /dev/null 2>&1 ||
+		skip "client does not support statahead by file name pattern"
+
+	test_mkdir -c 1 $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile $num ||
+		error "failed to create $num files in $DIR/$tdir"
+
+	before=$($LCTL get_param -n llite.*.statahead_stats |
+		awk '/fname.total:/ { sum += $3 } END { print sum }')
+	cancel_lru_locks mdc
+	# stat all names in a single process without reading the directory
+	stat -c %n $DIR/$tdir/$tfile{0..999} | wc -l | grep -q "^$num$" ||
+		error "stat of $num files failed"
+	after=$($LCTL get_param -n llite.*.statahead_stats |
+		awk '/fname.total:/ { sum += $3 } END { print sum }')
+	$LCTL get_param -n llite.*.statahead_stats
+
+	(( after > before )) ||
+		error "statahead by file name pattern not started"
+}
+run_test 123e "statahead by file name pattern"
+
+test_123f() {
+	local num=100
+	local before
+	local after
+	local hits
+	local enqueues
+
+	$LCTL get_param -n llite.*.statahead_xattr > /dev/null 2>&1 ||
+		skip "client does not support statahead xattr prefetch"
+	[[ $($LCTL get_param -n llite.*.xattr_cache | head -n1) == 1 ]] ||
+		skip "xattr cache is disabled"
+
+	test_mkdir -c 1 $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile $num ||
+		error "failed to create $num files in $DIR/$tdir"
+	for ((i = 0; i < num; i++)); do
+		setfattr -n user.sa -v $i $DIR/$tdir/$tfile$i ||
+			error "setfattr $DIR/$tdir/$tfile$i failed"
+	done
+
+	local old=$($LCTL get_param -n llite.*.statahead_xattr | head -n1)
+
+	stack_trap "$LCTL set_param llite.*.statahead_xattr=$old"
+	$LCTL set_param llite.*.statahead_xattr=1
+
+	before=$($LCTL get_param -n llite.*.statahead_stats |
+		awk '/xattr.total:/ { sum += $3 } END { print sum }')
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir | grep -c $tfile | grep -q "^$num$" ||
+		error "ls -l $DIR/$tdir failed"
+	after=$($LCTL get_param -n llite.*.statahead_stats |
+		awk '/xattr.total:/ { sum += $3 } END { print sum }')
+	echo "xattr caches filled by statahead: $((after - before))"
+	(( after > before )) || error "statahead did not prefetch xattrs"
+
+	# the xattrs of the files are already cached, reading them must not
+	# send one getxattr intent per file to the MDT
+	$LCTL set_param llite.*.stats=clear
+	$LCTL set_param mdc.*.stats=clear
+	getfattr -d $DIR/$tdir/* > /dev/null ||
+		error "getfattr $DIR/$tdir failed"
+	enqueues=$(calc_stats mdc.*.stats ldlm_enqueue)
+	hits=$(calc_stats llite.*.stats getxattr_hits)
+	echo "$hits getxattr cache hits, $enqueues enqueue RPCs"
+	(( enqueues < num / 2 )) ||
+		error "$enqueues xattr RPCs for $num prefetched files"
+	(( hits > 0 )) || error "no getxattr was served from the xattr cache"
+}
+run_test 123f "statahead prefetches xattrs into the xattr cache"
+
 test_124a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	$LCTL get_param -n mdc.*.connect_flags | grep -q lru_resize ||
@@ -19297,6 +19687,27 @@ test_207b() {
 }
 run_test 207b "can refresh layout at open"
 
+test_207c() {
+	$LFS setstripe -E 1M -c 1 -E eof -c -1 $DIR/$tfile ||
+		error "setstripe $DIR/$tfile failed"
+	dd if=/dev/urandom of=$DIR/$tfile bs=1M count=4 ||
+		error "write $DIR/$tfile failed"
+	local cksum=$(md5sum < $DIR/$tfile)
+
+	local old_debug=$($LCTL get_param -n debug)
+
+	stack_trap "$LCTL set_param debug='$old_debug'"
+	$LCTL set_param debug=+inode
+	$LCTL clear
+
+	# the layout lock is lost and enqueued again, layout is unchanged
+	cancel_lru_locks mdc
+	[[ "$(md5sum < $DIR/$tfile)" == "$cksum" ]] || error "file differs"
+	$LCTL dk | grep -q "layout gen .* unchanged" ||
+		error "unchanged layout was unpacked again"
+}
+run_test 207c "unchanged layout is revalidated after layout lock cancel"
+
 test_208() {
 	# FIXME: in this test suite, only RD lease is used. This is okay
 	# for now as only exclusive open is supported. After generic lease
@@ -22004,6 +22415,221 @@ test_248b() {
 }
 run_test 248b "test short_io read and write for both small and large sizes"
 
+test_248c() {
+	[[ $($LCTL get_param osc.$FSNAME-OST0000*.import) =~ \
+		connect_flags.*compress ]] ||
+		skip "OST does not support compressed bulk"
+
+	local save=$($LCTL get_param -n osc.$FSNAME-OST0000*.brw_compress)
+
+	$LCTL set_param osc.$FSNAME-*.brw_compress=1 ||
+		error "cannot enable brw_compress"
+	stack_trap "$LCTL set_param osc.$FSNAME-*.brw_compress=$save" EXIT
+
+	# half compressible and half random data to test both chunk kinds
+	yes "compressible text" | head -c 4M > $TMP/$tfile
+	dd if=/dev/urandom bs=1M count=4 >> $TMP/$tfile
+	stack_trap "rm -f $TMP/$tfile" EXIT
+
+	local stats="osc.$FSNAME-OST0000-osc-[^M]*.osc_stats"
+	local raw
+	local sent
+
+	$LCTL set_param -n $stats=clear
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile.1
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=1M oflag=direct ||
+		error "direct write failed"
+	dd if=$TMP/$tfile of=$DIR/$tfile.1 bs=47008 conv=fsync ||
+		error "buffered write failed"
+	cancel_lru_locks osc
+
+	cmp $TMP/$tfile $DIR/$tfile || error "compare $DIR/$tfile failed"
+	cmp $TMP/$tfile $DIR/$tfile.1 || error "compare $DIR/$tfile.1 failed"
+
+	$LCTL get_param $stats
+	raw=$($LCTL get_param -n $stats |
+	      awk '/compressed_raw_bytes/ { print $2 }')
+	sent=$($LCTL get_param -n $stats |
+	       awk '/compressed_sent_bytes/ { print $2 }')
+	(( raw > 0 )) || error "no write bulk was compressed"
+	(( sent < raw )) || error "compressed $raw bytes into $sent"
+}
+run_test 248c "compressed write bulk is stored uncompressed"
+
+test_248d() {
+	[[ $($LCTL get_param osc.$FSNAME-OST0000*.import) =~ \
+		connect_flags.*multiobj_brw ]] ||
+		skip "OST does not support multi-object writes"
+
+	local osc=$($LCTL get_param -N osc.$FSNAME-OST0000-osc-[^M]*)
+	local save=$($LCTL get_param -n $osc.max_rpcs_in_flight)
+	local nfiles=100
+	local before
+	local after
+	local i
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir
+	dd if=/dev/urandom of=$TMP/$tfile bs=3000 count=1
+	stack_trap "rm -f $TMP/$tfile" EXIT
+
+	# queue the files behind a single RPC in flight so that they are
+	# sent together
+	$LCTL set_param $osc.max_rpcs_in_flight=1
+	stack_trap "$LCTL set_param $osc.max_rpcs_in_flight=$save" EXIT
+
+	before=$(count_ost_writes)
+	for ((i = 0; i < nfiles; i++)); do
+		cp $TMP/$tfile $DIR/$tdir/f$i || error "cp f$i failed"
+	done
+	sync
+	after=$(count_ost_writes)
+	echo "$((after - before)) write RPCs for $nfiles files"
+	(( after - before < nfiles )) ||
+		error "$((after - before)) write RPCs for $nfiles files"
+
+	cancel_lru_locks osc
+	for ((i = 0; i < nfiles; i++)); do
+		cmp $TMP/$tfile $DIR/$tdir/f$i || error "compare f$i failed"
+	done
+}
+run_test 248d "small writes of several files share RPCs"
+
+test_248e() {
+	local osc=$($LCTL get_param -N osc.$FSNAME-OST0000-osc-[^M]*)
+	local old_jobvar=$($LCTL get_param -n jobid_var)
+	local old_jobname=$($LCTL get_param -n jobid_name)
+	local save=$($LCTL get_param -n $osc.max_dirty_mb)
+	local jobid="wr.$$"
+	local stats
+
+	$LCTL get_param $osc.job_grant_stats ||
+		skip "no per-job write cache stats"
+
+	stack_trap "$LCTL set_param $osc.job_fair=0"
+	$LCTL set_param $osc.job_fair=1
+	stack_trap "$LCTL set_param jobid_var=$old_jobvar \
+		    jobid_name=$old_jobname"
+	$LCTL set_param jobid_var=nodelocal jobid_name=$jobid
+	stack_trap "$LCTL set_param $osc.max_dirty_mb=$save"
+	$LCTL set_param $osc.max_dirty_mb=1
+	$LCTL set_param $osc.job_grant_stats=clear
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 ||
+		error "dd write $DIR/$tfile failed"
+	sync
+
+	stats=$($LCTL get_param -n $osc.job_grant_stats)
+	echo "$stats"
+	echo "$stats" | grep -A 8 "job_id:.*$jobid" |
+		grep -q "dirty_pages: *0$" ||
+		error "dirty pages of $jobid not released"
+	echo "$stats" | grep -A 8 "job_id:.*$jobid" |
+		grep -q "waits: *[1-9]" ||
+		error "no cache waits recorded for $jobid"
+}
+run_test 248e "per-job write cache accounting and grant wait stats"
+
+test_248f() {
+	local osc=$($LCTL get_param -N osc.$FSNAME-OST0000-osc-[^M]*)
+	local old_jobvar=$($LCTL get_param -n jobid_var)
+	local save=$($LCTL get_param -n $osc.max_dirty_mb)
+	local both=0
+	local throttled
+	local dirty
+	local pid1
+	local pid2
+	local i
+
+	$LCTL get_param $osc.job_fair || skip "no per-job write cache share"
+
+	stack_trap "$LCTL set_param $osc.job_fair=0"
+	$LCTL set_param $osc.job_fair=1
+	stack_trap "$LCTL set_param jobid_var=$old_jobvar"
+	$LCTL set_param jobid_var=procname_uid
+	stack_trap "$LCTL set_param $osc.max_dirty_mb=$save"
+	$LCTL set_param $osc.max_dirty_mb=8
+	$LCTL set_param $osc.job_grant_stats=clear
+
+	# two jobs, told apart by their process name, write to the same OST
+	cp $(which dd) $TMP/dd_job1 && cp $(which dd) $TMP/dd_job2 ||
+		error "cannot copy dd"
+	stack_trap "rm -f $TMP/dd_job1 $TMP/dd_job2"
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile.1
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile.2
+
+	$TMP/dd_job1 if=/dev/zero of=$DIR/$tfile.1 bs=1M count=512 &
+	pid1=$!
+	$TMP/dd_job2 if=/dev/zero of=$DIR/$tfile.2 bs=1M count=512 &
+	pid2=$!
+	stack_trap "kill $pid1 $pid2 2>/dev/null"
+
+	# while both write, each should hold part of the dirty cache
+	for i in {1..50}; do
+		dirty=$($LCTL get_param -n $osc.job_grant_stats |
+			awk '/job_id:.*dd_job/ { job = 1 }
+			     job && /dirty_pages:/ { if ($2 > 0) n++; job = 0 }
+			     END { print n + 0 }')
+		(( dirty < 2 )) || both=$((both + 1))
+		sleep 0.1
+	done
+	wait $pid1 || error "dd_job1 failed"
+	wait $pid2 || error "dd_job2 failed"
+
+	$LCTL get_param $osc.job_grant_stats
+	throttled=$($LCTL get_param -n $osc.job_grant_stats |
+		    awk '/throttled:/ { sum += $2 } END { print sum + 0 }')
+	echo "both jobs cached dirty pages in $both of 50 samples," \
+	     "$throttled throttled admissions"
+	(( both > 0 )) || error "one job held the whole dirty cache"
+	(( throttled > 0 )) || error "no job was held to its share"
+}
+run_test 248f "two jobs share the OSC dirty cache"
+
+test_248g() {
+	[[ $($LCTL get_param osc.$FSNAME-OST0000*.import) =~ \
+		connect_flags.*multiobj_brw ]] ||
+		skip "OST does not support multi-object writes"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local osc=$($LCTL get_param -N osc.$FSNAME-OST0000-osc-[^M]*)
+	local save=$($LCTL get_param -n $osc.max_rpcs_in_flight)
+	local nfiles=20
+	local i
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir
+	dd if=/dev/urandom of=$TMP/$tfile bs=3000 count=1
+	stack_trap "rm -f $TMP/$tfile" EXIT
+
+	$LCTL set_param $osc.max_rpcs_in_flight=1
+	stack_trap "$LCTL set_param $osc.max_rpcs_in_flight=$save" EXIT
+
+	for ((i = 0; i < nfiles; i++)); do
+		cp $TMP/$tfile $DIR/$tdir/f$i || error "cp f$i failed"
+	done
+
+	# fail the commit of the batch once so that it is resent, and resend
+	# it as if the OST had lost OBD_CONNECT2_MULTIOBJ_BRW
+	#define OBD_FAIL_OST_DQACQ_NET		0x230
+	do_facet ost1 $LCTL set_param fail_loc=0x80000230
+	#define OBD_FAIL_OSC_NO_MULTIOBJ_BRW	0x419
+	$LCTL set_param fail_loc=0x419
+	sync
+	local rc=$?
+	$LCTL set_param fail_loc=0
+	do_facet ost1 $LCTL set_param fail_loc=0
+	(( rc == 0 )) || error "sync failed: rc = $rc"
+
+	cancel_lru_locks osc
+	for ((i = 0; i < nfiles; i++)); do
+		cmp $TMP/$tfile $DIR/$tdir/f$i || error "compare f$i failed"
+	done
+}
+run_test 248g "multi-object write is split when resent without support"
+
 test_249() { # LU-7890
 	[ $MDS1_VERSION -lt $(version_code 2.8.53) ] &&
 		skip "Need at least version 2.8.54"
@@ -23373,6 +23999,44 @@ test_271d() {
 }
 run_test 271d "DoM: read on open (1K file in reply buffer)"
 
+test_271da() {
+	(( $MDS1_VERSION >= $(version_code 2.15.55) )) ||
+		skip "Need MDS version at least 2.15.55"
+
+	local dom=$DIR/$tdir/dom
+	local tmp=$TMP/$tfile
+	trap "cleanup_271def_tests $tmp" EXIT
+
+	mkdir -p $DIR/$tdir
+
+	$LFS setstripe -E 1024K -L mdt $DIR/$tdir
+
+	local mdtidx=$($LFS getstripe --mdt-index $DIR/$tdir)
+
+	# larger than dom_min_inline_repsize, but known to the client
+	dd if=/dev/urandom of=$tmp bs=48K count=1
+	dd if=$tmp of=$dom bs=48K count=1
+	stat $dom > /dev/null
+	cancel_lru_locks mdc
+	lctl set_param -n mdc.*.stats=clear
+
+	echo "Open and read file"
+	cat $dom > /dev/null
+	local num=$(get_mdc_stats $mdtidx ost_read)
+	local ra=$(get_mdc_stats $mdtidx req_active)
+	local rw=$(get_mdc_stats $mdtidx req_waittime)
+
+	[ -z $num ] || error "$num READ RPC occured"
+	[ $ra == $rw ] || error "$((ra - rw)) resend occured"
+	echo "... DONE"
+
+	# compare content
+	cmp $tmp $dom || error "file miscompare"
+
+	return 0
+}
+run_test 271da "DoM: read on open (48K file with known size)"
+
 test_271f() {
 	[ $MDS1_VERSION -lt $(version_code 2.10.57) ] &&
 		skip "Need MDS version at least 2.10.57"
@@ -25031,6 +25695,21 @@ test_318() {
 		"expect threshold $valid got $threshold"
 	$LCTL set_param \
 		llite.*.read_ahead_async_file_threshold_mb=$old_threshold
+
+	local old_per_file=$($LCTL get_param -n \
+		${llite_name}.max_read_ahead_async_per_file 2>/dev/null)
+
+	[[ -n "$old_per_file" ]] || return 0
+	stack_trap "$LCTL set_param \
+		llite.*.max_read_ahead_async_per_file=$old_per_file"
+
+	$LCTL set_param llite.*.max_read_ahead_async_per_file=0 &&
+		error "set max_read_ahead_async_per_file=0 should fail"
+	$LCTL set_param llite.*.max_read_ahead_async_per_file=8 ||
+		error "set max_read_ahead_async_per_file=8 should succeed"
+	local per_file=$($LCTL get_param -n \
+		${llite_name}.max_read_ahead_async_per_file 2>/dev/null)
+	(( per_file == 8 )) || error "expected 8 but got $per_file"
 }
 run_test 318 "Verify async readahead tunables"
 
@@ -25555,6 +26234,93 @@ test_398q() {
 }
 run_test 398q "i/o error on mirror file read"
 
+test_398r() {
+	local ncpts=$($LCTL get_param -n cpu_partition_table | wc -l)
+	local param=/sys/module/ptlrpc/parameters/ptlrpcd_import_affinity
+	local cpts
+	local cpt
+	local pid
+	local -A before
+	local after
+
+	[[ -f $param ]] || skip "no ptlrpcd_import_affinity"
+	(( ncpts > 1 )) || skip "needs more than one CPT"
+
+	cpts=$($LCTL get_param -n osc.$FSNAME-OST*-osc-[^M]*.import |
+	       awk '/cpt:/ { print $2 }' | sort -u)
+	[[ -n "$cpts" ]] || error "no cpt in the osc imports"
+	for cpt in $cpts; do
+		(( cpt >= 0 && cpt < ncpts )) ||
+			error "import cpt $cpt out of 0..$((ncpts - 1))"
+	done
+
+	local save=$(cat $param)
+	stack_trap "echo $save > $param"
+	echo 1 > $param
+
+	# count the context switches of the ptlrpcd threads of each import CPT
+	ptlrpcd_switches() {
+		local sum=0
+
+		for pid in $(pgrep "^ptlrpcd_$(printf %02d $1)_"); do
+			sum=$((sum + $(awk '/^voluntary_ctxt_switches/ \
+				{ print $2 }' /proc/$pid/status)))
+		done
+		echo $sum
+	}
+
+	for cpt in $cpts; do
+		before[$cpt]=$(ptlrpcd_switches $cpt)
+	done
+
+	$LFS setstripe -c -1 $DIR/$tfile || error "setstripe failed"
+	# submit from the first CPT, the imports may be on any other
+	taskset -c $($LCTL get_param -n cpu_partition_table |
+		     awk 'NR == 1 { print $3 }') \
+		dd if=/dev/zero of=$DIR/$tfile bs=16M count=8 oflag=direct ||
+		error "direct write failed"
+
+	for cpt in $cpts; do
+		after=$(ptlrpcd_switches $cpt)
+		echo "CPT $cpt ptlrpcd switches: ${before[$cpt]} -> $after"
+		(( after > ${before[$cpt]} )) ||
+			error "ptlrpcd of import CPT $cpt did not run"
+	done
+}
+run_test 398r "ptlrpcd work runs on the CPT of the import peer"
+
+test_398s() {
+	local loc
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=32 ||
+		error "dd to $TMP/$tfile failed"
+	stack_trap "rm -f $TMP/$tfile $TMP/$tfile.dio $DIR/$tfile"
+
+	# cl_pages of DIO chunks and readahead windows are allocated in bulk,
+	# and one at a time if the bulk allocation fails
+	#define OBD_FAIL_LLITE_PAGE_BULK_ALLOC	0x1421
+	stack_trap "$LCTL set_param fail_loc=0"
+	for loc in 0 0x1421; do
+		echo "fail_loc=$loc"
+		$LCTL set_param fail_loc=$loc
+		dd if=$TMP/$tfile of=$DIR/$tfile bs=4M oflag=direct ||
+			error "DIO write failed"
+		dd if=$DIR/$tfile of=$TMP/$tfile.dio bs=4M iflag=direct ||
+			error "DIO read failed"
+		cmp $TMP/$tfile $TMP/$tfile.dio || error "DIO data differ"
+
+		cancel_lru_locks osc
+		$LCTL set_param -n llite.*.read_ahead_stats=0
+		cmp $TMP/$tfile $DIR/$tfile || error "buffered data differ"
+		$LCTL get_param llite.*.read_ahead_stats
+		local hits=$($LCTL get_param -n llite.*.read_ahead_stats |
+			     get_named_value 'hits' | calc_total)
+		(( hits > 0 )) || error "no page was read ahead"
+	done
+}
+run_test 398s "cl_pages of DIO and readahead are allocated in bulk"
+
 test_fake_rw() {
 	local read_write=$1
 	if [ "$read_write" = "write" ]; then
@@ -27651,6 +28417,77 @@ test_429() { # LU-7915 / LU-10948
 }
 run_test 429 "verify if opencache flag on client side does work"
 
+test_429b() {
+	local oc_create="llite.*.opencache_create_threshold"
+	local mdc_rpcstats="mdc.$FSNAME-MDT0000-*.stats"
+	local count=100
+	local closes
+
+	$LCTL get_param $oc_create ||
+		skip "client does not have opencache_create_threshold"
+	$LCTL get_param -n mdc.$FSNAME-MDT0000-*.import |
+		grep -q atomic_open_lock ||
+		skip "MDS does not support atomic open lock"
+
+	local old=$($LCTL get_param -n $oc_create | head -n1)
+
+	stack_trap "$LCTL set_param $oc_create=$old"
+	$LCTL set_param $oc_create=16
+
+	mkdir_on_mdt0 $DIR/$tdir || error "mkdir $DIR/$tdir failed"
+	cancel_lru_locks mdc
+	$LCTL set_param $mdc_rpcstats=clear
+
+	createmany -o $DIR/$tdir/$tfile- $count ||
+		error "createmany $DIR/$tdir failed"
+	closes=$(calc_stats $mdc_rpcstats mds_close)
+	echo "$closes close RPCs for $count creates"
+	(( closes < count )) ||
+		error "all $count creates sent a close RPC"
+
+	cancel_lru_locks mdc
+	closes=$(calc_stats $mdc_rpcstats mds_close)
+	(( closes == count )) ||
+		error "$closes close RPCs after lock cancel, expected $count"
+}
+run_test 429b "burst of creates in a directory uses open lock"
+
+test_429c() {
+	local neg_thrsh="llite.*.negative_dentry_threshold"
+	local llite_stats="llite.*.stats"
+	local count=10
+	local hits
+	local misses
+
+	$LCTL get_param $neg_thrsh ||
+		skip "client does not have negative_dentry_threshold"
+
+	local old=$($LCTL get_param -n $neg_thrsh | head -n1)
+
+	stack_trap "$LCTL set_param $neg_thrsh=$old"
+	$LCTL set_param $neg_thrsh=2
+
+	mkdir_on_mdt0 $DIR/$tdir || error "mkdir $DIR/$tdir failed"
+	cancel_lru_locks mdc
+	$LCTL set_param $llite_stats=clear
+
+	for ((i = 0; i < count; i++)); do
+		stat $DIR/$tdir/$tfile &> /dev/null &&
+			error "$DIR/$tdir/$tfile should not exist"
+	done
+	misses=$(calc_stats $llite_stats negative_dentry_misses)
+	hits=$(calc_stats $llite_stats negative_dentry_hits)
+	echo "$misses misses, $hits hits for $count lookups"
+	(( misses <= 2 )) ||
+		error "$misses lookups of a missing name sent to the MDS"
+	(( hits > 0 )) || error "no lookup was answered from the dcache"
+
+	# a create in the directory revokes the UPDATE lock
+	touch $DIR/$tdir/$tfile || error "touch $DIR/$tdir/$tfile failed"
+	stat $DIR/$tdir/$tfile || error "stat $DIR/$tdir/$tfile failed"
+}
+run_test 429c "lookup misses are cached under the directory UPDATE lock"
+
 lseek_test_430() {
 	local offset
 	local file=$1
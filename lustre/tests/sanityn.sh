@@ -4718,6 +4718,74 @@ test_77p() {
 }
 run_test 77p "Check validity of rule names for TBF policies"
 
+test_77r() {
+	local rc=0
+
+	oss=$(comma_list $(osts_nodes))
+
+	do_nodes $oss lctl set_param ost.OSS.ost_io.nrs_policies="drr\ jobid" ||
+		rc=$?
+	[[ $rc -eq 3 ]] && skip "no NRS exists"
+	[[ $rc -ne 0 ]] && skip "DRR NRS policy not supported"
+	stack_trap "do_nodes $oss lctl set_param \
+		ost.OSS.ost_io.nrs_policies=fifo"
+
+	do_nodes $oss lctl set_param ost.OSS.ost_io.nrs_drr_quantum=1000 \
+		ost.OSS.ost_io.nrs_drr_weight=dd.0:4 ||
+		error "failed to set DRR quantum and weight"
+	do_nodes $oss lctl set_param ost.OSS.ost_io.nrs_drr_weight=dd.0:0 &&
+		error "DRR weight 0 should be rejected"
+
+	echo "policy: drr jobid, quantum 1000us, weight of dd.0 4"
+	nrs_write_read
+
+	do_nodes $oss lctl get_param ost.OSS.ost_io.nrs_drr_weight
+	do_facet ost1 lctl get_param -n ost.OSS.ost_io.nrs_drr_weight |
+		grep -q "weight: 4" || error "DRR weight rule not listed"
+	do_facet ost1 lctl get_param -n ost.OSS.ost_io.nrs_drr_weight |
+		grep -q "served: [1-9]" || error "no DRR class served requests"
+}
+run_test 77r "check DRR NRS policy"
+
+test_77s() {
+	local dir=$DIR/$tdir
+	local rc=0
+
+	do_facet ost1 $LCTL set_param \
+		ost.OSS.ost_io.nrs_policies="tbf\ opcode" || rc=$?
+	[[ $rc -eq 3 ]] && skip "no NRS TBF exists"
+	[[ $rc -ne 0 ]] && error "failed to set TBF OPCode policy"
+	stack_trap "do_facet ost1 $LCTL set_param \
+		ost.OSS.ost_io.nrs_policies=fifo"
+
+	do_facet ost1 $LCTL get_param ost.OSS.ost_io.nrs_tbf_adaptive ||
+		skip "adaptive TBF not supported"
+
+	do_facet ost1 $LCTL set_param ost.OSS.ost_io.nrs_tbf_rule=\
+		"start\ adapt_w\ opcode={ost_write}\ rate=10\ min_rate=20\ max_rate=5" &&
+		error "min_rate above max_rate should be rejected"
+	tbf_rule_operate ost1 \
+		"start\ adapt_w\ opcode={ost_write}\ rate=10\ max_rate=1000"
+	# an idle test OSS should never be over a 10s service latency
+	do_facet ost1 $LCTL set_param ost.OSS.ost_io.nrs_tbf_adaptive=10000000
+
+	mkdir $dir || error "mkdir $dir failed"
+	$LFS setstripe -c 1 -i 0 $dir || error "setstripe to $dir failed"
+	dd if=/dev/zero of=$dir/$tfile bs=1M count=100 oflag=direct ||
+		error "dd failed"
+
+	do_facet ost1 $LCTL get_param ost.OSS.ost_io.nrs_tbf_adaptive
+	do_facet ost1 $LCTL get_param -n ost.OSS.ost_io.nrs_tbf_adaptive |
+		grep -q "raised: [1-9]" ||
+		error "the rate of adapt_w was never raised"
+
+	tbf_rule_operate ost1 "change\ adapt_w\ adaptive=0"
+	do_facet ost1 $LCTL get_param -n ost.OSS.ost_io.nrs_tbf_adaptive |
+		grep -q "adapt_w" && error "adapt_w should be static"
+	tbf_rule_operate ost1 "stop\ adapt_w"
+}
+run_test 77s "check adaptive TBF rules"
+
 test_78() { #LU-6673
 	local rc
 
@@ -652,6 +652,12 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT2_PCCRO);
 	CHECK_DEFINE_64X(OBD_CONNECT2_ATOMIC_OPEN_LOCK);
 	CHECK_DEFINE_64X(OBD_CONNECT2_ENCRYPT_NAME);
+	CHECK_DEFINE_64X(OBD_CONNECT2_ENCRYPT_FID2PATH);
+	CHECK_DEFINE_64X(OBD_CONNECT2_DMV_IMP_INHERIT);
+	CHECK_DEFINE_64X(OBD_CONNECT2_UNALIGNED_DIO);
+	CHECK_DEFINE_64X(OBD_CONNECT2_LARGE_NID);
+	CHECK_DEFINE_64X(OBD_CONNECT2_COMPRESS);
+	CHECK_DEFINE_64X(OBD_CONNECT2_MULTIOBJ_BRW);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -708,7 +714,7 @@ check_obdo(void)
 	CHECK_MEMBER(obdo, o_gid_h);
 	CHECK_MEMBER(obdo, o_data_version);
 	CHECK_MEMBER(obdo, o_projid);
-	CHECK_MEMBER(obdo, o_padding_4);
+	CHECK_MEMBER(obdo, o_compr_len);
 	CHECK_MEMBER(obdo, o_padding_5);
 	CHECK_MEMBER(obdo, o_padding_6);
 
@@ -1101,6 +1107,16 @@ check_niobuf_remote(void)
 	CHECK_DEFINE_X(OBD_BRW_SYS_RESOURCE);
 }
 
+static void
+check_brw_compr_chunk(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(brw_compr_chunk);
+	CHECK_MEMBER(brw_compr_chunk, bcc_raw_len);
+	CHECK_MEMBER(brw_compr_chunk, bcc_len);
+	CHECK_CVALUE(BRW_COMPR_CHUNK_SIZE);
+}
+
 static void
 check_ost_body(void)
 {
@@ -3203,6 +3219,7 @@ main(int argc, char **argv)
 	printf("#endif /* HAVE_SERVER_SUPPORT */\n");
 #endif /* !HAVE_NATIVE_LINUX_CLIENT */
 	check_niobuf_remote();
+	check_brw_compr_chunk();
 	check_ost_body();
 	check_ll_fid();
 	check_mds_op_bias();
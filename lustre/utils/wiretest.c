@@ -1430,6 +1430,18 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT2_ATOMIC_OPEN_LOCK);
 	LASSERTF(OBD_CONNECT2_ENCRYPT_NAME == 0x8000000ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT2_ENCRYPT_NAME);
+	LASSERTF(OBD_CONNECT2_ENCRYPT_FID2PATH == 0x10000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_ENCRYPT_FID2PATH);
+	LASSERTF(OBD_CONNECT2_DMV_IMP_INHERIT == 0x20000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_DMV_IMP_INHERIT);
+	LASSERTF(OBD_CONNECT2_UNALIGNED_DIO == 0x40000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_UNALIGNED_DIO);
+	LASSERTF(OBD_CONNECT2_LARGE_NID == 0x80000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_LARGE_NID);
+	LASSERTF(OBD_CONNECT2_COMPRESS == 0x100000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_COMPRESS);
+	LASSERTF(OBD_CONNECT2_MULTIOBJ_BRW == 0x200000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_MULTIOBJ_BRW);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
@@ -1584,10 +1596,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct obdo, o_projid));
 	LASSERTF((int)sizeof(((struct obdo *)0)->o_projid) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct obdo *)0)->o_projid));
-	LASSERTF((int)offsetof(struct obdo, o_padding_4) == 188, "found %lld\n",
-		 (long long)(int)offsetof(struct obdo, o_padding_4));
-	LASSERTF((int)sizeof(((struct obdo *)0)->o_padding_4) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obdo *)0)->o_padding_4));
+	LASSERTF((int)offsetof(struct obdo, o_compr_len) == 188, "found %lld\n",
+		 (long long)(int)offsetof(struct obdo, o_compr_len));
+	LASSERTF((int)sizeof(((struct obdo *)0)->o_compr_len) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obdo *)0)->o_compr_len));
 	LASSERTF((int)offsetof(struct obdo, o_padding_5) == 192, "found %lld\n",
 		 (long long)(int)offsetof(struct obdo, o_padding_5));
 	LASSERTF((int)sizeof(((struct obdo *)0)->o_padding_5) == 8, "found %lld\n",
@@ -2378,6 +2390,19 @@ void lustre_assert_wire_constants(void)
 	LASSERTF(OBD_BRW_SYS_RESOURCE == 0x40000, "found 0x%.8x\n",
 		OBD_BRW_SYS_RESOURCE);
 
+	/* Checks for struct brw_compr_chunk */
+	LASSERTF((int)sizeof(struct brw_compr_chunk) == 8, "found %lld\n",
+		 (long long)(int)sizeof(struct brw_compr_chunk));
+	LASSERTF((int)offsetof(struct brw_compr_chunk, bcc_raw_len) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_chunk, bcc_raw_len));
+	LASSERTF((int)sizeof(((struct brw_compr_chunk *)0)->bcc_raw_len) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_chunk *)0)->bcc_raw_len));
+	LASSERTF((int)offsetof(struct brw_compr_chunk, bcc_len) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_chunk, bcc_len));
+	LASSERTF((int)sizeof(((struct brw_compr_chunk *)0)->bcc_len) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_chunk *)0)->bcc_len));
+	BUILD_BUG_ON(BRW_COMPR_CHUNK_SIZE != 65536);
+
 	/* Checks for struct ost_body */
 	LASSERTF((int)sizeof(struct ost_body) == 208, "found %lld\n",
 		 (long long)(int)sizeof(struct ost_body));